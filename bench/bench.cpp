@@ -0,0 +1,775 @@
+// Throughput benchmark of the encoding/decoding entry points.
+//
+// Every measurement is printed as one JSON object per line (or as a CSV row with --csv),
+// so results can be collected and compared between releases. Throughput is given in
+// MB/s (10^6 bytes) of binary data, i.e. the decoded size, for both directions.
+// Cycles are counted with the time stamp counter where it's available.
+// "probe(...)" rows give the speed of a cache-sensitive workload right after a call at the largest
+// size on the same thread, i.e. how much of its working set the call evicted.
+//
+// Build with optimizations and without coverage instrumentation to get meaningful numbers:
+//    cmake .. -DCMAKE_BUILD_TYPE=Release -DZ85_COVERAGE=OFF
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined (__i386__) || defined (__x86_64__)
+   #include <x86intrin.h>
+   #define Z85_BENCH_HAS_TSC 1
+#endif
+
+#include "z85.h"
+#include "z85.hpp"
+#include "zmq_z85.h"
+
+using namespace std;
+
+// bench_single.cpp
+void single_encode_keys(const char* source, char* dest, size_t count);
+void single_decode_keys(const char* source, char* dest, size_t count);
+
+namespace
+{
+
+const size_t c_alignment = 64;
+const size_t c_maxInputSize = 1 << 30; // limit of --max-size
+
+struct options
+{
+   size_t minSize;
+   size_t maxSize;
+   size_t threads;
+   double minTime;
+   string backend;
+   string filter;
+   size_t probeSize;
+   bool csv;
+
+   options()
+      : minSize(8)
+      , maxSize(16 << 20)
+      , threads(thread::hardware_concurrency())
+      , minTime(0.05)
+      , backend("all")
+      , probeSize(4 << 20)
+      , csv(false)
+   {
+      if (threads == 0)
+      {
+         threads = 1;
+      }
+   }
+};
+
+struct result
+{
+   double mbPerSec;
+   double cyclesPerByte; // negative if cycles can't be counted
+   size_t iterations;
+};
+
+unsigned long long read_cycles()
+{
+#if defined (Z85_BENCH_HAS_TSC)
+   return __rdtsc();
+#else
+   return 0;
+#endif
+}
+
+// Runs 'f' in batches until 'minTime' seconds pass, returns the best batch
+result measure(const function<void()>& f, size_t bytes, double minTime)
+{
+   typedef chrono::steady_clock clock;
+
+   f(); // warm up caches and resolve the backend
+
+   size_t iterations = 1;
+   double bestSeconds = 0;
+   unsigned long long bestCycles = 0;
+   double total = 0;
+
+   for (;;)
+   {
+      const unsigned long long c0 = read_cycles();
+      const clock::time_point t0 = clock::now();
+      for (size_t i = 0; i < iterations; ++i)
+      {
+         f();
+      }
+      const double seconds = chrono::duration<double>(clock::now() - t0).count() / iterations;
+      const unsigned long long cycles = (read_cycles() - c0) / iterations;
+
+      if (bestSeconds == 0 || seconds < bestSeconds)
+      {
+         bestSeconds = seconds;
+         bestCycles = cycles;
+      }
+
+      total += seconds * iterations;
+      if (total >= minTime)
+      {
+         break;
+      }
+
+      // keep batches long enough for the clock resolution
+      if (seconds * iterations < minTime / 20)
+      {
+         iterations *= 2;
+      }
+   }
+
+   result r;
+   r.mbPerSec = bestSeconds > 0 ? bytes / bestSeconds / 1e6 : 0;
+#if defined (Z85_BENCH_HAS_TSC)
+   r.cyclesPerByte = double(bestCycles) / bytes;
+#else
+   (void)bestCycles;
+   r.cyclesPerByte = -1;
+#endif
+   r.iterations = iterations;
+   return r;
+}
+
+// Buffer, which start can be shifted off the cache line boundary
+class buffer
+{
+   vector<char> m_storage;
+   char* m_aligned;
+
+public:
+   explicit buffer(size_t size)
+      : m_storage(size + 2 * c_alignment)
+   {
+      const size_t address = (size_t)&m_storage[0];
+      m_aligned = &m_storage[0] + (c_alignment - address % c_alignment);
+   }
+
+   char* at(size_t offset)
+   {
+      return m_aligned + offset;
+   }
+};
+
+// Turns Z85_set_large_buffer_threshold() on for a scope
+struct large_buffer_mode
+{
+   large_buffer_mode() { Z85_set_large_buffer_threshold(0); }
+   ~large_buffer_mode() { Z85_set_large_buffer_threshold(Z85_LARGE_BUFFER_OFF); }
+};
+
+struct bench_case
+{
+   string name;
+   string backend; // empty if the case is run with every backend
+   size_t tableBytes; // of the backend above
+   size_t threads;
+   function<void()> run;
+};
+
+void print_header(const options& opt)
+{
+   if (opt.csv)
+   {
+      cout << "function,backend,table_bytes,size,aligned,threads,iterations,mb_per_s,cycles_per_byte\n";
+   }
+}
+
+// 'tableBytes' is the backend's share of L1 data cache, see Z85_backend_table_size()
+void print_result(const options& opt, const bench_case& c, const string& backend, size_t tableBytes,
+                  size_t size, bool aligned, const result& r)
+{
+   ostringstream cycles;
+   if (r.cyclesPerByte >= 0)
+   {
+      cycles << r.cyclesPerByte;
+   }
+
+   if (opt.csv)
+   {
+      cout << c.name << ',' << backend << ',' << tableBytes << ',' << size << ',' << (aligned ? 1 : 0) << ','
+           << c.threads << ',' << r.iterations << ',' << r.mbPerSec << ',' << cycles.str() << '\n';
+   }
+   else
+   {
+      cout << "{\"function\":\"" << c.name << "\",\"backend\":\"" << backend
+           << "\",\"table_bytes\":" << tableBytes << ",\"size\":" << size << ",\"aligned\":" << (aligned ? "true" : "false")
+           << ",\"threads\":" << c.threads << ",\"iterations\":" << r.iterations
+           << ",\"mb_per_s\":" << r.mbPerSec
+           << ",\"cycles_per_byte\":" << (r.cyclesPerByte >= 0 ? cycles.str() : "null") << "}\n";
+   }
+   cout.flush();
+}
+
+// Input sizes 8, 64, 512, ... up to 'maxSize', which is always included
+vector<size_t> bench_sizes(const options& opt)
+{
+   vector<size_t> sizes;
+   const size_t maxSize = opt.maxSize / 4 * 4;
+
+   for (size_t size = 8; size <= maxSize; size *= 8)
+   {
+      if (size >= opt.minSize)
+      {
+         sizes.push_back(size);
+      }
+   }
+
+   if (maxSize >= opt.minSize && (sizes.empty() || sizes.back() != maxSize))
+   {
+      sizes.push_back(maxSize);
+   }
+
+   return sizes;
+}
+
+vector<Z85_backend> bench_backends(const options& opt)
+{
+   vector<Z85_backend> backends;
+
+   for (int backend = Z85_BACKEND_SCALAR; Z85_backend_name((Z85_backend)backend); ++backend)
+   {
+      if ((opt.backend == "all" || opt.backend == Z85_backend_name((Z85_backend)backend)) &&
+          Z85_set_backend((Z85_backend)backend))
+      {
+         backends.push_back((Z85_backend)backend);
+      }
+   }
+
+   if (opt.backend == "auto")
+   {
+      Z85_set_backend(Z85_BACKEND_AUTO);
+      backends.push_back(Z85_get_backend());
+   }
+
+   return backends;
+}
+
+void run_size(const options& opt, const vector<Z85_backend>& backends, size_t size)
+{
+   const size_t padded = Z85_encode_with_padding_bound(size);
+   const size_t encoded = Z85_encode_bound(size);
+   const size_t outSize = max(padded + 1, Z85_encode_with_checksum_bound(size)); // the largest output
+
+   buffer bin(size), txt(encoded + 1), pad(padded), out(outSize);
+
+   // one extra byte to shift the data off the cache line boundary
+   for (size_t offset = 0; offset < 2; ++offset)
+   {
+      char* const src = bin.at(offset);
+      char* const text = txt.at(offset);
+      char* const padText = pad.at(offset);
+      char* const dst = out.at(offset);
+
+      srand(0);
+      for (size_t i = 0; i < size; ++i)
+      {
+         src[i] = (char)(rand() % 256);
+      }
+      Z85_encode(src, text, size);
+      text[encoded] = '\0'; // zmq_z85_decode takes zero terminated string
+      const size_t padSize = Z85_encode_with_padding(src, padText, size);
+      const size_t threads = opt.threads;
+
+      vector<bench_case> cases;
+      bench_case c;
+      c.threads = 1;
+      c.tableBytes = 0;
+
+      c.name = "Z85_encode";
+      c.run = [=] { Z85_encode(src, dst, size); };
+      cases.push_back(c);
+      c.name = "Z85_decode";
+      c.run = [=] { Z85_decode(text, dst, encoded); };
+      cases.push_back(c);
+      c.name = "Z85_encode_with_padding";
+      c.run = [=] { Z85_encode_with_padding(src, dst, size); };
+      cases.push_back(c);
+      c.name = "Z85_decode_with_padding";
+      c.run = [=] { Z85_decode_with_padding(padText, dst, padSize); };
+      cases.push_back(c);
+
+      c.name = "z85::encode";
+      c.run = [=] { z85::encode(src, size); };
+      cases.push_back(c);
+      c.name = "z85::decode";
+      c.run = [=] { z85::decode(text, encoded); };
+      cases.push_back(c);
+      c.name = "z85::encode_with_padding";
+      c.run = [=] { z85::encode_with_padding(src, size); };
+      cases.push_back(c);
+      c.name = "z85::decode_with_padding";
+      c.run = [=] { z85::decode_with_padding(padText, padSize); };
+      cases.push_back(c);
+
+      // the same string is reused by every call
+      const shared_ptr<string> reused = make_shared<string>();
+      c.name = "z85::encode(reused)";
+      c.run = [=] { reused->clear(); z85::encode(src, size, *reused); };
+      cases.push_back(c);
+      c.name = "z85::decode(reused)";
+      c.run = [=] { reused->clear(); z85::decode(text, encoded, *reused); };
+      cases.push_back(c);
+
+#if defined (__cpp_lib_memory_resource)
+      // a per-request arena, which is released after every call
+      const shared_ptr<vector<char> > arenaBuf = make_shared<vector<char> >(encoded + 64);
+      const shared_ptr<pmr::monotonic_buffer_resource> arena =
+         make_shared<pmr::monotonic_buffer_resource>(arenaBuf->data(), arenaBuf->size());
+      c.name = "z85::encode(arena)";
+      c.run = [=] { z85::encode_view(src, size, arena.get()); arena->release(); };
+      cases.push_back(c);
+      c.name = "z85::decode(arena)";
+      c.run = [=] { z85::decode_view(text, encoded, arena.get()); arena->release(); };
+      cases.push_back(c);
+#endif
+
+      // CurveZMQ keys, one call per key
+      const size_t keys = size / 32;
+      if (keys > 0)
+      {
+         c.name = "Z85_encode(32 byte keys)";
+         c.run = [=] { for (size_t i = 0; i < keys; ++i) Z85_encode(src + i * 32, dst + i * 40, 32); };
+         cases.push_back(c);
+         c.name = "Z85_decode(32 byte keys)";
+         c.run = [=] { for (size_t i = 0; i < keys; ++i) Z85_decode(text + i * 40, dst + i * 32, 40); };
+         cases.push_back(c);
+         c.name = "Z85_encode(32 byte keys via z85_single.h)";
+         c.run = [=] { single_encode_keys(src, dst, keys); };
+         cases.push_back(c);
+         c.name = "Z85_decode(32 byte keys via z85_single.h)";
+         c.run = [=] { single_decode_keys(text, dst, keys); };
+         cases.push_back(c);
+      }
+
+      // MIME line length
+      const size_t lineLength = 76;
+      const shared_ptr<vector<char> > wrapped =
+         make_shared<vector<char> >(Z85_encode_wrapped_bound(size, lineLength) + 1);
+      const size_t wrappedSize = Z85_encode_wrapped(src, wrapped->data(), size, lineLength);
+      c.name = "Z85_encode_wrapped";
+      c.run = [=] { Z85_encode_wrapped(src, wrapped->data(), size, lineLength); };
+      cases.push_back(c);
+      c.name = "Z85_decode_skipping_whitespace";
+      c.run = [=] { size_t errorPos; Z85_decode_skipping_whitespace(wrapped->data(), dst, wrappedSize, &errorPos); };
+      cases.push_back(c);
+      c.name = "Z85_decode_checked";
+      c.run = [=] { size_t errorPos; Z85_decode_checked(text, dst, encoded, &errorPos); };
+      cases.push_back(c);
+      c.name = "Z85_encode(large buffer mode)";
+      c.run = [=] { large_buffer_mode mode; Z85_encode(src, dst, size); };
+      cases.push_back(c);
+      c.name = "Z85_decode(large buffer mode)";
+      c.run = [=] { large_buffer_mode mode; Z85_decode(text, dst, encoded); };
+      cases.push_back(c);
+
+      // CRC32C in a second pass over the data and in the same pass as the kernels
+      const shared_ptr<vector<char> > checked = make_shared<vector<char> >(Z85_encode_with_checksum_bound(size));
+      const size_t checkedSize = Z85_encode_with_checksum(src, checked->data(), size);
+      c.name = "Z85_encode+Z85_crc32c";
+      c.run = [=] { Z85_encode(src, dst, size); Z85_crc32c(0, src, size); };
+      cases.push_back(c);
+      c.name = "Z85_decode+Z85_crc32c";
+      c.run = [=] { Z85_decode(text, dst, encoded); Z85_crc32c(0, dst, size); };
+      cases.push_back(c);
+      c.name = "Z85_encode_crc32c";
+      c.run = [=] { unsigned int crc = 0; Z85_encode_crc32c(src, dst, size, &crc); };
+      cases.push_back(c);
+      c.name = "Z85_decode_crc32c";
+      c.run = [=] { unsigned int crc = 0; Z85_decode_crc32c(text, dst, encoded, &crc); };
+      cases.push_back(c);
+      c.name = "Z85_encode_with_checksum";
+      c.run = [=] { Z85_encode_with_checksum(src, dst, size); };
+      cases.push_back(c);
+      c.name = "Z85_decode_with_checksum";
+      c.run = [=] { size_t errorPos; Z85_decode_with_checksum(checked->data(), dst, checkedSize, &errorPos); };
+      cases.push_back(c);
+
+      // Ascii85 of the same data and of sparse data: 7 of 8 cache lines are zeros
+      const shared_ptr<vector<char> > sparse = make_shared<vector<char> >(src, src + size);
+      for (size_t i = 0; i < size; ++i)
+      {
+         (*sparse)[i] = i / 64 % 8 ? 0 : (*sparse)[i];
+      }
+      const shared_ptr<vector<char> > ascii85 = make_shared<vector<char> >(Z85_ascii85_encode_bound(size));
+      const shared_ptr<vector<char> > ascii85Out = make_shared<vector<char> >(Z85_ascii85_encode_bound(size));
+      const size_t sparseSize = Z85_ascii85_encode(sparse->data(), ascii85->data(), size, 0);
+      c.name = "Z85_ascii85_encode";
+      c.run = [=] { Z85_ascii85_encode(src, ascii85Out->data(), size, 0); };
+      cases.push_back(c);
+      c.name = "Z85_ascii85_encode(sparse)";
+      c.run = [=] { Z85_ascii85_encode(sparse->data(), ascii85Out->data(), size, 0); };
+      cases.push_back(c);
+      c.name = "Z85_ascii85_decode(sparse)";
+      c.run = [=] { size_t errorPos; Z85_ascii85_decode(ascii85->data(), ascii85Out->data(), sparseSize, 0, &errorPos); };
+      cases.push_back(c);
+
+      // the input split into small messages of 32-256 bytes, encoded one by one or in a batch
+      const shared_ptr<vector<Z85_buffer_t> > messages = make_shared<vector<Z85_buffer_t> >();
+      for (size_t pos = 0, len = 32; pos < size; pos += len, len = 32 + (len * 37) % 225)
+      {
+         const Z85_buffer_t message = { src + pos, min(len, size - pos) };
+         messages->push_back(message);
+      }
+      const shared_ptr<vector<char> > batchText =
+         make_shared<vector<char> >(Z85_encode_with_padding_batch_bound(messages->data(), messages->size()) + 1);
+      const shared_ptr<vector<size_t> > batchOffsets = make_shared<vector<size_t> >(messages->size() + 1);
+      c.name = "Z85_encode_with_padding(messages)";
+      c.run = [=]
+      {
+         char* d = batchText->data();
+         for (const Z85_buffer_t& m : *messages)
+         {
+            d += Z85_encode_with_padding(m.data, d, m.size);
+         }
+      };
+      cases.push_back(c);
+      c.name = "Z85_encode_with_padding_batch";
+      c.run = [=] { Z85_encode_with_padding_batch(messages->data(), messages->size(), batchText->data(), batchOffsets->data()); };
+      cases.push_back(c);
+
+      c.threads = threads;
+      c.name = "Z85_encode_parallel";
+      c.run = [=] { Z85_encode_parallel(src, dst, size, threads, 0); };
+      cases.push_back(c);
+      c.name = "Z85_decode_parallel";
+      c.run = [=] { Z85_decode_parallel(text, dst, encoded, threads, 0); };
+      cases.push_back(c);
+      c.name = "Z85_encode_with_padding_parallel";
+      c.run = [=] { Z85_encode_with_padding_parallel(src, dst, size, threads, 0); };
+      cases.push_back(c);
+      c.name = "Z85_decode_with_padding_parallel";
+      c.run = [=] { Z85_decode_with_padding_parallel(padText, dst, padSize, threads, 0); };
+      cases.push_back(c);
+
+      // the baseline doesn't depend on the backend
+      c.threads = 1;
+      c.backend = "zmq";
+      c.tableBytes = 85 + 1 + 96;
+      c.name = "zmq_z85_encode";
+      c.run = [=] { zmq_z85_encode(dst, (const uint8_t*)src, size); };
+      cases.push_back(c);
+      c.name = "zmq_z85_decode";
+      c.run = [=] { zmq_z85_decode((uint8_t*)dst, text); };
+      cases.push_back(c);
+
+      for (size_t i = 0; i < cases.size(); ++i)
+      {
+         const bench_case& bc = cases[i];
+         if (!opt.filter.empty() && bc.name.find(opt.filter) == string::npos)
+         {
+            continue;
+         }
+
+         if (!bc.backend.empty())
+         {
+            print_result(opt, bc, bc.backend, bc.tableBytes, size, offset == 0,
+                         measure(bc.run, size, opt.minTime));
+            continue;
+         }
+
+         for (size_t b = 0; b < backends.size(); ++b)
+         {
+            Z85_set_backend(backends[b]);
+            print_result(opt, bc, Z85_backend_name(backends[b]), Z85_backend_table_size(backends[b]),
+                         size, offset == 0,
+                         measure(bc.run, size, opt.minTime));
+         }
+      }
+   }
+
+   Z85_set_backend(Z85_BACKEND_AUTO);
+}
+
+// Cache-sensitive workload: a random walk over the cache lines of a table
+class probe
+{
+   vector<size_t> m_next; // index of the next line, 8 entries per line
+
+public:
+   explicit probe(size_t size)
+      : m_next(max(size / 64, size_t(1)) * 8)
+   {
+      vector<size_t> order(m_next.size() / 8);
+      for (size_t i = 0; i < order.size(); ++i)
+      {
+         order[i] = i;
+      }
+
+      srand(1);
+      for (size_t i = order.size() - 1; i > 0; --i)
+      {
+         swap(order[i], order[rand() % (i + 1)]);
+      }
+
+      for (size_t i = 0; i < order.size(); ++i)
+      {
+         m_next[order[i] * 8] = order[(i + 1) % order.size()] * 8;
+      }
+   }
+
+   // walks through all lines once, adds the lines walked to 'steps', returns seconds spent
+   double run(size_t* steps) const
+   {
+      const chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+      size_t pos = 0;
+      size_t count = 0;
+      do
+      {
+         pos = m_next[pos];
+         ++count;
+      }
+      while (pos != 0);
+
+      *steps += count;
+      return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+   }
+
+   size_t bytes() const
+   {
+      return m_next.size() * sizeof(size_t);
+   }
+
+   size_t lines() const
+   {
+      return m_next.size() / 8;
+   }
+};
+
+// Shows how much of a cache-sensitive workload's working set transcoding of 'size' bytes evicts.
+// The workload warms up its table of 'opt.probeSize' bytes, the call runs, then the table is
+// walked again on the same thread and the walk is reported as "probe(evicted by <function>)"
+// in MB/s of the table, "probe(idle)" is the baseline. The workload doesn't run concurrently
+// with the call, so contention for memory bandwidth isn't part of the result.
+// Buffers are allocated on huge pages, so TLB misses don't blur the difference.
+void run_cache_impact(const options& opt, size_t size)
+{
+   const size_t encoded = Z85_encode_bound(size);
+   char* const  bin     = (char*)Z85_large_buffer_alloc(size);
+   char* const  txt     = (char*)Z85_large_buffer_alloc(encoded);
+   char* const  out     = (char*)Z85_large_buffer_alloc(size);
+   const probe  workload(opt.probeSize);
+
+   if (!bin || !txt || !out)
+   {
+      cerr << "Can't allocate buffers of " << size << " bytes\n";
+      Z85_large_buffer_free(bin, size);
+      Z85_large_buffer_free(txt, encoded);
+      Z85_large_buffer_free(out, size);
+      return;
+   }
+
+   srand(0);
+   for (size_t i = 0; i < size; ++i)
+   {
+      bin[i] = (char)(rand() % 256);
+   }
+   Z85_encode(bin, txt, size);
+
+   vector<bench_case> cases;
+   bench_case c;
+   c.backend = Z85_backend_name(Z85_get_backend());
+   c.tableBytes = Z85_backend_table_size(Z85_BACKEND_AUTO);
+   c.threads = 1;
+
+   c.name = "probe(idle)";
+   c.run = [] {};
+   cases.push_back(c);
+   c.name = "probe(evicted by Z85_encode)";
+   c.run = [=] { Z85_encode(bin, txt, size); };
+   cases.push_back(c);
+   c.name = "probe(evicted by Z85_encode in large buffer mode)";
+   c.run = [=] { large_buffer_mode mode; Z85_encode(bin, txt, size); };
+   cases.push_back(c);
+   c.name = "probe(evicted by Z85_decode)";
+   c.run = [=] { Z85_decode(txt, out, encoded); };
+   cases.push_back(c);
+   c.name = "probe(evicted by Z85_decode in large buffer mode)";
+   c.run = [=] { large_buffer_mode mode; Z85_decode(txt, out, encoded); };
+   cases.push_back(c);
+
+   for (size_t i = 0; i < cases.size(); ++i)
+   {
+      const bench_case& bc = cases[i];
+      if (!opt.filter.empty() && bc.name.find(opt.filter) == string::npos)
+      {
+         continue;
+      }
+
+      // the best of several rounds, the table is warmed up before each call
+      const chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+      double best = 0;
+      size_t rounds = 0;
+      size_t steps = 0; // consumed below, so the walks aren't optimized away
+      do
+      {
+         workload.run(&steps);
+         bc.run();
+         const double seconds = workload.run(&steps);
+         best = (rounds == 0 || seconds < best) ? seconds : best;
+         ++rounds;
+      }
+      while (rounds < 3 || chrono::duration<double>(chrono::steady_clock::now() - t0).count() < opt.minTime);
+
+      if (steps != 2 * rounds * workload.lines())
+      {
+         cerr << "Probe walk of " << bc.name << " missed lines\n";
+      }
+
+      result r;
+      r.mbPerSec = workload.bytes() / best / 1e6;
+      r.cyclesPerByte = -1;
+      r.iterations = rounds;
+      print_result(opt, bc, bc.backend, bc.tableBytes, size, true, r);
+   }
+
+   Z85_large_buffer_free(bin, size);
+   Z85_large_buffer_free(txt, encoded);
+   Z85_large_buffer_free(out, size);
+}
+
+// Parses sizes like 4096, 64K, 16M or 1G, fails on signs and on sizes that don't fit size_t
+bool parse_size(const char* text, size_t* size)
+{
+   if (*text < '0' || *text > '9')
+   {
+      return false;
+   }
+
+   char* end = NULL;
+   errno = 0;
+   const unsigned long long value = strtoull(text, &end, 10);
+   unsigned long long multiplier = 1;
+
+   switch (*end)
+   {
+   case 'K': case 'k': multiplier = 1ULL << 10; ++end; break;
+   case 'M': case 'm': multiplier = 1ULL << 20; ++end; break;
+   case 'G': case 'g': multiplier = 1ULL << 30; ++end; break;
+   }
+
+   if (errno == ERANGE || *end != '\0' || value > (size_t)-1 / multiplier)
+   {
+      return false;
+   }
+
+   *size = (size_t)(value * multiplier);
+   return true;
+}
+
+void usage(const char* program)
+{
+   cerr << "Usage: " << program << " [options]\n"
+        << "  --min-size SIZE   smallest input size in bytes (default 8)\n"
+        << "  --max-size SIZE   largest input size, up to 1G (default 16M)\n"
+        << "  --threads N       thread count of the parallel functions (default: all cores)\n"
+        << "  --backend NAME    backend to measure or \"all\" (default) or \"auto\"\n"
+        << "  --filter TEXT     measure only functions which names contain TEXT\n"
+        << "  --min-time SEC    time spent on every measurement (default 0.05)\n"
+        << "  --probe-size SIZE table of the cache-sensitive workload, which transcoding of the\n"
+        << "                    largest input may evict from cache (default 4M), see run_cache_impact()\n"
+        << "  --csv             print CSV instead of JSON lines\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+   options opt;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      const string arg = argv[i];
+      const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+      bool ok = true;
+
+      if (arg == "--csv")
+      {
+         opt.csv = true;
+         continue;
+      }
+
+      if (arg == "--help" || arg == "-h" || !value)
+      {
+         usage(argv[0]);
+         return arg == "--help" || arg == "-h" ? 0 : 1;
+      }
+
+      ++i;
+      if (arg == "--min-size")
+      {
+         ok = parse_size(value, &opt.minSize);
+      }
+      else if (arg == "--max-size")
+      {
+         ok = parse_size(value, &opt.maxSize) && opt.maxSize <= c_maxInputSize;
+      }
+      else if (arg == "--threads")
+      {
+         ok = parse_size(value, &opt.threads) && opt.threads > 0;
+      }
+      else if (arg == "--min-time")
+      {
+         opt.minTime = atof(value);
+      }
+      else if (arg == "--backend")
+      {
+         opt.backend = value;
+      }
+      else if (arg == "--filter")
+      {
+         opt.filter = value;
+      }
+      else if (arg == "--probe-size")
+      {
+         ok = parse_size(value, &opt.probeSize) && opt.probeSize > 0;
+      }
+      else
+      {
+         ok = false;
+      }
+
+      if (!ok)
+      {
+         cerr << "Invalid option: " << arg << ' ' << value << '\n';
+         usage(argv[0]);
+         return 1;
+      }
+   }
+
+   const vector<Z85_backend> backends = bench_backends(opt);
+   if (backends.empty())
+   {
+      cerr << "Backend \"" << opt.backend << "\" isn't supported\n";
+      return 1;
+   }
+
+   print_header(opt);
+
+   const vector<size_t> sizes = bench_sizes(opt);
+   for (size_t i = 0; i < sizes.size(); ++i)
+   {
+      run_size(opt, backends, sizes[i]);
+   }
+
+   if (!sizes.empty())
+   {
+      Z85_set_backend(backends.back());
+      run_cache_impact(opt, sizes.back());
+      Z85_set_backend(Z85_BACKEND_AUTO);
+   }
+
+   return 0;
+}
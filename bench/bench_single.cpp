@@ -0,0 +1,21 @@
+// 32 byte keys transcoded by a private copy of z85_single.h, bench.cpp compares it with the library
+
+#undef Z85_STATS // counters live in the libraries only
+#define Z85_STATIC
+#include "z85_single.h"
+
+void single_encode_keys(const char* source, char* dest, size_t count)
+{
+   for (size_t i = 0; i < count; ++i)
+   {
+      Z85_encode(source + i * 32, dest + i * 40, 32);
+   }
+}
+
+void single_decode_keys(const char* source, char* dest, size_t count)
+{
+   for (size_t i = 0; i < count; ++i)
+   {
+      Z85_decode(source + i * 40, dest + i * 32, 40);
+   }
+}
@@ -0,0 +1,38 @@
+/*
+ * Reference Z85 implementation from libzmq (src/zmq_utils.cpp),
+ * vendored as a benchmark baseline.
+ *
+ * Copyright (c) 2007-2016 Contributors as noted in the AUTHORS file of libzmq.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Encodes 'size_' bytes from 'data_', 'size_' must be divisible by 4.
+ *        Writes size_ * 5 / 4 symbols and the terminating zero to 'dest_'.
+ *
+ * @return 'dest_' or NULL on error
+ */
+char* zmq_z85_encode(char* dest_, const uint8_t* data_, size_t size_);
+
+/**
+ * @brief Decodes zero-terminated 'string_' to 'dest_'.
+ *
+ * @return 'dest_' or NULL on error
+ */
+uint8_t* zmq_z85_decode(uint8_t* dest_, const char* string_);
+
+#if defined (__cplusplus)
+}
+#endif
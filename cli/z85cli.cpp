@@ -0,0 +1,908 @@
+// Command line transcoder of files and standard streams.
+//
+// Regular input files are memory mapped. Pipes and terminals go through a reader -> transcoder -> writer
+// pipeline with two buffers per stage, so reading and writing overlap with the kernels.
+// Every chunk is split on frame boundaries between threads of a pool, which is started once.
+//
+// Build with optimizations and without coverage instrumentation to reach memory bandwidth:
+//    cmake .. -DCMAKE_BUILD_TYPE=Release -DZ85_COVERAGE=OFF
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "z85.h"
+
+using namespace std;
+
+namespace
+{
+
+// Chunks are multiples of both frame sizes (4 bytes and 5 symbols)
+const size_t c_unit = 20;
+
+// A remainder shorter than this joins the last chunk, so the padded tail is never split
+const size_t c_lookahead = 8;
+
+// Limits of --threads and --chunk-size
+const size_t c_maxThreads = 256;
+const size_t c_maxChunkSize = 1 << 30;
+
+// Each thread gets at least this many frames of a chunk, so waking it up pays off
+const size_t c_minThreadFrames = 1 << 16;
+
+enum format
+{
+   format_spec,             // Z85_encode()
+   format_padding,          // Z85_encode_with_padding()
+   format_trailing_padding  // Z85_encode_with_trailing_padding()
+};
+
+struct options
+{
+   bool decode;
+   format fmt;
+   size_t threads;
+   size_t chunkSize;
+   bool populate;
+   bool stats;
+   string input;  // "-" is stdin
+   string output; // "-" is stdout
+
+   options()
+      : decode(false)
+      , fmt(format_spec)
+      , threads(thread::hardware_concurrency())
+      , chunkSize((8 << 20) / c_unit * c_unit)
+      , populate(false)
+      , stats(false)
+      , input("-")
+      , output("-")
+   {
+      threads = max<size_t>(1, min(threads, c_maxThreads));
+   }
+};
+
+struct chunk
+{
+   const char* data;
+   size_t size;
+   bool first;
+   bool last;
+   char* storage; // buffer to be given back to the reader, NULL for mapped input
+};
+
+struct output_chunk
+{
+   char* data; // NULL ends the stream
+   size_t size;
+};
+
+// Blocking queue connecting the pipeline stages
+template<typename T>
+class channel
+{
+   mutex m_mutex;
+   condition_variable m_ready;
+   deque<T> m_items;
+
+public:
+   void push(const T& item)
+   {
+      lock_guard<mutex> lock(m_mutex);
+      m_items.push_back(item);
+      m_ready.notify_one();
+   }
+
+   T pop()
+   {
+      unique_lock<mutex> lock(m_mutex);
+      m_ready.wait(lock, [this] { return !m_items.empty(); });
+      const T item = m_items.front();
+      m_items.pop_front();
+      return item;
+   }
+};
+
+string system_error(const string& what)
+{
+   return what + ": " + strerror(errno);
+}
+
+// Reads until 'size' bytes or the end of input, returns the number of bytes read or -1 on error
+ssize_t read_full(int fd, char* buf, size_t size)
+{
+   size_t done = 0;
+
+   while (done < size)
+   {
+      const ssize_t n = read(fd, buf + done, size - done);
+      if (n < 0 && errno == EINTR)
+      {
+         continue;
+      }
+      if (n < 0)
+      {
+         return -1;
+      }
+      if (n == 0)
+      {
+         break;
+      }
+      done += n;
+   }
+
+   return (ssize_t)done;
+}
+
+bool write_full(int fd, const char* buf, size_t size)
+{
+   while (size)
+   {
+      const ssize_t n = write(fd, buf, size);
+      if (n < 0 && errno == EINTR)
+      {
+         continue;
+      }
+      if (n < 0)
+      {
+         return false;
+      }
+      buf += n;
+      size -= n;
+   }
+
+   return true;
+}
+
+// Threads reused for every chunk, the calling thread takes the first slice of a task
+class worker_pool
+{
+   mutex m_mutex;
+   condition_variable m_start;
+   condition_variable m_done;
+   const function<void(size_t)>* m_task; // valid until run() returns
+   size_t m_slices;
+   size_t m_pending;
+   unsigned long long m_generation; // incremented by every run()
+   bool m_stop;
+   vector<thread> m_threads;
+
+   void work(size_t slice)
+   {
+      unsigned long long seen = 0;
+
+      for (;;)
+      {
+         unique_lock<mutex> lock(m_mutex);
+         m_start.wait(lock, [&] { return m_stop || m_generation != seen; });
+         if (m_stop)
+         {
+            return;
+         }
+
+         seen = m_generation;
+         if (slice < m_slices)
+         {
+            const function<void(size_t)>* task = m_task;
+            lock.unlock();
+            (*task)(slice);
+            lock.lock();
+            if (--m_pending == 0)
+            {
+               m_done.notify_one();
+            }
+         }
+      }
+   }
+
+public:
+   explicit worker_pool(size_t threads)
+      : m_task(NULL)
+      , m_slices(0)
+      , m_pending(0)
+      , m_generation(0)
+      , m_stop(false)
+   {
+      for (size_t i = 1; i < threads; ++i)
+      {
+         m_threads.push_back(thread(&worker_pool::work, this, i));
+      }
+   }
+
+   ~worker_pool()
+   {
+      {
+         lock_guard<mutex> lock(m_mutex);
+         m_stop = true;
+      }
+      m_start.notify_all();
+
+      for (size_t i = 0; i < m_threads.size(); ++i)
+      {
+         m_threads[i].join();
+      }
+   }
+
+   size_t size() const
+   {
+      return m_threads.size() + 1;
+   }
+
+   // Runs 'task(slice)' for every slice of [0;slices), 'slices' isn't larger than size()
+   void run(size_t slices, const function<void(size_t)>& task)
+   {
+      if (slices <= 1)
+      {
+         task(0);
+         return;
+      }
+
+      {
+         lock_guard<mutex> lock(m_mutex);
+         m_task = &task;
+         m_slices = slices;
+         m_pending = slices - 1;
+         ++m_generation;
+      }
+      m_start.notify_all();
+
+      task(0);
+
+      unique_lock<mutex> lock(m_mutex);
+      m_done.wait(lock, [this] { return m_pending == 0; });
+   }
+};
+
+// Runs 'fn(slice, first, count)' on 'frames' frames split between threads of 'pool'
+template<typename Fn>
+void parallel_frames(worker_pool& pool, size_t frames, Fn fn)
+{
+   const size_t threads = max<size_t>(1, min(pool.size(), frames / c_minThreadFrames));
+   const size_t perThread = frames / threads;
+
+   pool.run(threads, [&](size_t slice)
+   {
+      fn(slice, slice * perThread, slice + 1 == threads ? frames - slice * perThread : perThread);
+   });
+}
+
+// Transcodes the stream chunk by chunk, keeps the state of padded formats between chunks
+class transcoder
+{
+   const options& m_opt;
+   worker_pool m_pool;
+   unsigned long long m_totalSize; // input size, only needed to encode with leading padding
+   unsigned long long m_pos;       // stream position of the current chunk
+   char m_tailBytes;               // tail bytes count of leading padding
+   string m_error;
+
+   bool fail(const string& message, unsigned long long pos)
+   {
+      ostringstream text;
+      text << message << " at offset " << pos;
+      m_error = text.str();
+      return false;
+   }
+
+   void encode_frames(const char* src, size_t size, char* dst)
+   {
+      parallel_frames(m_pool, size / 4, [=](size_t, size_t first, size_t count)
+      {
+         Z85_encode(src + first * 4, dst + first * 5, count * 4);
+      });
+   }
+
+   bool decode_frames(const char* src, size_t size, char* dst, unsigned long long pos)
+   {
+      vector<size_t> errors(m_opt.threads, Z85_NPOS);
+
+      parallel_frames(m_pool, size / 5, [&](size_t slice, size_t first, size_t count)
+      {
+         size_t errorPos;
+         Z85_decode_checked(src + first * 5, dst + first * 4, count * 5, &errorPos);
+         if (errorPos != Z85_NPOS)
+         {
+            errors[slice] = first * 5 + errorPos;
+         }
+      });
+
+      const size_t errorPos = *min_element(errors.begin(), errors.end());
+      return errorPos == Z85_NPOS || fail("invalid symbol", pos + errorPos);
+   }
+
+   bool encode(const chunk& c, char* dest, size_t* written)
+   {
+      char* dst = dest;
+      size_t tailBytes = 0;
+
+      if (c.last)
+      {
+         tailBytes = c.size % 4;
+         if (m_opt.fmt == format_spec && tailBytes)
+         {
+            return fail("input size isn't divisible by 4, use --padding or --trailing-padding", m_pos + c.size);
+         }
+         if (m_opt.fmt == format_trailing_padding && tailBytes == 0 && c.size)
+         {
+            tailBytes = 4; // the last frame goes along with the tail bytes count
+         }
+      }
+
+      if (c.first && m_opt.fmt == format_padding && m_totalSize)
+      {
+         (dst++)[0] = (m_totalSize % 4 == 0 ? '4' : '0' + (char)(m_totalSize % 4));
+      }
+
+      const size_t body = c.size - tailBytes;
+      encode_frames(c.data, body, dst);
+      dst += Z85_encode_bound(body);
+
+      if (tailBytes && m_opt.fmt == format_padding)
+      {
+         char tail[6];
+         Z85_encode_with_padding(c.data + body, tail, tailBytes);
+         memcpy(dst, tail + 1, 5); // the tail bytes count is already written
+         dst += 5;
+      }
+      else if (tailBytes)
+      {
+         dst += Z85_encode_with_trailing_padding(c.data + body, dst, tailBytes);
+      }
+
+      *written = dst - dest;
+      return true;
+   }
+
+   bool decode(const chunk& c, char* dest, size_t* written)
+   {
+      const char* src = c.data;
+      size_t size = c.size;
+      size_t tailSymbols = 0;
+      unsigned long long pos = m_pos;
+      char* dst = dest;
+
+      if (c.first && m_opt.fmt == format_padding && size)
+      {
+         m_tailBytes = (src++)[0];
+         --size;
+         ++pos;
+         if (m_tailBytes < '1' || m_tailBytes > '4')
+         {
+            return fail("wrong tail bytes count", m_pos);
+         }
+      }
+
+      if (c.last && m_opt.fmt != format_spec && c.size)
+      {
+         tailSymbols = m_opt.fmt == format_padding ? 5 : 6;
+         if (size < tailSymbols || (size - tailSymbols) % 5)
+         {
+            return fail("truncated input", pos + size);
+         }
+      }
+      else if (c.last && size % 5)
+      {
+         return fail("input size isn't divisible by 5", pos + size);
+      }
+
+      const size_t body = size - tailSymbols;
+      if (!decode_frames(src, body, dst, pos))
+      {
+         return false;
+      }
+      dst += Z85_decode_bound(body);
+
+      if (tailSymbols)
+      {
+         char tail[6];
+         size_t errorPos;
+         size_t tailSize;
+
+         if (m_opt.fmt == format_padding)
+         {
+            tail[0] = m_tailBytes;
+            memcpy(tail + 1, src + body, 5);
+            tailSize = Z85_decode_with_padding_checked(tail, dst, 6, &errorPos);
+            if (errorPos != Z85_NPOS)
+            {
+               errorPos -= 1; // the tail bytes count is already checked
+            }
+         }
+         else
+         {
+            tailSize = Z85_decode_with_trailing_padding_checked(src + body, dst, 6, &errorPos);
+         }
+
+         if (errorPos != Z85_NPOS)
+         {
+            return fail("invalid symbol", pos + body + errorPos);
+         }
+         dst += tailSize;
+      }
+
+      *written = dst - dest;
+      return true;
+   }
+
+public:
+   transcoder(const options& opt, unsigned long long totalSize)
+      : m_opt(opt)
+      , m_pool(opt.threads)
+      , m_totalSize(totalSize)
+      , m_pos(0)
+      , m_tailBytes('4')
+   {
+   }
+
+   // Largest output of a chunk of 'size' bytes (symbols)
+   size_t bound(size_t size) const
+   {
+      return m_opt.decode ? Z85_decode_bound(size) + 4 : Z85_encode_with_padding_bound(size) + 1;
+   }
+
+   bool run(const chunk& c, char* dest, size_t* written)
+   {
+      const bool ok = m_opt.decode ? decode(c, dest, written) : encode(c, dest, written);
+      m_pos += c.size;
+      return ok;
+   }
+
+   const string& error() const
+   {
+      return m_error;
+   }
+};
+
+// State shared with the reader thread, which is abandoned if the output fails
+struct reader_state
+{
+   int fd;
+   size_t head;
+   size_t chunkSize;
+   vector<vector<char> > buffers;
+   channel<char*> freeBuffers;
+   channel<chunk> chunks;
+   string error; // set before the last chunk is pushed
+};
+
+// Reads chunks of 'chunkSize' bytes ('head' more for the first one), see c_lookahead
+void read_chunks(shared_ptr<reader_state> state)
+{
+   char carry[c_lookahead];
+   size_t carrySize = 0;
+
+   for (bool first = true; ; first = false)
+   {
+      char* buf = state->freeBuffers.pop();
+      const size_t want = state->chunkSize + (first ? state->head : 0);
+      size_t size = carrySize;
+      bool last = false;
+
+      memcpy(buf, carry, carrySize);
+      ssize_t n = read_full(state->fd, buf + size, want - size);
+      if (n >= 0)
+      {
+         size += n;
+         last = size < want;
+      }
+
+      // peek, so the end of input is known before the chunk is handed over
+      if (n >= 0 && !last)
+      {
+         n = read_full(state->fd, carry, c_lookahead);
+         carrySize = n >= 0 ? n : 0;
+         if (carrySize < c_lookahead)
+         {
+            memcpy(buf + size, carry, carrySize);
+            size += carrySize;
+            last = true;
+         }
+      }
+
+      if (n < 0)
+      {
+         state->error = system_error("can't read input");
+         size = 0;
+         last = true;
+      }
+
+      const chunk c = { buf, size, first, last, buf };
+      state->chunks.push(c);
+
+      if (last)
+      {
+         return;
+      }
+   }
+}
+
+void write_chunks(int fd, channel<output_chunk>& filled, channel<char*>& freeBuffers, atomic<bool>* failed,
+                  string* error)
+{
+   for (;;)
+   {
+      const output_chunk c = filled.pop();
+      if (!c.data)
+      {
+         return;
+      }
+
+      if (!*failed && !write_full(fd, c.data, c.size))
+      {
+         *error = system_error("can't write output");
+         *failed = true;
+      }
+
+      freeBuffers.push(c.data);
+   }
+}
+
+// Input is either mapped (or read in full) or streamed by the reader thread
+class input
+{
+   int m_fd;
+   const char* m_data;
+   size_t m_size;
+   bool m_mapped;
+   vector<char> m_contents;
+
+public:
+   input() : m_fd(-1), m_data(NULL), m_size(0), m_mapped(false) {}
+
+   ~input()
+   {
+      if (m_mapped)
+      {
+         munmap((void*)m_data, m_size);
+      }
+      if (m_fd > 0)
+      {
+         close(m_fd);
+      }
+   }
+
+   bool open(const options& opt, string* error)
+   {
+      m_fd = opt.input == "-" ? 0 : ::open(opt.input.c_str(), O_RDONLY);
+      if (m_fd < 0)
+      {
+         *error = system_error("can't open " + opt.input);
+         return false;
+      }
+
+      struct stat st;
+      if (fstat(m_fd, &st) == 0 && S_ISREG(st.st_mode) && lseek(m_fd, 0, SEEK_CUR) == 0)
+      {
+         m_size = (size_t)st.st_size;
+         if (m_size == 0)
+         {
+            m_data = "";
+            return true;
+         }
+
+         int flags = MAP_PRIVATE;
+#if defined (MAP_POPULATE)
+         if (opt.populate)
+         {
+            flags |= MAP_POPULATE;
+         }
+#endif
+         void* data = mmap(NULL, m_size, PROT_READ, flags, m_fd, 0);
+         if (data != MAP_FAILED)
+         {
+            madvise(data, m_size, MADV_SEQUENTIAL);
+            m_data = (const char*)data;
+            m_mapped = true;
+            return true;
+         }
+      }
+
+      // leading padding is written before the data, so its length must be known in advance
+      if (!opt.decode && opt.fmt == format_padding)
+      {
+         return read_all(error);
+      }
+
+      return true;
+   }
+
+   bool read_all(string* error)
+   {
+      const size_t step = 1 << 20;
+      ssize_t n;
+
+      do
+      {
+         m_contents.resize(m_size + step);
+         n = read_full(m_fd, &m_contents[0] + m_size, step);
+         m_size += n > 0 ? n : 0;
+      }
+      while (n == (ssize_t)step);
+
+      if (n < 0)
+      {
+         *error = system_error("can't read input");
+         return false;
+      }
+
+      m_data = m_contents.data();
+      return true;
+   }
+
+   int fd() const { return m_fd; }
+   const char* data() const { return m_data; }
+   size_t size() const { return m_size; }
+   bool mapped() const { return m_mapped; }
+};
+
+bool run(const options& opt, string* error, unsigned long long* inputSize, unsigned long long* outputSize,
+         string* mode)
+{
+   input in;
+   if (!in.open(opt, error))
+   {
+      return false;
+   }
+
+   const int out = opt.output == "-" ? 1 : open(opt.output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+   if (out < 0)
+   {
+      *error = system_error("can't open " + opt.output);
+      return false;
+   }
+
+   const bool streamed = !in.data();
+   const size_t head = opt.decode && opt.fmt == format_padding ? 1 : 0;
+   const size_t maxChunk = opt.chunkSize + head + c_lookahead;
+
+   transcoder coder(opt, in.size());
+   *mode = streamed ? "pipeline" : in.mapped() ? "mmap" : "memory";
+
+   // two buffers per stage: one is being filled, while the other one is being processed
+   vector<vector<char> > buffers(2, vector<char>(coder.bound(maxChunk)));
+   channel<char*> freeOutputs;
+   channel<output_chunk> outputs;
+   const shared_ptr<reader_state> source = make_shared<reader_state>();
+
+   source->fd = in.fd();
+   source->head = head;
+   source->chunkSize = opt.chunkSize;
+
+   for (size_t i = 0; i < 2; ++i)
+   {
+      freeOutputs.push(buffers[i].data());
+      if (streamed)
+      {
+         source->buffers.push_back(vector<char>(maxChunk));
+         source->freeBuffers.push(source->buffers.back().data());
+      }
+   }
+
+   atomic<bool> writeFailed(false);
+   string writeError;
+   thread writer(write_chunks, out, ref(outputs), ref(freeOutputs), &writeFailed, &writeError);
+   thread reader;
+
+   if (streamed)
+   {
+      reader = thread(read_chunks, source);
+   }
+
+   size_t pos = 0;
+   bool ok = true;
+
+   for (bool first = true, last = false; !last && ok && !writeFailed; first = false)
+   {
+      chunk c;
+
+      if (streamed)
+      {
+         c = source->chunks.pop();
+      }
+      else
+      {
+         // the same chunks as the reader makes
+         size_t size = min(in.size() - pos, opt.chunkSize + (first ? head : 0));
+         if (in.size() - pos - size < c_lookahead)
+         {
+            size = in.size() - pos;
+         }
+         const chunk mapped = { in.data() + pos, size, first, pos + size == in.size(), NULL };
+         c = mapped;
+         pos += size;
+      }
+
+      last = c.last;
+      output_chunk o = { freeOutputs.pop(), 0 };
+      ok = (!streamed || source->error.empty()) && coder.run(c, o.data, &o.size);
+
+      *inputSize += c.size;
+      *outputSize += o.size;
+
+      outputs.push(o);
+      if (c.storage)
+      {
+         source->freeBuffers.push(c.storage);
+      }
+   }
+
+   const output_chunk end = { NULL, 0 };
+   outputs.push(end);
+   writer.join();
+
+   if (reader.joinable())
+   {
+      // the reader may still wait for input nobody needs
+      if (ok && !writeFailed)
+      {
+         reader.join();
+      }
+      else
+      {
+         reader.detach();
+      }
+   }
+
+   if (out != 1 && close(out) != 0 && writeError.empty())
+   {
+      writeError = system_error("can't write output");
+   }
+
+   const string readError = streamed && ok && !writeFailed ? source->error : string();
+   *error = !readError.empty() ? readError : !coder.error().empty() ? coder.error() : writeError;
+   return error->empty();
+}
+
+// Parses sizes like 4096, 64K, 16M or 1G, fails on signs and on sizes that don't fit size_t
+bool parse_size(const char* text, size_t* size)
+{
+   if (*text < '0' || *text > '9')
+   {
+      return false;
+   }
+
+   char* end = NULL;
+   errno = 0;
+   const unsigned long long value = strtoull(text, &end, 10);
+   unsigned long long multiplier = 1;
+
+   switch (*end)
+   {
+   case 'K': case 'k': multiplier = 1ULL << 10; ++end; break;
+   case 'M': case 'm': multiplier = 1ULL << 20; ++end; break;
+   case 'G': case 'g': multiplier = 1ULL << 30; ++end; break;
+   }
+
+   if (errno == ERANGE || *end != '\0' || value > (size_t)-1 / multiplier)
+   {
+      return false;
+   }
+
+   *size = (size_t)(value * multiplier);
+   return true;
+}
+
+void usage(const char* program)
+{
+   cerr << "Usage: " << program << " [options] [input [output]]\n"
+        << "Encodes (decodes) input file or stdin into output file or stdout (\"-\" is a standard stream).\n"
+        << "  -d, --decode            decode instead of encoding\n"
+        << "  -p, --padding           any input size, tail bytes count goes first (Z85_encode_with_padding)\n"
+        << "  -t, --trailing-padding  any input size, tail bytes count goes last (Z85_encode_with_trailing_padding)\n"
+        << "  -j, --threads N         transcoding threads, up to 256 (default: all cores)\n"
+        << "  --chunk-size SIZE       bytes (symbols) transcoded at once, up to 1G (default 8M)\n"
+        << "  --populate              prefault mapped input (MAP_POPULATE)\n"
+        << "  --stats                 print throughput to stderr\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+   options opt;
+   size_t positional = 0;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      const string arg = argv[i];
+      const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+      bool ok = true;
+
+      if (arg == "--help" || arg == "-h")
+      {
+         usage(argv[0]);
+         return 0;
+      }
+      else if (arg == "-d" || arg == "--decode")
+      {
+         opt.decode = true;
+      }
+      else if (arg == "-p" || arg == "--padding")
+      {
+         opt.fmt = format_padding;
+      }
+      else if (arg == "-t" || arg == "--trailing-padding")
+      {
+         opt.fmt = format_trailing_padding;
+      }
+      else if (arg == "--populate")
+      {
+         opt.populate = true;
+      }
+      else if (arg == "--stats")
+      {
+         opt.stats = true;
+      }
+      else if ((arg == "-j" || arg == "--threads") && value)
+      {
+         ok = parse_size(value, &opt.threads) && opt.threads > 0 && opt.threads <= c_maxThreads;
+         ++i;
+      }
+      else if (arg == "--chunk-size" && value)
+      {
+         ok = parse_size(value, &opt.chunkSize) && opt.chunkSize >= c_unit && opt.chunkSize <= c_maxChunkSize;
+         opt.chunkSize -= opt.chunkSize % c_unit;
+         ++i;
+      }
+      else if ((arg == "-" || arg[0] != '-') && positional < 2)
+      {
+         (positional++ == 0 ? opt.input : opt.output) = arg;
+      }
+      else
+      {
+         ok = false;
+      }
+
+      if (!ok)
+      {
+         cerr << "Invalid option: " << arg << '\n';
+         usage(argv[0]);
+         return 1;
+      }
+   }
+
+   typedef chrono::steady_clock clock;
+   const clock::time_point start = clock::now();
+
+   string error;
+   string mode;
+   unsigned long long inputSize = 0;
+   unsigned long long outputSize = 0;
+
+   if (!run(opt, &error, &inputSize, &outputSize, &mode))
+   {
+      cerr << argv[0] << ": " << error << '\n';
+      return 1;
+   }
+
+   if (opt.stats)
+   {
+      const double seconds = chrono::duration<double>(clock::now() - start).count();
+      const unsigned long long binarySize = opt.decode ? outputSize : inputSize;
+
+      cerr << (opt.decode ? "decoded " : "encoded ") << inputSize << " -> " << outputSize << " bytes in "
+           << seconds << " s, " << (seconds > 0 ? binarySize / seconds / 1e6 : 0) << " MB/s ("
+           << mode << ", " << opt.threads << " threads, " << Z85_backend_name(Z85_get_backend()) << " backend)\n";
+   }
+
+   return 0;
+}
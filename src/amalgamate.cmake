@@ -0,0 +1,45 @@
+# Generates z85_single.h: copies TEMPLATE to OUTPUT, replacing every #include "file" with
+# the contents of SOURCE_DIR/file (recursively, each file once). License headers and
+# #pragma once of the included files are dropped, the template has its own.
+#
+#    cmake -DTEMPLATE=z85_single.h.in -DSOURCE_DIR=. -DOUTPUT=z85_single.h -P amalgamate.cmake
+
+set (Z85_INCLUDED "")
+
+function (z85_amalgamate path result)
+  file (READ "${path}" text)
+
+  # the leading comment of included files is the license, they have #pragma once
+  if (NOT path STREQUAL TEMPLATE AND text MATCHES "^/\\*")
+    string (FIND "${text}" "*/" end)
+    math (EXPR end "${end} + 2")
+    string (SUBSTRING "${text}" ${end} -1 text)
+    string (REGEX REPLACE "\n#pragma once[^\n]*" "" text "${text}")
+  endif ()
+
+  set (output "")
+  while (text MATCHES "\n[ \t]*#[ \t]*include[ \t]+\"([^\"]+)\"[^\n]*")
+    set (directive "${CMAKE_MATCH_0}")
+    set (name "${CMAKE_MATCH_1}")
+    string (FIND "${text}" "${directive}" begin)
+    string (LENGTH "${directive}" length)
+    math (EXPR end "${begin} + ${length}")
+    string (SUBSTRING "${text}" 0 ${begin} head)
+    string (SUBSTRING "${text}" ${end} -1 text)
+    string (APPEND output "${head}\n")
+
+    list (FIND Z85_INCLUDED "${name}" found)
+    if (found EQUAL -1)
+      set (Z85_INCLUDED ${Z85_INCLUDED} "${name}" PARENT_SCOPE)
+      set (Z85_INCLUDED ${Z85_INCLUDED} "${name}")
+      z85_amalgamate ("${SOURCE_DIR}/${name}" contents)
+      string (APPEND output "\n// ---- ${name} ----\n${contents}\n// ---- end of ${name} ----\n")
+    endif ()
+  endwhile ()
+
+  string (APPEND output "${text}")
+  set (${result} "${output}" PARENT_SCOPE)
+endfunction ()
+
+z85_amalgamate ("${TEMPLATE}" text)
+file (WRITE "${OUTPUT}" "${text}")
@@ -30,9 +30,86 @@
 
 #include <assert.h>
 #include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Instrumented entry points are compiled under internal names and the public ones wrap them
+// (see "Instrumentation" section), so calls inside the library aren't counted twice
+#if defined (Z85_STATS)
+   #define Z85_encode_with_padding                     Z85_encode_with_padding_uncounted
+   #define Z85_decode_with_padding                     Z85_decode_with_padding_uncounted
+   #define Z85_encode_with_trailing_padding            Z85_encode_with_trailing_padding_uncounted
+   #define Z85_decode_with_trailing_padding            Z85_decode_with_trailing_padding_uncounted
+   #define Z85_encode                                  Z85_encode_uncounted
+   #define Z85_decode                                  Z85_decode_uncounted
+   #define Z85_encode_unsafe                           Z85_encode_unsafe_uncounted
+   #define Z85_decode_unsafe                           Z85_decode_unsafe_uncounted
+   #define Z85_decode_checked                          Z85_decode_checked_uncounted
+   #define Z85_decode_with_padding_checked             Z85_decode_with_padding_checked_uncounted
+   #define Z85_decode_with_trailing_padding_checked    Z85_decode_with_trailing_padding_checked_uncounted
+   #define Z85_validate                                Z85_validate_uncounted
+   #define Z85_encode_wrapped                          Z85_encode_wrapped_uncounted
+   #define Z85_encode_with_padding_wrapped             Z85_encode_with_padding_wrapped_uncounted
+   #define Z85_decode_skipping_whitespace              Z85_decode_skipping_whitespace_uncounted
+   #define Z85_decode_with_padding_skipping_whitespace Z85_decode_with_padding_skipping_whitespace_uncounted
+   #define Z85_encoder_update                          Z85_encoder_update_uncounted
+   #define Z85_encoder_finish                          Z85_encoder_finish_uncounted
+   #define Z85_decoder_update                          Z85_decoder_update_uncounted
+   #define Z85_decoder_finish                          Z85_decoder_finish_uncounted
+   #define Z85_encode_with_padding_parallel            Z85_encode_with_padding_parallel_uncounted
+   #define Z85_decode_with_padding_parallel            Z85_decode_with_padding_parallel_uncounted
+   #define Z85_encode_parallel                         Z85_encode_parallel_uncounted
+   #define Z85_decode_parallel                         Z85_decode_parallel_uncounted
+   #define Z85_encode_with_padding_batch               Z85_encode_with_padding_batch_uncounted
+   #define Z85_encode_with_padding_columnar            Z85_encode_with_padding_columnar_uncounted
+   #define Z85_encode_with_padding_inplace             Z85_encode_with_padding_inplace_uncounted
+   #define Z85_decode_with_padding_inplace             Z85_decode_with_padding_inplace_uncounted
+   #define Z85_encode_with_trailing_padding_inplace    Z85_encode_with_trailing_padding_inplace_uncounted
+   #define Z85_decode_with_trailing_padding_inplace    Z85_decode_with_trailing_padding_inplace_uncounted
+   #define Z85_encode_inplace                          Z85_encode_inplace_uncounted
+   #define Z85_decode_inplace                          Z85_decode_inplace_uncounted
+#endif
 
 #include "z85.h"
 
+// x86 SIMD kernels are compiled with per-function target attributes,
+// so the rest of the file doesn't need any special compiler flags
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__)) && !defined (Z85_NO_SIMD)
+   #define Z85_X86_SIMD
+   #include <immintrin.h>
+#endif
+
+// parallel functions fall back to the calling thread if threads are not available
+#if !defined (_WIN32) && !defined (Z85_NO_THREADS)
+   #define Z85_THREADS
+   #include <pthread.h>
+   #include <unistd.h>
+#endif
+
+// large buffers are allocated on transparent huge pages (strict ISO modes hide MAP_ANONYMOUS)
+#if defined (__linux__)
+   #include <sys/mman.h>
+   #if defined (MAP_ANONYMOUS)
+      #define Z85_HUGE_PAGES
+   #endif
+#endif
+
+// instrumentation relies on GCC builtins for thread local counters and atomics
+#if defined (Z85_STATS)
+   #if !defined (__GNUC__)
+      #error "Z85_STATS requires GCC or Clang"
+   #endif
+   #if !defined (__x86_64__) && !defined (__i386__)
+      #include <time.h>
+   #endif
+   #if defined (__linux__) && defined (__has_include)
+      #if __has_include (<sys/sdt.h>)
+         #define Z85_USDT
+         #include <sys/sdt.h>
+      #endif
+   #endif
+#endif
+
 typedef unsigned int  uint32_t;
 typedef unsigned char byte;
 
@@ -45,36 +122,138 @@ typedef char Z85_div85_magic_static_assert[(sizeof(DIV85_MAGIC) * CHAR_BIT == 64
 
 #define DIV85(number) ((uint32_t)((DIV85_MAGIC * number) >> 32) >> 6)
 
-static const char* base85 =
-{
-   "0123456789"
-   "abcdefghij"
-   "klmnopqrst"
-   "uvwxyzABCD"
-   "EFGHIJKLMN"
-   "OPQRSTUVWX"
-   "YZ.-:+=^!/"
-   "*?&<>()[]{"
-   "}@%$#"
+// multiply-shift constants used by SIMD kernels:
+//   x / 7225 == (x * DIV7225_MAGIC) >> 44 for x < 2^32 / 85
+//   x / 85   == (x * DIV85_MAGIC_16) >> 22 for x < 2^16
+#define DIV7225_MAGIC  2434904643ULL
+#define DIV85_MAGIC_16 49345U
+
+#define Z85_ENCODE_PAIRS_SIZE (85 * 85 * 2)
+#define Z85_DECODE_PAIRS_SIZE (256 * 256)
+
+// Tables of an alphabet:
+//   base85 maps digits to symbols, it's padded with zeros up to 96 bytes,
+//   so it can be loaded as six 16-byte lookup tables;
+//   base256 maps symbols [32;128) to digits, symbols out of the alphabet are mapped to 0;
+//   pair tables are described in "Pair tables" section, they are built on demand.
+// Alphabet symbols are printable ASCII without space ('!' to '~'), so the kernels don't depend
+// on particular symbols, except the one of digit 0, which tells 0 from symbols out of the alphabet.
+struct Z85_alphabet_t
+{
+   char            base85[96];
+   byte            base256[96];
+   char*           encodePairs;
+   unsigned short* decodePairs;
+   int             pairTablesReady;
 };
 
-static byte base256[] =
-{
-   0x00, 0x44, 0x00, 0x54, 0x53, 0x52, 0x48, 0x00,
-   0x4B, 0x4C, 0x46, 0x41, 0x00, 0x3F, 0x3E, 0x45,
-   0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
-   0x08, 0x09, 0x40, 0x00, 0x49, 0x42, 0x4A, 0x47,
-   0x51, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A,
-   0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32,
-   0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A,
-   0x3B, 0x3C, 0x3D, 0x4D, 0x00, 0x4E, 0x43, 0x00,
-   0x00, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10,
-   0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18,
-   0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20,
-   0x21, 0x22, 0x23, 0x4F, 0x00, 0x50, 0x00, 0x00
+static char           z85EncodePairs[Z85_ENCODE_PAIRS_SIZE];
+static unsigned short z85DecodePairs[Z85_DECODE_PAIRS_SIZE];
+static char           rfc1924EncodePairs[Z85_ENCODE_PAIRS_SIZE];
+static unsigned short rfc1924DecodePairs[Z85_DECODE_PAIRS_SIZE];
+static char           ascii85EncodePairs[Z85_ENCODE_PAIRS_SIZE];
+static unsigned short ascii85DecodePairs[Z85_DECODE_PAIRS_SIZE];
+
+static Z85_alphabet_t z85Alphabet =
+{
+   {
+      "0123456789"
+      "abcdefghij"
+      "klmnopqrst"
+      "uvwxyzABCD"
+      "EFGHIJKLMN"
+      "OPQRSTUVWX"
+      "YZ.-:+=^!/"
+      "*?&<>()[]{"
+      "}@%$#"
+   },
+   {
+      0x00, 0x44, 0x00, 0x54, 0x53, 0x52, 0x48, 0x00,
+      0x4B, 0x4C, 0x46, 0x41, 0x00, 0x3F, 0x3E, 0x45,
+      0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+      0x08, 0x09, 0x40, 0x00, 0x49, 0x42, 0x4A, 0x47,
+      0x51, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A,
+      0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32,
+      0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A,
+      0x3B, 0x3C, 0x3D, 0x4D, 0x00, 0x4E, 0x43, 0x00,
+      0x00, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10,
+      0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18,
+      0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20,
+      0x21, 0x22, 0x23, 0x4F, 0x00, 0x50, 0x00, 0x00
+   },
+   z85EncodePairs,
+   z85DecodePairs,
+   0
 };
 
-char* Z85_encode_unsafe(const char* source, const char* sourceEnd, char* dest)
+// RFC 1924 alphabet, also used by git binary patches
+static Z85_alphabet_t rfc1924Alphabet =
+{
+   {
+      "0123456789"
+      "ABCDEFGHIJ"
+      "KLMNOPQRST"
+      "UVWXYZabcd"
+      "efghijklmn"
+      "opqrstuvwx"
+      "yz!#$%&()*"
+      "+-;<=>?@^_"
+      "`{|}~"
+   },
+   {
+      0x00, 0x3E, 0x00, 0x3F, 0x40, 0x41, 0x42, 0x00,
+      0x43, 0x44, 0x45, 0x46, 0x00, 0x47, 0x00, 0x00,
+      0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+      0x08, 0x09, 0x00, 0x48, 0x49, 0x4A, 0x4B, 0x4C,
+      0x4D, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10,
+      0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18,
+      0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20,
+      0x21, 0x22, 0x23, 0x00, 0x00, 0x00, 0x4E, 0x4F,
+      0x50, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A,
+      0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32,
+      0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A,
+      0x3B, 0x3C, 0x3D, 0x51, 0x52, 0x53, 0x54, 0x00
+   },
+   rfc1924EncodePairs,
+   rfc1924DecodePairs,
+   0
+};
+
+// Ascii85 (btoa, PostScript, PDF) alphabet, digits are symbols from '!'
+static Z85_alphabet_t ascii85Alphabet =
+{
+   {
+      "!\"#$%&'()*"
+      "+,-./01234"
+      "56789:;<=>"
+      "?@ABCDEFGH"
+      "IJKLMNOPQR"
+      "STUVWXYZ[\\"
+      "]^_`abcdef"
+      "ghijklmnop"
+      "qrstu"
+   },
+   {
+      0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+      0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+      0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+      0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E,
+      0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26,
+      0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E,
+      0x2F, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36,
+      0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E,
+      0x3F, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46,
+      0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E,
+      0x4F, 0x50, 0x51, 0x52, 0x53, 0x54, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+   },
+   ascii85EncodePairs,
+   ascii85DecodePairs,
+   0
+};
+
+static char* Z85_encode_unsafe_scalar(const Z85_alphabet_t* alphabet, const char* source,
+                                      const char* sourceEnd, char* dest)
 {
    byte* src = (byte*)source;
    byte* end = (byte*)sourceEnd;
@@ -87,17 +266,44 @@ char* Z85_encode_unsafe(const char* source, const char* sourceEnd, char* dest)
       // unpack big-endian frame
       value = (src[0] << 24) | (src[1] << 16) | (src[2] << 8) | src[3];
 
-      value2 = DIV85(value); dst[4] = base85[value - value2 * 85]; value = value2;
-      value2 = DIV85(value); dst[3] = base85[value - value2 * 85]; value = value2;
-      value2 = DIV85(value); dst[2] = base85[value - value2 * 85]; value = value2;
-      value2 = DIV85(value); dst[1] = base85[value - value2 * 85];
-      dst[0] = base85[value2];
+      value2 = DIV85(value); dst[4] = alphabet->base85[value - value2 * 85]; value = value2;
+      value2 = DIV85(value); dst[3] = alphabet->base85[value - value2 * 85]; value = value2;
+      value2 = DIV85(value); dst[2] = alphabet->base85[value - value2 * 85]; value = value2;
+      value2 = DIV85(value); dst[1] = alphabet->base85[value - value2 * 85];
+      dst[0] = alphabet->base85[value2];
    }
 
    return (char*)dst;
 }
 
-char* Z85_decode_unsafe(const char* source, const char* sourceEnd, char* dest)
+// encodes a single frame, which is already unpacked
+static char* Z85_encode_frame(const Z85_alphabet_t* alphabet, uint32_t value, char* dest)
+{
+   byte*    dst = (byte*)dest;
+   uint32_t value2;
+
+   value2 = DIV85(value); dst[4] = alphabet->base85[value - value2 * 85]; value = value2;
+   value2 = DIV85(value); dst[3] = alphabet->base85[value - value2 * 85]; value = value2;
+   value2 = DIV85(value); dst[2] = alphabet->base85[value - value2 * 85]; value = value2;
+   value2 = DIV85(value); dst[1] = alphabet->base85[value - value2 * 85];
+   dst[0] = alphabet->base85[value2];
+
+   return dest + 5;
+}
+
+// encodes 'count' unpacked frames 'values' to 'dests', frames may come from different messages
+static void Z85_encode_frames_scalar(const uint32_t* values, char* const* dests, size_t count)
+{
+   size_t i;
+
+   for (i = 0; i < count; ++i)
+   {
+      Z85_encode_frame(&z85Alphabet, values[i], dests[i]);
+   }
+}
+
+static char* Z85_decode_unsafe_scalar(const Z85_alphabet_t* alphabet, const char* source,
+                                      const char* sourceEnd, char* dest)
 {
    byte* src = (byte*)source;
    byte* end = (byte*)sourceEnd;
@@ -106,11 +312,11 @@ char* Z85_decode_unsafe(const char* source, const char* sourceEnd, char* dest)
 
    for (; src != end; src += 5, dst += 4)
    {
-      value =              base256[(src[0] - 32) & 127];
-      value = value * 85 + base256[(src[1] - 32) & 127];
-      value = value * 85 + base256[(src[2] - 32) & 127];
-      value = value * 85 + base256[(src[3] - 32) & 127];
-      value = value * 85 + base256[(src[4] - 32) & 127];
+      value =              alphabet->base256[(src[0] - 32) & 127];
+      value = value * 85 + alphabet->base256[(src[1] - 32) & 127];
+      value = value * 85 + alphabet->base256[(src[2] - 32) & 127];
+      value = value * 85 + alphabet->base256[(src[3] - 32) & 127];
+      value = value * 85 + alphabet->base256[(src[4] - 32) & 127];
 
       // pack big-endian frame
       dst[0] = value >> 24;
@@ -122,127 +328,3998 @@ char* Z85_decode_unsafe(const char* source, const char* sourceEnd, char* dest)
    return (char*)dst;
 }
 
-size_t Z85_encode_bound(size_t size)
+// returns digit of 'symbol' or -1 if 'symbol' isn't from the alphabet
+static int Z85_digit(const Z85_alphabet_t* alphabet, byte symbol)
 {
-   return size * 5 / 4;
+   byte digit;
+
+   if (symbol < 33 || symbol > 126)
+   {
+      return -1;
+   }
+
+   digit = alphabet->base256[symbol - 32];
+   return (digit || symbol == (byte)alphabet->base85[0]) ? digit : -1;
 }
 
-size_t Z85_decode_bound(size_t size)
+// Decodes symbols from [source;sourceEnd) range into 'dest' until the first invalid symbol
+// or the first frame exceeding 2^32 - 1. Returns a pointer to the invalid symbol,
+// to the beginning of the invalid frame or 'sourceEnd' if everything is decoded.
+static const char* Z85_decode_checked_scalar(const Z85_alphabet_t* alphabet, const char* source,
+                                             const char* sourceEnd, char* dest)
 {
-   return size * 4 / 5;
+   byte*    src = (byte*)source;
+   byte*    end = (byte*)sourceEnd;
+   byte*    dst = (byte*)dest;
+   uint32_t value;
+   int      digit;
+   int      i;
+
+   for (; src != end; src += 5, dst += 4)
+   {
+      value = 0;
+      for (i = 0; i < 4; ++i)
+      {
+         digit = Z85_digit(alphabet, src[i]);
+         if (digit < 0) return (const char*)src + i;
+         value = value * 85 + digit;
+      }
+
+      digit = Z85_digit(alphabet, src[4]);
+      if (digit < 0) return (const char*)src + 4;
+
+      // 0xFFFFFFFF is divisible by 85 with no remainder
+      if (value > 0xFFFFFFFFU / 85 || (value == 0xFFFFFFFFU / 85 && digit > 0)) return (const char*)src;
+      value = value * 85 + digit;
+
+      // pack big-endian frame
+      dst[0] = value >> 24;
+      dst[1] = (byte)(value >> 16);
+      dst[2] = (byte)(value >> 8);
+      dst[3] = (byte)(value);
+   }
+
+   return (const char*)end;
 }
 
-size_t Z85_encode(const char* source, char* dest, size_t inputSize)
+/*******************************************************************************
+ * Word-at-a-time kernels                                                      *
+ *******************************************************************************/
+
+// Handle two frames per iteration: 8 bytes are loaded as one big-endian 64-bit word
+// and both frames are transcoded side by side, so their multiply chains overlap
+// on CPUs, which don't reorder instructions themselves. Byte shifts below are
+// recognized by compilers as wide loads/stores with a byte swap.
+typedef unsigned long long Z85_uint64_t;
+
+static Z85_uint64_t Z85_load_be64(const byte* src)
 {
-   if (!source || !dest || inputSize % 4)
+   return ((Z85_uint64_t)src[0] << 56) | ((Z85_uint64_t)src[1] << 48) |
+          ((Z85_uint64_t)src[2] << 40) | ((Z85_uint64_t)src[3] << 32) |
+          ((Z85_uint64_t)src[4] << 24) | ((Z85_uint64_t)src[5] << 16) |
+          ((Z85_uint64_t)src[6] << 8)  |  (Z85_uint64_t)src[7];
+}
+
+static void Z85_store_be64(byte* dst, Z85_uint64_t value)
+{
+   dst[0] = (byte)(value >> 56);
+   dst[1] = (byte)(value >> 48);
+   dst[2] = (byte)(value >> 40);
+   dst[3] = (byte)(value >> 32);
+   dst[4] = (byte)(value >> 24);
+   dst[5] = (byte)(value >> 16);
+   dst[6] = (byte)(value >> 8);
+   dst[7] = (byte)(value);
+}
+
+// shift of byte 'i' of a 'bits' wide word stored with memcpy()
+#if defined (__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+   #define Z85_BYTE_SHIFT(i, bits) ((bits) - 8 - 8 * (i))
+#else
+   #define Z85_BYTE_SHIFT(i, bits) (8 * (i))
+#endif
+
+// symbol of 'digit' at position 'i' of the 10 symbols: 0-7 go to a 64-bit word, 8-9 to a 16-bit one
+#define Z85_SYMBOL64(digit, i) ((Z85_uint64_t)(byte)alphabet->base85[digit] << Z85_BYTE_SHIFT(i, 64))
+#define Z85_SYMBOL16(digit, i) ((uint32_t)(byte)alphabet->base85[digit] << Z85_BYTE_SHIFT((i) - 8, 16))
+
+// make sure the last two symbols are stored at once
+typedef char Z85_unsigned_short_static_assert[(sizeof(unsigned short) * CHAR_BIT == 16) * 2 - 1];
+
+static char* Z85_encode_unsafe_word64(const Z85_alphabet_t* alphabet, const char* source,
+                                      const char* sourceEnd, char* dest)
+{
+   byte* src = (byte*)source;
+   byte* end = (byte*)sourceEnd;
+   byte* dst = (byte*)dest;
+   Z85_uint64_t word;
+   Z85_uint64_t head; // symbols 0-7
+   uint32_t tail;     // symbols 8-9
+   unsigned short tail16;
+   uint32_t a, a2;
+   uint32_t b, b2;
+
+   for (; end - src >= 8; src += 8, dst += 10)
    {
-      assert(!"wrong source, destination or input size");
-      return 0;
+      word = Z85_load_be64(src);
+      a = (uint32_t)(word >> 32);
+      b = (uint32_t)word;
+
+      // symbols are gathered in registers, so both parts are written with a single store
+      a2 = DIV85(a); b2 = DIV85(b); head  = Z85_SYMBOL64(a - a2 * 85, 4); tail  = Z85_SYMBOL16(b - b2 * 85, 9); a = a2; b = b2;
+      a2 = DIV85(a); b2 = DIV85(b); head |= Z85_SYMBOL64(a - a2 * 85, 3); tail |= Z85_SYMBOL16(b - b2 * 85, 8); a = a2; b = b2;
+      a2 = DIV85(a); b2 = DIV85(b); head |= Z85_SYMBOL64(a - a2 * 85, 2) | Z85_SYMBOL64(b - b2 * 85, 7);         a = a2; b = b2;
+      a2 = DIV85(a); b2 = DIV85(b); head |= Z85_SYMBOL64(a - a2 * 85, 1) | Z85_SYMBOL64(b - b2 * 85, 6);
+      head |= Z85_SYMBOL64(a2, 0) | Z85_SYMBOL64(b2, 5);
+
+      tail16 = (unsigned short)tail;
+      memcpy(dst, &head, 8);
+      memcpy(dst + 8, &tail16, 2);
    }
 
-   return Z85_encode_unsafe(source, source + inputSize, dest) - dest;
+   return Z85_encode_unsafe_scalar(alphabet, (const char*)src, sourceEnd, (char*)dst); // odd frame, if any
 }
 
-size_t Z85_decode(const char* source, char* dest, size_t inputSize)
+// 'alphabet' is taken from the calling kernel
+#define Z85_DIGIT(symbol) ((uint32_t)alphabet->base256[((symbol) - 32) & 127])
+
+// 85^3
+#define Z85_POW85_3 614125U
+
+static char* Z85_decode_unsafe_word64(const Z85_alphabet_t* alphabet, const char* source,
+                                      const char* sourceEnd, char* dest)
 {
-   if (!source || !dest || inputSize % 5)
+   byte* src = (byte*)source;
+   byte* end = (byte*)sourceEnd;
+   byte* dst = (byte*)dest;
+   uint32_t a;
+   uint32_t b;
+
+   for (; end - src >= 10; src += 10, dst += 8)
    {
-      assert(!"wrong source, destination or input size");
-      return 0;
+      // Horner's rule split into independent halves: (d0 * 85 + d1) * 85^3 + (d2 * 85 + d3) * 85 + d4
+      a = (Z85_DIGIT(src[0]) * 85 + Z85_DIGIT(src[1])) * Z85_POW85_3 +
+          (Z85_DIGIT(src[2]) * 85 + Z85_DIGIT(src[3])) * 85 + Z85_DIGIT(src[4]);
+      b = (Z85_DIGIT(src[5]) * 85 + Z85_DIGIT(src[6])) * Z85_POW85_3 +
+          (Z85_DIGIT(src[7]) * 85 + Z85_DIGIT(src[8])) * 85 + Z85_DIGIT(src[9]);
+
+      Z85_store_be64(dst, ((Z85_uint64_t)a << 32) | b);
    }
 
-   return Z85_decode_unsafe(source, source + inputSize, dest) - dest;
+   return Z85_decode_unsafe_scalar(alphabet, (const char*)src, sourceEnd, (char*)dst); // odd frame, if any
 }
 
-size_t Z85_encode_with_padding_bound(size_t size)
+/*******************************************************************************
+ * Pair tables                                                                 *
+ *******************************************************************************/
+
+// Table driven kernels, which handle two symbols per lookup:
+//   encodePairs[i] holds symbols of digits i / 85 and i % 85 (i < 85 * 85),
+//   decodePairs[(a << 8) | b] holds 85 * digit(a) + digit(b) or Z85_INVALID_PAIR.
+// The decoding table covers any pair of bytes, so any input is safe to look up,
+// but only rows of the alphabet symbols (85 * 94 entries) are touched by valid input.
+#define Z85_INVALID_PAIR 0xFFFFU
+#define Z85_DECODE_PAIRS_TOUCHED_SIZE (85 * 94 * sizeof(unsigned short))
+
+static void Z85_init_alphabet_pairs(Z85_alphabet_t* alphabet)
 {
-   if (size == 0) return 0;
-   size = Z85_encode_bound(size);
-   return size + (5 - size % 5) % 5 + 1;
+   size_t i;
+
+   if (alphabet->pairTablesReady)
+   {
+      return;
+   }
+
+   for (i = 0; i < Z85_DECODE_PAIRS_SIZE; ++i)
+   {
+      alphabet->decodePairs[i] = Z85_INVALID_PAIR;
+   }
+
+   for (i = 0; i < 85 * 85; ++i)
+   {
+      alphabet->encodePairs[i * 2]     = alphabet->base85[i / 85];
+      alphabet->encodePairs[i * 2 + 1] = alphabet->base85[i % 85];
+      alphabet->decodePairs[((byte)alphabet->base85[i / 85] << 8) | (byte)alphabet->base85[i % 85]] = (unsigned short)i;
+   }
+
+   alphabet->pairTablesReady = 1;
 }
 
-size_t Z85_decode_with_padding_bound(const char* source, size_t size)
+// tables of custom alphabets are built by Z85_alphabet_create()
+static void Z85_init_pair_tables(void)
 {
-   if (size == 0 || !source || (byte)(source[0] - '0' - 1) > 3) return 0;
-   return Z85_decode_bound(size - 1) - 4 + (source[0] - '0');
+   Z85_init_alphabet_pairs(&z85Alphabet);
+   Z85_init_alphabet_pairs(&rfc1924Alphabet);
+   Z85_init_alphabet_pairs(&ascii85Alphabet);
 }
 
-size_t Z85_encode_with_padding(const char* source, char* dest, size_t inputSize)
+static char* Z85_encode_unsafe_pairs(const Z85_alphabet_t* alphabet, const char* source,
+                                     const char* sourceEnd, char* dest)
 {
-   size_t      tailBytes  = inputSize % 4;
-   char        tailBuf[4] = { 0 };
-   char*       dst        = dest;
-   const char* end        = source + inputSize - tailBytes;
+   byte* src = (byte*)source;
+   byte* end = (byte*)sourceEnd;
+   byte* dst = (byte*)dest;
+   uint32_t value;
+   uint32_t value2;
+   uint32_t hi;
 
-   assert(source && dest);
+   for (; src != end; src += 4, dst += 5)
+   {
+      // unpack big-endian frame
+      value = (src[0] << 24) | (src[1] << 16) | (src[2] << 8) | src[3];
 
-   // zero length string is not padded
-   if (!source || !dest || inputSize == 0)
+      // value2 < 2^32 / 85, so DIV7225_MAGIC is exact
+      value2 = DIV85(value);
+      hi = (uint32_t)((value2 * DIV7225_MAGIC) >> 44);
+
+      memcpy(dst,     alphabet->encodePairs + hi * 2,                   2);
+      memcpy(dst + 2, alphabet->encodePairs + (value2 - hi * 7225) * 2, 2);
+      dst[4] = alphabet->base85[value - value2 * 85];
+   }
+
+   return (char*)dst;
+}
+
+static char* Z85_decode_unsafe_pairs(const Z85_alphabet_t* alphabet, const char* source,
+                                     const char* sourceEnd, char* dest)
+{
+   byte* src = (byte*)source;
+   byte* end = (byte*)sourceEnd;
+   byte* dst = (byte*)dest;
+   uint32_t value;
+
+   for (; src != end; src += 5, dst += 4)
    {
-      return 0;
+      value = alphabet->decodePairs[(src[0] << 8) | src[1]] * 7225U + alphabet->decodePairs[(src[2] << 8) | src[3]];
+      value = value * 85 + alphabet->base256[(src[4] - 32) & 127];
+
+      // pack big-endian frame
+      dst[0] = value >> 24;
+      dst[1] = (byte)(value >> 16);
+      dst[2] = (byte)(value >> 8);
+      dst[3] = (byte)(value);
    }
 
-   (dst++)[0] = (tailBytes == 0 ? '4' : '0' + (char)tailBytes); // write tail bytes count
-   dst = Z85_encode_unsafe(source, end, dst);                   // write body
+   return (char*)dst;
+}
 
-   // write tail
-   switch (tailBytes)
+static const char* Z85_decode_checked_pairs(const Z85_alphabet_t* alphabet, const char* source,
+                                            const char* sourceEnd, char* dest)
+{
+   byte*    src = (byte*)source;
+   byte*    end = (byte*)sourceEnd;
+   byte*    dst = (byte*)dest;
+   uint32_t hi;
+   uint32_t lo;
+   uint32_t value;
+   int      digit;
+
+   for (; src != end; src += 5, dst += 4)
    {
-   case 3:
-      tailBuf[2] = end[2];
-   case 2:
-      tailBuf[1] = end[1];
-   case 1:
-      tailBuf[0] = end[0];
-      dst = Z85_encode_unsafe(tailBuf, tailBuf + 4, dst);
+      hi    = alphabet->decodePairs[(src[0] << 8) | src[1]];
+      lo    = alphabet->decodePairs[(src[2] << 8) | src[3]];
+      digit = Z85_digit(alphabet, src[4]);
+      value = hi * 7225 + lo;
+
+      // 0xFFFFFFFF is divisible by 85 with no remainder
+      if (hi == Z85_INVALID_PAIR || lo == Z85_INVALID_PAIR || digit < 0 ||
+          value > 0xFFFFFFFFU / 85 || (value == 0xFFFFFFFFU / 85 && digit > 0))
+      {
+         break;
+      }
+      value = value * 85 + digit;
+
+      // pack big-endian frame
+      dst[0] = value >> 24;
+      dst[1] = (byte)(value >> 16);
+      dst[2] = (byte)(value >> 8);
+      dst[3] = (byte)(value);
    }
 
-   return dst - dest;
+   return Z85_decode_checked_scalar(alphabet, (const char*)src, sourceEnd, (char*)dst); // pinpoints the error, if any
 }
 
-size_t Z85_decode_with_padding(const char* source, char* dest, size_t inputSize)
+#if defined (Z85_X86_SIMD)
+
+#define Z85_FORCE_INLINE __inline__ __attribute__((always_inline))
+#define Z85_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define Z85_TARGET_AVX2  __attribute__((target("avx2")))
+
+// divides each of eight 32-bit lanes by 85 (same magic multiply-shift as DIV85)
+Z85_TARGET_AVX2
+static __m256i Z85_div85_avx2(__m256i value)
 {
-   char*       dst        = dest;
-   size_t      tailBytes;
-   char        tailBuf[4] = { 0 };
-   const char* end        = source + inputSize;
+   const __m256i magic = _mm256_set1_epi64x((long long)DIV85_MAGIC);
+   const __m256i even  = _mm256_srli_epi64(_mm256_mul_epu32(value, magic), 38);
+   const __m256i odd   = _mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(value, 32), magic), 6);
 
-   assert(source && dest && (inputSize == 0 || (inputSize - 1) % 5 == 0));
+   return _mm256_blend_epi32(even, odd, 0xAA);
+}
 
-   // zero length string is not padded
-   if (!source || !dest || inputSize == 0 || (inputSize - 1) % 5)
+// divides each of eight 32-bit lanes by 85^2, lanes must be less than 2^32 / 85
+Z85_TARGET_AVX2
+static __m256i Z85_div7225_avx2(__m256i value)
+{
+   const __m256i magic = _mm256_set1_epi64x((long long)DIV7225_MAGIC);
+   const __m256i even  = _mm256_srli_epi64(_mm256_mul_epu32(value, magic), 44);
+   const __m256i odd   = _mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(value, 32), magic), 12);
+
+   return _mm256_blend_epi32(even, odd, 0xAA);
+}
+
+// maps digits [0;85) to Z85 alphabet, 'lut' holds base85 split into six 16-byte tables;
+// bits 4, 5 and 6 of each digit select the table through a tree of blends
+Z85_TARGET_AVX2
+static __m256i Z85_map_digits_avx2(__m256i digits, const __m256i* lut)
+{
+   const __m256i bit4 = _mm256_slli_epi16(digits, 3);
+   const __m256i bit5 = _mm256_slli_epi16(digits, 2);
+   const __m256i bit6 = _mm256_slli_epi16(digits, 1);
+
+   const __m256i t01 = _mm256_blendv_epi8(_mm256_shuffle_epi8(lut[0], digits), _mm256_shuffle_epi8(lut[1], digits), bit4);
+   const __m256i t23 = _mm256_blendv_epi8(_mm256_shuffle_epi8(lut[2], digits), _mm256_shuffle_epi8(lut[3], digits), bit4);
+   const __m256i t45 = _mm256_blendv_epi8(_mm256_shuffle_epi8(lut[4], digits), _mm256_shuffle_epi8(lut[5], digits), bit4);
+
+   return _mm256_blendv_epi8(_mm256_blendv_epi8(t01, t23, bit5), t45, bit6);
+}
+
+// encodes eight unpacked frames: 'head' gets 4 leading symbols of each frame, 'last' gets the last one
+// in the lowest byte of each lane
+Z85_TARGET_AVX2 Z85_FORCE_INLINE
+static void Z85_encode_values_avx2(__m256i value, const __m256i* lut, __m256i* head, __m256i* last)
+{
+   const __m256i c85          = _mm256_set1_epi32(85);
+   const __m256i c7225        = _mm256_set1_epi32(7225);
+   const __m256i c85x16       = _mm256_set1_epi16(85);
+   const __m256i div85Magic16 = _mm256_set1_epi16((short)DIV85_MAGIC_16);
+   __m256i       value2;
+   __m256i       value3;
+
+   // value = ((d0 * 85 + d1) * 7225 + (d2 * 85 + d3)) * 85 + d4
+   value2 = Z85_div85_avx2(value);
+   *last  = _mm256_sub_epi32(value, _mm256_mullo_epi32(value2, c85));
+   value3 = Z85_div7225_avx2(value2);
+   value2 = _mm256_sub_epi32(value2, _mm256_mullo_epi32(value3, c7225));
+
+   // both halves are less than 7225 now, so the last split is done in 16-bit lanes
+   value  = _mm256_or_si256(value2, _mm256_slli_epi32(value3, 16));         // [d2 * 85 + d3, d0 * 85 + d1]
+   value2 = _mm256_srli_epi16(_mm256_mulhi_epu16(value, div85Magic16), 6);  // [d2, d0]
+   value3 = _mm256_sub_epi16(value, _mm256_mullo_epi16(value2, c85x16));    // [d3, d1]
+
+   *head = _mm256_or_si256(
+      _mm256_or_si256(_mm256_srli_epi32(value2, 16), _mm256_slli_epi32(value2, 16)),
+      _mm256_or_si256(_mm256_slli_epi32(value3, 24), _mm256_and_si256(_mm256_srli_epi32(value3, 8), _mm256_set1_epi32(0xFF00))));
+
+   *head = Z85_map_digits_avx2(*head, lut);
+   *last = Z85_map_digits_avx2(*last, lut);
+}
+
+// encodes 8 frames (32 bytes into 40 symbols) per iteration, the tail is left to the scalar loop
+Z85_TARGET_AVX2
+static char* Z85_encode_unsafe_avx2(const Z85_alphabet_t* alphabet, const char* source,
+                                    const char* sourceEnd, char* dest)
+{
+   const char* src = source;
+   char*       dst = dest;
+   __m256i     lut[6];
+   int         i;
+
+   // big-endian frame unpacking
+   const __m256i bswap = _mm256_setr_epi8(
+      3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+      3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+   // interleaving of 4 leading symbols (from 'head') and the last symbol (from 'last') of each frame
+   const __m256i headBody = _mm256_setr_epi8(
+      0, 1, 2, 3, -1, 4, 5, 6, 7, -1, 8, 9, 10, 11, -1, 12,
+      0, 1, 2, 3, -1, 4, 5, 6, 7, -1, 8, 9, 10, 11, -1, 12);
+   const __m256i lastBody = _mm256_setr_epi8(
+      -1, -1, -1, -1, 0, -1, -1, -1, -1, 4, -1, -1, -1, -1, 8, -1,
+      -1, -1, -1, -1, 0, -1, -1, -1, -1, 4, -1, -1, -1, -1, 8, -1);
+   const __m256i headTail = _mm256_setr_epi8(
+      13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+   const __m256i lastTail = _mm256_setr_epi8(
+      -1, -1, -1, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+   for (i = 0; i < 6; ++i)
    {
-      return 0;
+      lut[i] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(alphabet->base85 + i * 16)));
    }
 
-   tailBytes = (source++)[0] - '0'; // possible values: 1, 2, 3 or 4
-   if (tailBytes - 1 > 3)
+   for (; sourceEnd - src >= 32; src += 32, dst += 40)
    {
-      assert(!"wrong tail bytes count");
-      return 0;
+      __m256i head;
+      __m256i last;
+      __m256i body;
+      __m256i tail;
+      int     tail0;
+      int     tail1;
+
+      Z85_encode_values_avx2(_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)src), bswap), lut, &head, &last);
+
+      body = _mm256_or_si256(_mm256_shuffle_epi8(head, headBody), _mm256_shuffle_epi8(last, lastBody));
+      tail = _mm256_or_si256(_mm256_shuffle_epi8(head, headTail), _mm256_shuffle_epi8(last, lastTail));
+
+      tail0 = _mm_cvtsi128_si32(_mm256_castsi256_si128(tail));
+      tail1 = _mm_cvtsi128_si32(_mm256_extracti128_si256(tail, 1));
+
+      _mm_storeu_si128((__m128i*)dst, _mm256_castsi256_si128(body));
+      memcpy(dst + 16, &tail0, 4);
+      _mm_storeu_si128((__m128i*)(dst + 20), _mm256_extracti128_si256(body, 1));
+      memcpy(dst + 36, &tail1, 4);
    }
 
-   end -= 5;
-   if (source != end)
+   _mm256_zeroupper(); // GCC doesn't clear upper halves before tail calls, legacy SSE code of the caller would stall
+   return Z85_encode_unsafe_scalar(alphabet, src, sourceEnd, dst);
+}
+
+// encodes 'count' unpacked frames 'values' to 'dests', 8 frames go to SIMD lanes at once
+Z85_TARGET_AVX2
+static void Z85_encode_frames_avx2(const uint32_t* values, char* const* dests, size_t count)
+{
+   __m256i  lut[6];
+   __m256i  head;
+   __m256i  last;
+   uint32_t heads[8];
+   uint32_t lasts[8];
+   int      i;
+
+   if (count != 8)
    {
-      // decode body
-      dst = Z85_decode_unsafe(source, end, dst);
+      Z85_encode_frames_scalar(values, dests, count);
+      return;
    }
 
-   // decode last 5 bytes chunk
-   Z85_decode_unsafe(end, end + 5, tailBuf);
+   for (i = 0; i < 6; ++i)
+   {
+      lut[i] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(z85Alphabet.base85 + i * 16)));
+   }
 
-   switch (tailBytes)
+   Z85_encode_values_avx2(_mm256_loadu_si256((const __m256i*)values), lut, &head, &last);
+
+   _mm256_storeu_si256((__m256i*)heads, head);
+   _mm256_storeu_si256((__m256i*)lasts, last);
+
+   for (i = 0; i < 8; ++i)
    {
-   case 4:
-      dst[3] = tailBuf[3];
-   case 3:
-      dst[2] = tailBuf[2];
-   case 2:
-      dst[1] = tailBuf[1];
-   case 1:
-      dst[0] = tailBuf[0];
+      memcpy(dests[i], &heads[i], 4);
+      dests[i][4] = (char)lasts[i];
+   }
+}
+
+// maps symbols to digits, 'lut' holds base256 split into six 16-byte tables (symbols [32;128));
+// bits 4, 5 and 6 of each symbol select the table through a tree of blends
+Z85_TARGET_SSE41
+static __m128i Z85_map_symbols_sse41(__m128i symbols, const __m128i* lut)
+{
+   const __m128i bit4 = _mm_slli_epi16(symbols, 3);
+   const __m128i bit5 = _mm_slli_epi16(symbols, 2);
+   const __m128i bit6 = _mm_slli_epi16(symbols, 1);
+
+   const __m128i t23 = _mm_blendv_epi8(_mm_shuffle_epi8(lut[0], symbols), _mm_shuffle_epi8(lut[1], symbols), bit4);
+   const __m128i t45 = _mm_blendv_epi8(_mm_shuffle_epi8(lut[2], symbols), _mm_shuffle_epi8(lut[3], symbols), bit4);
+   const __m128i t67 = _mm_blendv_epi8(_mm_shuffle_epi8(lut[4], symbols), _mm_shuffle_epi8(lut[5], symbols), bit4);
+
+   return _mm_blendv_epi8(t23, _mm_blendv_epi8(t45, t67, bit5), bit6);
+}
+
+// returns 0xFF for every symbol that isn't from the alphabet, 'digits' are mapped 'symbols',
+// 'zero' holds the symbol of digit 0 in every byte
+Z85_TARGET_SSE41
+static __m128i Z85_bad_symbols_sse41(__m128i symbols, __m128i digits, __m128i zero)
+{
+   const __m128i zeroDigits = _mm_andnot_si128(_mm_cmpeq_epi8(symbols, zero),
+                                               _mm_cmpeq_epi8(digits, _mm_setzero_si128()));
+
+   // signed comparison, so symbols above 127 are caught too
+   return _mm_or_si128(zeroDigits, _mm_cmpgt_epi8(_mm_set1_epi8(33), symbols));
+}
+
+// Decodes 4 frames (20 symbols into 16 bytes) per iteration, the tail is left to the caller.
+// If 'check' is set, stops at the first block with an invalid symbol or an overflowing frame.
+Z85_TARGET_SSE41 Z85_FORCE_INLINE
+static const char* Z85_decode_loop_sse41(const Z85_alphabet_t* alphabet, const char* source, const char* sourceEnd,
+                                         char** dest, int check)
+{
+   const char* src = source;
+   char*       dst = *dest;
+   __m128i     lut[6];
+   int         i;
+
+   // leading 4 symbols of frames 0-2 come from the first load, frame 3 is taken from the second one
+   const __m128i head0    = _mm_setr_epi8(0, 1, 2, 3, 5, 6, 7, 8, 10, 11, 12, 13, -1, -1, -1, -1);
+   const __m128i head1    = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 11, 12, 13, 14);
+   const __m128i last0    = _mm_setr_epi8(4, -1, -1, -1, 9, -1, -1, -1, 14, -1, -1, -1, -1, -1, -1, -1);
+   const __m128i last1    = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 15, -1, -1, -1);
+   const __m128i bswap    = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+   const __m128i w85      = _mm_setr_epi8(85, 1, 85, 1, 85, 1, 85, 1, 85, 1, 85, 1, 85, 1, 85, 1);
+   const __m128i w7225    = _mm_setr_epi16(7225, 1, 7225, 1, 7225, 1, 7225, 1);
+   const __m128i c85      = _mm_set1_epi32(85);
+   const __m128i lastMask = _mm_set1_epi32(0xFF);
+   const __m128i maxHead  = _mm_set1_epi32(0xFFFFFFFFU / 85);
+   const __m128i zero     = _mm_set1_epi8(alphabet->base85[0]);
+
+   for (i = 0; i < 6; ++i)
+   {
+      lut[i] = _mm_loadu_si128((const __m128i*)(alphabet->base256 + i * 16));
+   }
+
+   for (; sourceEnd - src >= 20; src += 20, dst += 16)
+   {
+      const __m128i in0 = _mm_loadu_si128((const __m128i*)src);
+      const __m128i in1 = _mm_loadu_si128((const __m128i*)(src + 4));
+      const __m128i symbolsHead = _mm_or_si128(_mm_shuffle_epi8(in0, head0), _mm_shuffle_epi8(in1, head1));
+      const __m128i symbolsLast = _mm_or_si128(_mm_shuffle_epi8(in0, last0), _mm_shuffle_epi8(in1, last1));
+      const __m128i digitsHead  = Z85_map_symbols_sse41(symbolsHead, lut);
+      const __m128i digitsLast  = Z85_map_symbols_sse41(symbolsLast, lut);
+
+      // (d0 * 85 + d1) * 7225 + (d2 * 85 + d3), then * 85 + d4
+      const __m128i head = _mm_madd_epi16(_mm_maddubs_epi16(digitsHead, w85), w7225);
+
+      if (check)
+      {
+         // 0xFFFFFFFF is divisible by 85 with no remainder
+         const __m128i overflow = _mm_or_si128(
+            _mm_cmpgt_epi32(head, maxHead),
+            _mm_and_si128(_mm_cmpeq_epi32(head, maxHead), _mm_cmpgt_epi32(digitsLast, _mm_setzero_si128())));
+         const __m128i bad = _mm_or_si128(
+            _mm_or_si128(Z85_bad_symbols_sse41(symbolsHead, digitsHead, zero),
+                         _mm_and_si128(Z85_bad_symbols_sse41(symbolsLast, digitsLast, zero), lastMask)),
+            overflow);
+
+         if (!_mm_testz_si128(bad, bad))
+         {
+            break;
+         }
+      }
+
+      _mm_storeu_si128((__m128i*)dst,
+                       _mm_shuffle_epi8(_mm_add_epi32(_mm_mullo_epi32(head, c85), digitsLast), bswap));
    }
 
-   return dst - dest + tailBytes;
+   *dest = dst;
+   return src;
 }
+
+Z85_TARGET_SSE41
+static char* Z85_decode_unsafe_sse41(const Z85_alphabet_t* alphabet, const char* source,
+                                     const char* sourceEnd, char* dest)
+{
+   const char* src = Z85_decode_loop_sse41(alphabet, source, sourceEnd, &dest, 0);
+   return Z85_decode_unsafe_scalar(alphabet, src, sourceEnd, dest);
+}
+
+Z85_TARGET_SSE41
+static const char* Z85_decode_checked_sse41(const Z85_alphabet_t* alphabet, const char* source,
+                                            const char* sourceEnd, char* dest)
+{
+   const char* src = Z85_decode_loop_sse41(alphabet, source, sourceEnd, &dest, 1);
+   return Z85_decode_checked_scalar(alphabet, src, sourceEnd, dest); // pinpoints the error, if any
+}
+
+// the same as Z85_map_symbols_sse41(), but for 32 symbols
+Z85_TARGET_AVX2
+static __m256i Z85_map_symbols_avx2(__m256i symbols, const __m256i* lut)
+{
+   const __m256i bit4 = _mm256_slli_epi16(symbols, 3);
+   const __m256i bit5 = _mm256_slli_epi16(symbols, 2);
+   const __m256i bit6 = _mm256_slli_epi16(symbols, 1);
+
+   const __m256i t23 = _mm256_blendv_epi8(_mm256_shuffle_epi8(lut[0], symbols), _mm256_shuffle_epi8(lut[1], symbols), bit4);
+   const __m256i t45 = _mm256_blendv_epi8(_mm256_shuffle_epi8(lut[2], symbols), _mm256_shuffle_epi8(lut[3], symbols), bit4);
+   const __m256i t67 = _mm256_blendv_epi8(_mm256_shuffle_epi8(lut[4], symbols), _mm256_shuffle_epi8(lut[5], symbols), bit4);
+
+   return _mm256_blendv_epi8(t23, _mm256_blendv_epi8(t45, t67, bit5), bit6);
+}
+
+// the same as Z85_bad_symbols_sse41(), but for 32 symbols
+Z85_TARGET_AVX2
+static __m256i Z85_bad_symbols_avx2(__m256i symbols, __m256i digits, __m256i zero)
+{
+   const __m256i zeroDigits = _mm256_andnot_si256(_mm256_cmpeq_epi8(symbols, zero),
+                                                  _mm256_cmpeq_epi8(digits, _mm256_setzero_si256()));
+
+   return _mm256_or_si256(zeroDigits, _mm256_cmpgt_epi8(_mm256_set1_epi8(33), symbols));
+}
+
+// Decodes 8 frames (40 symbols into 32 bytes) per iteration, the tail is left to the caller.
+// If 'check' is set, stops at the first block with an invalid symbol or an overflowing frame.
+Z85_TARGET_AVX2 Z85_FORCE_INLINE
+static const char* Z85_decode_loop_avx2(const Z85_alphabet_t* alphabet, const char* source, const char* sourceEnd,
+                                        char** dest, int check)
+{
+   const char* src = source;
+   char*       dst = *dest;
+   __m256i     lut[6];
+   int         i;
+
+   // each 128-bit lane gets 4 frames: leading 4 symbols of frames 0-2 come from the first load,
+   // frame 3 is taken from the second one
+   const __m256i head0 = _mm256_setr_epi8(
+      0, 1, 2, 3, 5, 6, 7, 8, 10, 11, 12, 13, -1, -1, -1, -1,
+      0, 1, 2, 3, 5, 6, 7, 8, 10, 11, 12, 13, -1, -1, -1, -1);
+   const __m256i head1 = _mm256_setr_epi8(
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 11, 12, 13, 14,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 11, 12, 13, 14);
+   const __m256i last0 = _mm256_setr_epi8(
+      4, -1, -1, -1, 9, -1, -1, -1, 14, -1, -1, -1, -1, -1, -1, -1,
+      4, -1, -1, -1, 9, -1, -1, -1, 14, -1, -1, -1, -1, -1, -1, -1);
+   const __m256i last1 = _mm256_setr_epi8(
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 15, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 15, -1, -1, -1);
+   const __m256i bswap = _mm256_setr_epi8(
+      3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+      3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+   const __m256i w85      = _mm256_set1_epi16(0x0155);   // 85, 1 byte pairs
+   const __m256i w7225    = _mm256_set1_epi32(0x00011C39); // 7225, 1 word pairs
+   const __m256i c85      = _mm256_set1_epi32(85);
+   const __m256i lastMask = _mm256_set1_epi32(0xFF);
+   const __m256i maxHead  = _mm256_set1_epi32(0xFFFFFFFFU / 85);
+   const __m256i zero     = _mm256_set1_epi8(alphabet->base85[0]);
+
+   for (i = 0; i < 6; ++i)
+   {
+      lut[i] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(alphabet->base256 + i * 16)));
+   }
+
+   for (; sourceEnd - src >= 40; src += 40, dst += 32)
+   {
+      const __m256i in0 = _mm256_inserti128_si256(
+         _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)src)), _mm_loadu_si128((const __m128i*)(src + 20)), 1);
+      const __m256i in1 = _mm256_inserti128_si256(
+         _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(src + 4))), _mm_loadu_si128((const __m128i*)(src + 24)), 1);
+      const __m256i symbolsHead = _mm256_or_si256(_mm256_shuffle_epi8(in0, head0), _mm256_shuffle_epi8(in1, head1));
+      const __m256i symbolsLast = _mm256_or_si256(_mm256_shuffle_epi8(in0, last0), _mm256_shuffle_epi8(in1, last1));
+      const __m256i digitsHead  = Z85_map_symbols_avx2(symbolsHead, lut);
+      const __m256i digitsLast  = Z85_map_symbols_avx2(symbolsLast, lut);
+
+      // (d0 * 85 + d1) * 7225 + (d2 * 85 + d3), then * 85 + d4
+      const __m256i head = _mm256_madd_epi16(_mm256_maddubs_epi16(digitsHead, w85), w7225);
+
+      if (check)
+      {
+         // 0xFFFFFFFF is divisible by 85 with no remainder
+         const __m256i overflow = _mm256_or_si256(
+            _mm256_cmpgt_epi32(head, maxHead),
+            _mm256_and_si256(_mm256_cmpeq_epi32(head, maxHead), _mm256_cmpgt_epi32(digitsLast, _mm256_setzero_si256())));
+         const __m256i bad = _mm256_or_si256(
+            _mm256_or_si256(Z85_bad_symbols_avx2(symbolsHead, digitsHead, zero),
+                            _mm256_and_si256(Z85_bad_symbols_avx2(symbolsLast, digitsLast, zero), lastMask)),
+            overflow);
+
+         if (!_mm256_testz_si256(bad, bad))
+         {
+            break;
+         }
+      }
+
+      _mm256_storeu_si256((__m256i*)dst,
+                          _mm256_shuffle_epi8(_mm256_add_epi32(_mm256_mullo_epi32(head, c85), digitsLast), bswap));
+   }
+
+   *dest = dst;
+   return src;
+}
+
+Z85_TARGET_AVX2
+static char* Z85_decode_unsafe_avx2(const Z85_alphabet_t* alphabet, const char* source,
+                                    const char* sourceEnd, char* dest)
+{
+   const char* src = Z85_decode_loop_avx2(alphabet, source, sourceEnd, &dest, 0);
+   _mm256_zeroupper();
+   return Z85_decode_unsafe_scalar(alphabet, src, sourceEnd, dest);
+}
+
+Z85_TARGET_AVX2
+static const char* Z85_decode_checked_avx2(const Z85_alphabet_t* alphabet, const char* source,
+                                           const char* sourceEnd, char* dest)
+{
+   const char* src = Z85_decode_loop_avx2(alphabet, source, sourceEnd, &dest, 1);
+   _mm256_zeroupper();
+   return Z85_decode_checked_scalar(alphabet, src, sourceEnd, dest); // pinpoints the error, if any
+}
+
+#endif // Z85_X86_SIMD
+
+/*******************************************************************************
+ * Whitespace skipping kernels                                                 *
+ *******************************************************************************/
+
+// none of ASCII whitespace symbols is in Z85 alphabet, 'c' is evaluated twice
+#define Z85_IS_SPACE(c) ((c) == ' ' || (byte)((c) - '\t') <= '\r' - '\t')
+
+// copies symbols, which aren't whitespace, returns the end of output
+static char* Z85_compact_scalar(const char* source, const char* sourceEnd, char* dest)
+{
+   Z85_uint64_t word;
+   const char*  end;
+
+   for (; source != sourceEnd; )
+   {
+      // Z85 alphabet starts from '!', so words without smaller (or non-ASCII) bytes are copied as is
+      if (sourceEnd - source >= 8)
+      {
+         memcpy(&word, source, 8);
+         if ((((word - 0x2121212121212121ULL) | word) & 0x8080808080808080ULL) == 0)
+         {
+            memcpy(dest, source, 8);
+            source += 8;
+            dest   += 8;
+            continue;
+         }
+      }
+
+      for (end = sourceEnd - source >= 8 ? source + 8 : sourceEnd; source != end; ++source)
+      {
+         *dest = *source;
+         dest += !Z85_IS_SPACE(*source);
+      }
+   }
+
+   return dest;
+}
+
+#if defined (Z85_X86_SIMD)
+
+// indexed by a mask of whitespace among 8 symbols: pshufb indices, which move the rest to the front,
+// and the number of them. Built by the init hook of the SIMD backends, before their kernels are published.
+static byte compactShuffle[256][8];
+static byte compactCount[256];
+static int  compactTablesReady = 0;
+
+static void Z85_init_compact_tables(void)
+{
+   size_t mask;
+   size_t i;
+   byte   count;
+
+   if (compactTablesReady)
+   {
+      return;
+   }
+
+   for (mask = 0; mask < 256; ++mask)
+   {
+      count = 0;
+      for (i = 0; i < 8; ++i)
+      {
+         if (!(mask & (1 << i)))
+         {
+            compactShuffle[mask][count++] = (byte)i;
+         }
+      }
+
+      for (i = count; i < 8; ++i)
+      {
+         compactShuffle[mask][i] = 0x80; // zero
+      }
+
+      compactCount[mask] = count;
+   }
+
+   compactTablesReady = 1;
+}
+
+// returns 0xFF for every whitespace symbol
+Z85_TARGET_SSE41
+static __m128i Z85_spaces_sse41(__m128i symbols)
+{
+   const __m128i controls = _mm_sub_epi8(symbols, _mm_set1_epi8('\t')); // '\t'-'\r' go to [0;4]
+
+   return _mm_or_si128(_mm_cmpeq_epi8(symbols, _mm_set1_epi8(' ')),
+                       _mm_cmpeq_epi8(_mm_min_epu8(controls, _mm_set1_epi8('\r' - '\t')), controls));
+}
+
+// packs 16 symbols dropping those marked in 'mask', writes 16 bytes at most
+Z85_TARGET_SSE41 Z85_FORCE_INLINE
+static char* Z85_compact16_sse41(__m128i symbols, unsigned mask, char* dst)
+{
+   const unsigned lo = mask & 0xFF;
+   const unsigned hi = mask >> 8;
+
+   _mm_storel_epi64((__m128i*)dst,
+                    _mm_shuffle_epi8(symbols, _mm_loadl_epi64((const __m128i*)compactShuffle[lo])));
+   dst += compactCount[lo];
+   _mm_storel_epi64((__m128i*)dst,
+                    _mm_shuffle_epi8(_mm_srli_si128(symbols, 8), _mm_loadl_epi64((const __m128i*)compactShuffle[hi])));
+
+   return dst + compactCount[hi];
+}
+
+// blocks without whitespace are copied as is, a single run of it (line break) is dropped
+// by an overlapping store of the following symbols, the rest is packed 8 symbols at once
+Z85_TARGET_SSE41
+static char* Z85_compact_sse41(const char* source, const char* sourceEnd, char* dest)
+{
+   for (; sourceEnd - source >= 16; source += 16)
+   {
+      const __m128i  symbols = _mm_loadu_si128((const __m128i*)source);
+      const unsigned mask    = (unsigned)_mm_movemask_epi8(Z85_spaces_sse41(symbols));
+      const unsigned skip    = mask ? (unsigned)__builtin_ctz(mask) : 0;
+      const unsigned run     = mask >> skip;
+
+      if (mask == 0)
+      {
+         _mm_storeu_si128((__m128i*)dest, symbols);
+         dest += 16;
+      }
+      else if ((run & (run + 1)) == 0 && sourceEnd - source >= 32)
+      {
+         _mm_storeu_si128((__m128i*)dest, symbols);
+         _mm_storeu_si128((__m128i*)(dest + skip),
+                          _mm_loadu_si128((const __m128i*)(source + skip + __builtin_ctz(run + 1))));
+         dest += 16 - __builtin_ctz(run + 1);
+      }
+      else
+      {
+         dest = Z85_compact16_sse41(symbols, mask, dest);
+      }
+   }
+
+   return Z85_compact_scalar(source, sourceEnd, dest);
+}
+
+Z85_TARGET_AVX2
+static char* Z85_compact_avx2(const char* source, const char* sourceEnd, char* dest)
+{
+   for (; sourceEnd - source >= 32; source += 32)
+   {
+      const __m256i symbols  = _mm256_loadu_si256((const __m256i*)source);
+      const __m256i controls = _mm256_sub_epi8(symbols, _mm256_set1_epi8('\t'));
+      const __m256i spaces   = _mm256_or_si256(
+         _mm256_cmpeq_epi8(symbols, _mm256_set1_epi8(' ')),
+         _mm256_cmpeq_epi8(_mm256_min_epu8(controls, _mm256_set1_epi8('\r' - '\t')), controls));
+      const unsigned mask = (unsigned)_mm256_movemask_epi8(spaces);
+      const unsigned skip = mask ? (unsigned)__builtin_ctz(mask) : 0;
+      const unsigned run  = mask >> skip;
+
+      if (mask == 0)
+      {
+         _mm256_storeu_si256((__m256i*)dest, symbols);
+         dest += 32;
+      }
+      else if ((run & (run + 1)) == 0 && sourceEnd - source >= 64)
+      {
+         _mm256_storeu_si256((__m256i*)dest, symbols);
+         _mm256_storeu_si256((__m256i*)(dest + skip),
+                             _mm256_loadu_si256((const __m256i*)(source + skip + __builtin_ctz(run + 1))));
+         dest += 32 - __builtin_ctz(run + 1);
+      }
+      else
+      {
+         dest = Z85_compact16_sse41(_mm256_castsi256_si128(symbols), mask & 0xFFFF, dest);
+         dest = Z85_compact16_sse41(_mm256_extracti128_si256(symbols, 1), mask >> 16, dest);
+      }
+   }
+
+   _mm256_zeroupper();
+   return Z85_compact_sse41(source, sourceEnd, dest);
+}
+
+#endif // Z85_X86_SIMD
+
+// kernels write up to this many bytes past the end of output
+#define Z85_COMPACT_SLACK 64
+
+/*******************************************************************************
+ * Large buffer mode                                                           *
+ *******************************************************************************/
+
+// input bytes transcoded into the scratch buffer at once, divisible by 4 and 5,
+// both 3840 bytes and 4800 symbols are whole cache lines
+#define Z85_STREAM_BLOCK     3840
+#define Z85_HUGE_PAGE_SIZE   (2 << 20)
+
+static size_t largeBufferThreshold = Z85_LARGE_BUFFER_OFF;
+
+size_t Z85_set_large_buffer_threshold(size_t size)
+{
+   const size_t previous = largeBufferThreshold;
+   largeBufferThreshold = size;
+   return previous;
+}
+
+// prefetches [source;source + size) into L2, which keeps L1 free for the scratch buffer
+static void Z85_prefetch(const char* source, size_t size)
+{
+#if defined (__GNUC__)
+   size_t i;
+
+   for (i = 0; i < size; i += 64)
+   {
+      __builtin_prefetch(source + i, 0, 1);
+   }
+#else
+   (void)source;
+   (void)size;
+#endif
+}
+
+#if defined (Z85_X86_SIMD)
+
+#define Z85_TARGET_SSE2 __attribute__((target("sse2")))
+
+// copies 'size' bytes to 'dest' with non-temporal stores, which don't bring 'dest' into cache
+Z85_TARGET_SSE2
+static void Z85_stream_copy(char* dest, const char* source, size_t size)
+{
+   size_t head = (16 - (size_t)dest % 16) % 16;
+
+   if (head > size)
+   {
+      head = size;
+   }
+
+   memcpy(dest, source, head);
+   dest   += head;
+   source += head;
+   size   -= head;
+
+   for (; size >= 64; size -= 64, source += 64, dest += 64)
+   {
+      const __m128i a = _mm_loadu_si128((const __m128i*)source);
+      const __m128i b = _mm_loadu_si128((const __m128i*)(source + 16));
+      const __m128i c = _mm_loadu_si128((const __m128i*)(source + 32));
+      const __m128i d = _mm_loadu_si128((const __m128i*)(source + 48));
+
+      _mm_stream_si128((__m128i*)dest, a);
+      _mm_stream_si128((__m128i*)(dest + 16), b);
+      _mm_stream_si128((__m128i*)(dest + 32), c);
+      _mm_stream_si128((__m128i*)(dest + 48), d);
+   }
+
+   memcpy(dest, source, size);
+}
+
+// orders non-temporal stores before whatever the caller does next
+Z85_TARGET_SSE2
+static void Z85_stream_fence(void)
+{
+   _mm_sfence();
+}
+
+#else
+
+static void Z85_stream_copy(char* dest, const char* source, size_t size)
+{
+   memcpy(dest, source, size);
+}
+
+static void Z85_stream_fence(void)
+{
+}
+
+#endif // Z85_X86_SIMD
+
+// Transcodes by blocks into a scratch buffer, which stays in L1 cache, and streams it out,
+// the next block of input is prefetched meanwhile. Encoding blocks (4800 symbols, 75 lines) and
+// decoding blocks (3072 bytes, 48 lines) are multiples of 64, so if 'dest' is aligned, every block
+// is written by whole lines of non-temporal stores.
+static char* Z85_transcode_streaming(char* (*kernel)(const Z85_alphabet_t*, const char*, const char*, char*),
+                                     const char* source, const char* sourceEnd, char* dest)
+{
+   char        buf[Z85_STREAM_BLOCK / 4 * 5];
+   const char* blockEnd;
+   size_t      size;
+
+   for (; source != sourceEnd; source = blockEnd)
+   {
+      blockEnd = (size_t)(sourceEnd - source) > Z85_STREAM_BLOCK ? source + Z85_STREAM_BLOCK : sourceEnd;
+      Z85_prefetch(blockEnd, (size_t)(sourceEnd - blockEnd) > Z85_STREAM_BLOCK ? Z85_STREAM_BLOCK
+                                                                               : (size_t)(sourceEnd - blockEnd));
+
+      size = kernel(&z85Alphabet, source, blockEnd, buf) - buf;
+      Z85_stream_copy(dest, buf, size);
+      dest += size;
+   }
+
+   Z85_stream_fence();
+   return dest;
+}
+
+void* Z85_large_buffer_alloc(size_t size)
+{
+#if defined (Z85_HUGE_PAGES)
+   const size_t rounded = (size + Z85_HUGE_PAGE_SIZE - 1) / Z85_HUGE_PAGE_SIZE * Z85_HUGE_PAGE_SIZE;
+   char*        mapping;
+   char*        aligned;
+
+   if (size == 0 || rounded < size)
+   {
+      return NULL;
+   }
+
+   // huge pages need 2 MiB alignment, which mmap() doesn't give, so the slack is unmapped
+   mapping = (char*)mmap(NULL, rounded + Z85_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+   if (mapping == MAP_FAILED)
+   {
+      return NULL;
+   }
+
+   aligned = mapping + (Z85_HUGE_PAGE_SIZE - (size_t)mapping % Z85_HUGE_PAGE_SIZE) % Z85_HUGE_PAGE_SIZE;
+   if (aligned != mapping)
+   {
+      munmap(mapping, aligned - mapping);
+   }
+   munmap(aligned + rounded, mapping + Z85_HUGE_PAGE_SIZE - aligned);
+
+#if defined (MADV_HUGEPAGE)
+   madvise(aligned, rounded, MADV_HUGEPAGE); // a hint, pages are still usable if it fails
+#endif
+
+   return aligned;
+#else
+   return size ? malloc(size) : NULL;
+#endif
+}
+
+void Z85_large_buffer_free(void* buffer, size_t size)
+{
+#if defined (Z85_HUGE_PAGES)
+   if (buffer)
+   {
+      munmap(buffer, (size + Z85_HUGE_PAGE_SIZE - 1) / Z85_HUGE_PAGE_SIZE * Z85_HUGE_PAGE_SIZE);
+   }
+#else
+   (void)size;
+   free(buffer);
+#endif
+}
+
+/*******************************************************************************
+ * CRC32C kernels                                                              *
+ *******************************************************************************/
+
+// Kernels take and return the raw register: the public functions invert it before and after
+#define Z85_CRC32C_POLY 0x82F63B78U // reflected Castagnoli polynomial
+
+typedef uint32_t (*Z85_crc32c_kernel)(uint32_t crc, const char* data, size_t size);
+
+// slicing-by-8: crc32cTables[k][i] is the register after 'i' is followed by 'k' zero bytes
+static uint32_t crc32cTables[8][256];
+static int      crc32cTablesReady = 0;
+
+static void Z85_init_crc32c_tables(void)
+{
+   uint32_t crc;
+   size_t   i, k;
+
+   if (crc32cTablesReady)
+   {
+      return;
+   }
+
+   for (i = 0; i < 256; ++i)
+   {
+      crc = (uint32_t)i;
+      for (k = 0; k < 8; ++k)
+      {
+         crc = (crc >> 1) ^ (Z85_CRC32C_POLY & (0U - (crc & 1)));
+      }
+      crc32cTables[0][i] = crc;
+   }
+
+   for (k = 1; k < 8; ++k)
+   {
+      for (i = 0; i < 256; ++i)
+      {
+         crc = crc32cTables[k - 1][i];
+         crc32cTables[k][i] = (crc >> 8) ^ crc32cTables[0][crc & 0xFF];
+      }
+   }
+
+   crc32cTablesReady = 1;
+}
+
+static uint32_t Z85_crc32c_tables(uint32_t crc, const char* data, size_t size)
+{
+   const byte* src = (const byte*)data;
+   const byte* end = src + size;
+
+   for (; end - src >= 8; src += 8)
+   {
+      crc ^= (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+      crc = crc32cTables[7][crc & 0xFF]         ^ crc32cTables[6][(crc >> 8) & 0xFF] ^
+            crc32cTables[5][(crc >> 16) & 0xFF] ^ crc32cTables[4][crc >> 24]         ^
+            crc32cTables[3][src[4]]             ^ crc32cTables[2][src[5]]            ^
+            crc32cTables[1][src[6]]             ^ crc32cTables[0][src[7]];
+   }
+
+   for (; src != end; ++src)
+   {
+      crc = (crc >> 8) ^ crc32cTables[0][(crc ^ *src) & 0xFF];
+   }
+
+   return crc;
+}
+
+#if defined (Z85_X86_SIMD)
+
+#define Z85_TARGET_SSE42 __attribute__((target("sse4.2")))
+
+// crc32 instruction takes 3 cycles, but a new one may start every cycle, so 64-bit builds run
+// three chains over adjacent lanes and join them: the register of a lane is followed by
+// Z85_CRC32C_LANE zero bytes (with crc32cShiftTables) and xor-ed with the next one
+#define Z85_CRC32C_LANE 256
+
+// crc32cShiftTables[k][i] is the register 'i << 8 * k' after Z85_CRC32C_LANE zero bytes
+static uint32_t crc32cShiftTables[4][256];
+static int      crc32cShiftTablesReady = 0;
+
+Z85_TARGET_SSE42
+static void Z85_init_crc32c_shift_tables(void)
+{
+   uint32_t bits[8];
+   uint32_t crc;
+   size_t   i, k, n;
+
+   if (crc32cShiftTablesReady)
+   {
+      return;
+   }
+
+   // the register is linear, so every entry is a sum of the entries of its bits
+   for (k = 0; k < 4; ++k)
+   {
+      for (i = 0; i < 8; ++i)
+      {
+         crc = 1U << (8 * k + i);
+         for (n = 0; n < Z85_CRC32C_LANE; n += 4)
+         {
+            crc = _mm_crc32_u32(crc, 0);
+         }
+         bits[i] = crc;
+      }
+
+      for (n = 0; n < 256; ++n)
+      {
+         crc = 0;
+         for (i = 0; i < 8; ++i)
+         {
+            crc ^= (n >> i & 1) ? bits[i] : 0;
+         }
+         crc32cShiftTables[k][n] = crc;
+      }
+   }
+
+   crc32cShiftTablesReady = 1;
+}
+
+static uint32_t Z85_crc32c_shift(uint32_t crc)
+{
+   return crc32cShiftTables[0][crc & 0xFF]         ^ crc32cShiftTables[1][(crc >> 8) & 0xFF] ^
+          crc32cShiftTables[2][(crc >> 16) & 0xFF] ^ crc32cShiftTables[3][crc >> 24];
+}
+
+Z85_TARGET_SSE42
+static uint32_t Z85_crc32c_sse42(uint32_t crc, const char* data, size_t size)
+{
+   const byte* src = (const byte*)data;
+   const byte* end = src + size;
+
+#if defined (__x86_64__)
+   const byte*  laneEnd;
+   Z85_uint64_t crc0 = crc;
+   Z85_uint64_t crc1;
+   Z85_uint64_t crc2;
+   Z85_uint64_t word0, word1, word2;
+
+   for (; end - src >= 3 * Z85_CRC32C_LANE; src += 2 * Z85_CRC32C_LANE)
+   {
+      crc1 = 0;
+      crc2 = 0;
+
+      // 'src' walks the first lane, the other two are at fixed offsets from it
+      for (laneEnd = src + Z85_CRC32C_LANE; src != laneEnd; src += 8)
+      {
+         memcpy(&word0, src, 8);
+         memcpy(&word1, src + Z85_CRC32C_LANE, 8);
+         memcpy(&word2, src + 2 * Z85_CRC32C_LANE, 8);
+         crc0 = _mm_crc32_u64(crc0, word0);
+         crc1 = _mm_crc32_u64(crc1, word1);
+         crc2 = _mm_crc32_u64(crc2, word2);
+      }
+
+      crc0 = Z85_crc32c_shift((uint32_t)crc0) ^ (uint32_t)crc1;
+      crc0 = Z85_crc32c_shift((uint32_t)crc0) ^ (uint32_t)crc2;
+   }
+
+   for (; end - src >= 8; src += 8)
+   {
+      memcpy(&word0, src, 8);
+      crc0 = _mm_crc32_u64(crc0, word0);
+   }
+   crc = (uint32_t)crc0;
+#endif
+
+   for (; src != end; ++src)
+   {
+      crc = _mm_crc32_u8(crc, *src);
+   }
+
+   return crc;
+}
+
+#endif // Z85_X86_SIMD
+
+/*******************************************************************************
+ * Backend dispatch                                                            *
+ *******************************************************************************/
+
+typedef char* (*Z85_kernel)(const char* source, const char* sourceEnd, char* dest);
+
+// transcodes symbols of 'alphabet'
+typedef char* (*Z85_alphabet_kernel)(const Z85_alphabet_t* alphabet, const char* source, const char* sourceEnd,
+                                     char* dest);
+
+// returns a pointer to the first invalid symbol (frame) or 'sourceEnd'
+typedef const char* (*Z85_checked_kernel)(const Z85_alphabet_t* alphabet, const char* source, const char* sourceEnd,
+                                          char* dest);
+
+// encodes unpacked frames scattered over several messages
+typedef void (*Z85_frames_kernel)(const uint32_t* values, char* const* dests, size_t count);
+
+typedef struct Z85_backend_kernels
+{
+   const char*         name;
+   Z85_alphabet_kernel encode;
+   Z85_alphabet_kernel decode;
+   Z85_checked_kernel  decodeChecked;
+   Z85_frames_kernel   encodeFrames;
+   Z85_kernel          compact;       // copies symbols skipping whitespace
+   void                (*init)(void); // prepares tables of the preset alphabets, may be NULL
+   size_t              tableSize;     // bytes of tables touched by the kernels
+} Z85_backend_kernels;
+
+#if defined (Z85_X86_SIMD)
+
+// SSE4.1 encodes with pair tables, both SIMD backends skip whitespace with compact tables
+static void Z85_init_sse41_tables(void)
+{
+   Z85_init_pair_tables();
+   Z85_init_compact_tables();
+}
+
+#endif
+
+#define Z85_BASE_TABLES_SIZE (sizeof(z85Alphabet.base85) + sizeof(z85Alphabet.base256))
+
+// indexed by Z85_backend, NULL kernels mean that the backend isn't compiled in
+static const Z85_backend_kernels backends[] =
+{
+   { "auto",   NULL,                     NULL,                     NULL,                      NULL,
+     NULL,                NULL,                 0                                                                          },
+   { "scalar", Z85_encode_unsafe_scalar, Z85_decode_unsafe_scalar, Z85_decode_checked_scalar, Z85_encode_frames_scalar,
+     Z85_compact_scalar,  NULL,                 Z85_BASE_TABLES_SIZE                                                       },
+#if defined (Z85_X86_SIMD)
+   { "sse4.1", Z85_encode_unsafe_pairs,  Z85_decode_unsafe_sse41,  Z85_decode_checked_sse41,  Z85_encode_frames_scalar,
+     Z85_compact_sse41,   Z85_init_sse41_tables, Z85_BASE_TABLES_SIZE + Z85_ENCODE_PAIRS_SIZE                              },
+   { "avx2",   Z85_encode_unsafe_avx2,   Z85_decode_unsafe_avx2,   Z85_decode_checked_avx2,   Z85_encode_frames_avx2,
+     Z85_compact_avx2,    Z85_init_compact_tables, Z85_BASE_TABLES_SIZE                                                    },
+#else
+   { "sse4.1", NULL,                     NULL,                     NULL,                      NULL,
+     NULL,                NULL,                 0                                                                          },
+   { "avx2",   NULL,                     NULL,                     NULL,                      NULL,
+     NULL,                NULL,                 0                                                                          },
+#endif
+   { "pairs",  Z85_encode_unsafe_pairs,  Z85_decode_unsafe_pairs,  Z85_decode_checked_pairs,  Z85_encode_frames_scalar,
+     Z85_compact_scalar,  Z85_init_pair_tables, Z85_BASE_TABLES_SIZE + Z85_ENCODE_PAIRS_SIZE + Z85_DECODE_PAIRS_TOUCHED_SIZE },
+   { "word64", Z85_encode_unsafe_word64, Z85_decode_unsafe_word64, Z85_decode_checked_scalar, Z85_encode_frames_scalar,
+     Z85_compact_scalar,  NULL,                 Z85_BASE_TABLES_SIZE                                                       }
+};
+
+#define Z85_BACKEND_COUNT (sizeof(backends) / sizeof(backends[0]))
+
+// the most preferable backend goes first
+static const Z85_backend preferredBackends[] =
+{
+   Z85_BACKEND_AVX2,
+   Z85_BACKEND_SSE41,
+   Z85_BACKEND_PAIRS,
+   Z85_BACKEND_WORD64,
+   Z85_BACKEND_SCALAR
+};
+
+static char* Z85_encode_unsafe_resolve(const Z85_alphabet_t* alphabet, const char* source, const char* sourceEnd,
+                                       char* dest);
+static char* Z85_decode_unsafe_resolve(const Z85_alphabet_t* alphabet, const char* source, const char* sourceEnd,
+                                       char* dest);
+static const char* Z85_decode_checked_resolve(const Z85_alphabet_t* alphabet, const char* source,
+                                              const char* sourceEnd, char* dest);
+static uint32_t Z85_crc32c_resolve(uint32_t crc, const char* data, size_t size);
+
+// kernels are resolved on the first call, unless Z85_set_backend() is called before
+static Z85_alphabet_kernel encodeKernel        = Z85_encode_unsafe_resolve;
+static Z85_alphabet_kernel decodeKernel        = Z85_decode_unsafe_resolve;
+static Z85_checked_kernel  decodeCheckedKernel = Z85_decode_checked_resolve;
+static Z85_crc32c_kernel   crc32cKernel        = Z85_crc32c_resolve;
+static Z85_backend         activeBackend       = Z85_BACKEND_AUTO;
+
+static int Z85_backend_supported(Z85_backend backend)
+{
+   if ((size_t)backend >= Z85_BACKEND_COUNT || !backends[backend].encode)
+   {
+      return 0;
+   }
+
+#if defined (Z85_X86_SIMD)
+   __builtin_cpu_init();
+
+   switch (backend)
+   {
+   case Z85_BACKEND_SSE41:
+      return __builtin_cpu_supports("sse4.1");
+   case Z85_BACKEND_AVX2:
+      return __builtin_cpu_supports("avx2");
+   default:
+      break;
+   }
+#endif
+
+   return 1;
+}
+
+// SIMD backends use crc32 instruction, portable ones use tables, so both are testable on any CPU
+static Z85_crc32c_kernel Z85_backend_crc32c(Z85_backend backend)
+{
+#if defined (Z85_X86_SIMD)
+   if ((backend == Z85_BACKEND_SSE41 || backend == Z85_BACKEND_AVX2) && __builtin_cpu_supports("sse4.2"))
+   {
+      Z85_init_crc32c_shift_tables();
+      return Z85_crc32c_sse42;
+   }
+#else
+   (void)backend;
+#endif
+
+   Z85_init_crc32c_tables();
+   return Z85_crc32c_tables;
+}
+
+static void Z85_set_default_backend(void)
+{
+   const char* name = getenv("Z85_BACKEND");
+
+   if (!name || !Z85_set_backend_by_name(name))
+   {
+      Z85_set_backend(Z85_BACKEND_AUTO);
+   }
+}
+
+#if defined (Z85_THREADS)
+static pthread_once_t defaultBackendOnce = PTHREAD_ONCE_INIT;
+#endif
+
+// The default backend is set once: before main() by the constructor below where the compiler
+// supports it, so no thread sees kernels, which tables are still being built, otherwise on
+// the first call under pthread_once. Only explicit Z85_set_backend() calls are unsynchronized.
+static void Z85_resolve_backend(void)
+{
+#if defined (Z85_THREADS)
+   pthread_once(&defaultBackendOnce, Z85_set_default_backend);
+#else
+   if (activeBackend == Z85_BACKEND_AUTO)
+   {
+      Z85_set_default_backend();
+   }
+#endif
+}
+
+#if defined (__GNUC__)
+__attribute__((constructor))
+static void Z85_resolve_backend_on_load(void)
+{
+   Z85_resolve_backend();
+}
+#endif
+
+static char* Z85_encode_unsafe_resolve(const Z85_alphabet_t* alphabet, const char* source, const char* sourceEnd,
+                                       char* dest)
+{
+   Z85_resolve_backend();
+   return encodeKernel(alphabet, source, sourceEnd, dest);
+}
+
+static char* Z85_decode_unsafe_resolve(const Z85_alphabet_t* alphabet, const char* source, const char* sourceEnd,
+                                       char* dest)
+{
+   Z85_resolve_backend();
+   return decodeKernel(alphabet, source, sourceEnd, dest);
+}
+
+static const char* Z85_decode_checked_resolve(const Z85_alphabet_t* alphabet, const char* source,
+                                              const char* sourceEnd, char* dest)
+{
+   Z85_resolve_backend();
+   return decodeCheckedKernel(alphabet, source, sourceEnd, dest);
+}
+
+static uint32_t Z85_crc32c_resolve(uint32_t crc, const char* data, size_t size)
+{
+   Z85_resolve_backend();
+   return crc32cKernel(crc, data, size);
+}
+
+int Z85_set_backend(Z85_backend backend)
+{
+   size_t i;
+
+   if (backend == Z85_BACKEND_AUTO)
+   {
+      for (i = 0; !Z85_backend_supported(preferredBackends[i]); ++i)
+      {
+      }
+      backend = preferredBackends[i];
+   }
+
+   if (!Z85_backend_supported(backend))
+   {
+      return 0;
+   }
+
+   if (backends[backend].init)
+   {
+      backends[backend].init();
+   }
+
+   encodeKernel        = backends[backend].encode;
+   decodeKernel        = backends[backend].decode;
+   decodeCheckedKernel = backends[backend].decodeChecked;
+   crc32cKernel        = Z85_backend_crc32c(backend);
+   activeBackend       = backend;
+
+   return 1;
+}
+
+int Z85_set_backend_by_name(const char* name)
+{
+   size_t i;
+
+   for (i = 0; name && i < Z85_BACKEND_COUNT; ++i)
+   {
+      if (!strcmp(name, backends[i].name))
+      {
+         return Z85_set_backend((Z85_backend)i);
+      }
+   }
+
+   return 0;
+}
+
+Z85_backend Z85_get_backend(void)
+{
+   if (activeBackend == Z85_BACKEND_AUTO)
+   {
+      Z85_resolve_backend();
+   }
+
+   return activeBackend;
+}
+
+const char* Z85_backend_name(Z85_backend backend)
+{
+   return (size_t)backend < Z85_BACKEND_COUNT ? backends[backend].name : NULL;
+}
+
+size_t Z85_backend_table_size(Z85_backend backend)
+{
+   if (backend == Z85_BACKEND_AUTO)
+   {
+      backend = Z85_get_backend();
+   }
+
+   return Z85_backend_supported(backend) ? backends[backend].tableSize : 0;
+}
+
+char* Z85_encode_unsafe(const char* source, const char* sourceEnd, char* dest)
+{
+   if ((size_t)(sourceEnd - source) >= largeBufferThreshold)
+   {
+      return Z85_transcode_streaming(encodeKernel, source, sourceEnd, dest);
+   }
+
+   return encodeKernel(&z85Alphabet, source, sourceEnd, dest);
+}
+
+char* Z85_decode_unsafe(const char* source, const char* sourceEnd, char* dest)
+{
+   if ((size_t)(sourceEnd - source) >= largeBufferThreshold)
+   {
+      return Z85_transcode_streaming(decodeKernel, source, sourceEnd, dest);
+   }
+
+   return decodeKernel(&z85Alphabet, source, sourceEnd, dest);
+}
+
+size_t Z85_encode_bound(size_t size)
+{
+   return size * 5 / 4;
+}
+
+size_t Z85_decode_bound(size_t size)
+{
+   return size * 4 / 5;
+}
+
+size_t Z85_encode(const char* source, char* dest, size_t inputSize)
+{
+   return Z85_encode_parallel(source, dest, inputSize, 1, 0);
+}
+
+size_t Z85_decode(const char* source, char* dest, size_t inputSize)
+{
+   return Z85_decode_parallel(source, dest, inputSize, 1, 0);
+}
+
+size_t Z85_encode_with_padding_bound(size_t size)
+{
+   if (size == 0) return 0;
+   size = Z85_encode_bound(size);
+   return size + (5 - size % 5) % 5 + 1;
+}
+
+size_t Z85_decode_with_padding_bound(const char* source, size_t size)
+{
+   if (size == 0 || !source || (byte)(source[0] - '0' - 1) > 3) return 0;
+   return Z85_decode_bound(size - 1) - 4 + (source[0] - '0');
+}
+
+static char* Z85_encode_tail(const Z85_alphabet_t* alphabet, const char* end, size_t tailBytes, char* dst);
+static char* Z85_decode_tail(const Z85_alphabet_t* alphabet, const char* end, size_t tailBytes, char* dst);
+
+// inputs shorter than this are encoded without going through the parallel machinery
+#define Z85_SMALL_INPUT_SIZE 64
+
+size_t Z85_encode_with_padding(const char* source, char* dest, size_t inputSize)
+{
+   size_t      tailBytes = inputSize % 4;
+   const char* end;
+   char*       dst       = dest;
+
+   if (inputSize >= Z85_SMALL_INPUT_SIZE || !source || !dest || inputSize == 0)
+   {
+      return Z85_encode_with_padding_parallel(source, dest, inputSize, 1, 0);
+   }
+
+   end = source + inputSize - tailBytes;
+   (dst++)[0] = (tailBytes == 0 ? '4' : '0' + (char)tailBytes); // write tail bytes count
+   dst = Z85_encode_unsafe(source, end, dst);                    // write body
+   dst = Z85_encode_tail(&z85Alphabet, end, tailBytes, dst);     // write tail
+
+   return dst - dest;
+}
+
+size_t Z85_decode_with_padding(const char* source, char* dest, size_t inputSize)
+{
+   return Z85_decode_with_padding_parallel(source, dest, inputSize, 1, 0);
+}
+
+size_t Z85_encode_with_trailing_padding_bound(size_t size)
+{
+   return Z85_encode_with_padding_bound(size);
+}
+
+size_t Z85_decode_with_trailing_padding_bound(const char* source, size_t size)
+{
+   if (size == 0 || !source || (byte)(source[size - 1] - '0' - 1) > 3) return 0;
+   return Z85_decode_bound(size - 1) - 4 + (source[size - 1] - '0');
+}
+
+size_t Z85_encode_with_trailing_padding(const char* source, char* dest, size_t inputSize)
+{
+   size_t      tailBytes = inputSize % 4;
+   char*       dst       = dest;
+   const char* end       = source + inputSize - tailBytes;
+
+   assert(source && dest);
+
+   // zero length string is not padded
+   if (!source || !dest || inputSize == 0)
+   {
+      return 0;
+   }
+
+   dst = Z85_encode_unsafe(source, end, dst);                   // write body
+   dst = Z85_encode_tail(&z85Alphabet, end, tailBytes, dst);    // write tail
+   (dst++)[0] = (tailBytes == 0 ? '4' : '0' + (char)tailBytes); // write tail bytes count
+
+   return dst - dest;
+}
+
+size_t Z85_decode_with_trailing_padding(const char* source, char* dest, size_t inputSize)
+{
+   char*       dst = dest;
+   size_t      tailBytes;
+   const char* end;
+
+   assert(source && dest && (inputSize == 0 || (inputSize - 1) % 5 == 0));
+
+   // zero length string is not padded
+   if (!source || !dest || inputSize == 0 || (inputSize - 1) % 5)
+   {
+      return 0;
+   }
+
+   tailBytes = source[inputSize - 1] - '0'; // possible values: 1, 2, 3 or 4
+   if (tailBytes - 1 > 3)
+   {
+      assert(!"wrong tail bytes count");
+      return 0;
+   }
+
+   end = source + inputSize - 6;
+   dst = Z85_decode_unsafe(source, end, dst);                // decode body
+   dst = Z85_decode_tail(&z85Alphabet, end, tailBytes, dst); // decode last 5 bytes chunk
+
+   return dst - dest;
+}
+
+
+
+/*******************************************************************************
+ * Checked decoding                                                            *
+ *******************************************************************************/
+
+#define Z85_VALIDATE_CHUNK 5120 // symbols
+
+static void Z85_set_error(size_t* errorPos, size_t pos)
+{
+   if (errorPos)
+   {
+      *errorPos = pos;
+   }
+}
+
+size_t Z85_decode_checked(const char* source, char* dest, size_t inputSize, size_t* errorPos)
+{
+   return Z85_alphabet_decode_checked(&z85Alphabet, source, dest, inputSize, errorPos);
+}
+
+size_t Z85_alphabet_decode_checked(const Z85_alphabet_t* alphabet, const char* source, char* dest,
+                                   size_t inputSize, size_t* errorPos)
+{
+   const char* pos;
+
+   assert(alphabet);
+   Z85_set_error(errorPos, Z85_NPOS);
+
+   if (!source || !dest)
+   {
+      Z85_set_error(errorPos, 0);
+      return 0;
+   }
+
+   if (inputSize % 5)
+   {
+      Z85_set_error(errorPos, inputSize);
+      return 0;
+   }
+
+   pos = decodeCheckedKernel(alphabet, source, source + inputSize, dest);
+   if (pos != source + inputSize)
+   {
+      Z85_set_error(errorPos, pos - source);
+      return 0;
+   }
+
+   return Z85_decode_bound(inputSize);
+}
+
+int Z85_validate(const char* source, size_t inputSize, size_t* errorPos)
+{
+   char        buf[Z85_VALIDATE_CHUNK / 5 * 4];
+   const char* src = source;
+   const char* end = source + inputSize;
+   const char* chunkEnd;
+   const char* pos;
+
+   Z85_set_error(errorPos, Z85_NPOS);
+
+   if (!source || inputSize % 5)
+   {
+      Z85_set_error(errorPos, source ? inputSize : 0);
+      return 0;
+   }
+
+   // decoding into a small buffer keeps the output in L1 cache
+   for (; src != end; src = chunkEnd)
+   {
+      chunkEnd = (size_t)(end - src) > Z85_VALIDATE_CHUNK ? src + Z85_VALIDATE_CHUNK : end;
+
+      pos = decodeCheckedKernel(&z85Alphabet, src, chunkEnd, buf);
+      if (pos != chunkEnd)
+      {
+         Z85_set_error(errorPos, pos - source);
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+// Checked decoding of padded symbols without the tail bytes count,
+// only 'tailBytes' leading bytes of the last frame are kept
+static size_t Z85_decode_checked_tail(const Z85_alphabet_t* alphabet, const char* source, char* dest,
+                                      size_t inputSize, size_t tailBytes, size_t* errorPos)
+{
+   char        tailBuf[4];
+   const char* end = source + inputSize - 5;
+   const char* pos = decodeCheckedKernel(alphabet, source, end, dest);
+
+   if (pos == end)
+   {
+      pos = decodeCheckedKernel(alphabet, end, end + 5, tailBuf);
+   }
+
+   if (pos != end + 5)
+   {
+      Z85_set_error(errorPos, pos - source);
+      return 0;
+   }
+
+   memcpy(dest + Z85_decode_bound(inputSize - 5), tailBuf, tailBytes);
+   return Z85_decode_bound(inputSize - 5) + tailBytes;
+}
+
+size_t Z85_decode_with_padding_checked(const char* source, char* dest, size_t inputSize, size_t* errorPos)
+{
+   return Z85_alphabet_decode_with_padding_checked(&z85Alphabet, source, dest, inputSize, errorPos);
+}
+
+size_t Z85_alphabet_decode_with_padding_checked(const Z85_alphabet_t* alphabet, const char* source, char* dest,
+                                                size_t inputSize, size_t* errorPos)
+{
+   size_t tailBytes;
+   size_t decoded;
+
+   assert(alphabet);
+   Z85_set_error(errorPos, Z85_NPOS);
+
+   if (!source || !dest || inputSize == 0 || (inputSize - 1) % 5)
+   {
+      Z85_set_error(errorPos, (source && dest) ? inputSize : 0);
+      return 0;
+   }
+
+   tailBytes = source[0] - '0'; // possible values: 1, 2, 3 or 4
+   if (tailBytes - 1 > 3)
+   {
+      Z85_set_error(errorPos, 0);
+      return 0;
+   }
+
+   decoded = Z85_decode_checked_tail(alphabet, source + 1, dest, inputSize - 1, tailBytes, errorPos);
+   if (decoded == 0 && errorPos)
+   {
+      ++*errorPos;
+   }
+
+   return decoded;
+}
+
+size_t Z85_decode_with_trailing_padding_checked(const char* source, char* dest, size_t inputSize, size_t* errorPos)
+{
+   size_t tailBytes;
+
+   Z85_set_error(errorPos, Z85_NPOS);
+
+   if (!source || !dest || inputSize == 0 || (inputSize - 1) % 5)
+   {
+      Z85_set_error(errorPos, (source && dest) ? inputSize : 0);
+      return 0;
+   }
+
+   tailBytes = source[inputSize - 1] - '0'; // possible values: 1, 2, 3 or 4
+   if (tailBytes - 1 > 3)
+   {
+      Z85_set_error(errorPos, inputSize - 1);
+      return 0;
+   }
+
+   return Z85_decode_checked_tail(&z85Alphabet, source, dest, inputSize - 1, tailBytes, errorPos);
+}
+
+
+
+/*******************************************************************************
+ * Line wrapping                                                               *
+ *******************************************************************************/
+
+#define Z85_WRAP_CHUNK 4000 // symbols encoded (decoded) at once, a multiple of 5
+
+// writes symbols breaking lines after every 'lineLength' of them, no line break at the end
+typedef struct Z85_line_writer
+{
+   char*  dst;
+   size_t column;
+   size_t lineLength; // 0 means no line breaks
+} Z85_line_writer;
+
+static void Z85_write_lines(Z85_line_writer* writer, const char* source, size_t size)
+{
+   size_t n;
+
+   if (writer->lineLength == 0)
+   {
+      memcpy(writer->dst, source, size);
+      writer->dst += size;
+      return;
+   }
+
+   for (; size; source += n, size -= n)
+   {
+      if (writer->column == writer->lineLength)
+      {
+         (writer->dst++)[0] = '\n';
+         writer->column = 0;
+      }
+
+      n = writer->lineLength - writer->column < size ? writer->lineLength - writer->column : size;
+      memcpy(writer->dst, source, n);
+      writer->dst    += n;
+      writer->column += n;
+   }
+}
+
+// encodes 'source' frames through a small buffer, which stays in L1 cache
+static void Z85_encode_lines(Z85_line_writer* writer, const char* source, const char* sourceEnd)
+{
+   char        buf[Z85_WRAP_CHUNK];
+   const char* chunkEnd;
+
+   for (; source != sourceEnd; source = chunkEnd)
+   {
+      chunkEnd = (size_t)(sourceEnd - source) > Z85_WRAP_CHUNK / 5 * 4 ? source + Z85_WRAP_CHUNK / 5 * 4 : sourceEnd;
+      Z85_write_lines(writer, buf, Z85_encode_unsafe(source, chunkEnd, buf) - buf);
+   }
+}
+
+static size_t Z85_wrapped_size(size_t size, size_t lineLength)
+{
+   return (lineLength && size) ? size + (size - 1) / lineLength : size;
+}
+
+size_t Z85_encode_wrapped_bound(size_t size, size_t lineLength)
+{
+   return Z85_wrapped_size(Z85_encode_bound(size), lineLength);
+}
+
+size_t Z85_encode_with_padding_wrapped_bound(size_t size, size_t lineLength)
+{
+   return Z85_wrapped_size(Z85_encode_with_padding_bound(size), lineLength);
+}
+
+size_t Z85_encode_wrapped(const char* source, char* dest, size_t inputSize, size_t lineLength)
+{
+   Z85_line_writer writer;
+
+   if (!source || !dest || inputSize % 4)
+   {
+      assert(!"wrong source, destination or input size");
+      return 0;
+   }
+
+   writer.dst        = dest;
+   writer.column     = 0;
+   writer.lineLength = lineLength;
+
+   Z85_encode_lines(&writer, source, source + inputSize);
+
+   return writer.dst - dest;
+}
+
+size_t Z85_encode_with_padding_wrapped(const char* source, char* dest, size_t inputSize, size_t lineLength)
+{
+   Z85_line_writer writer;
+   size_t          tailBytes = inputSize % 4;
+   const char*     end       = source + inputSize - tailBytes;
+   char            tail[6];
+
+   assert(source && dest);
+
+   // zero length string is not padded
+   if (!source || !dest || inputSize == 0)
+   {
+      return 0;
+   }
+
+   writer.dst        = dest;
+   writer.column     = 0;
+   writer.lineLength = lineLength;
+
+   tail[0] = (tailBytes == 0 ? '4' : '0' + (char)tailBytes);
+   Z85_write_lines(&writer, tail, 1);                                                          // write tail bytes count
+   Z85_encode_lines(&writer, source, end);                                                     // write body
+   Z85_write_lines(&writer, tail, Z85_encode_tail(&z85Alphabet, end, tailBytes, tail) - tail); // write tail
+
+   return writer.dst - dest;
+}
+
+// position of the 'symbol'-th symbol, which isn't whitespace, or 'inputSize'
+static size_t Z85_symbol_position(const char* source, size_t inputSize, size_t symbol)
+{
+   size_t i;
+
+   for (i = 0; i < inputSize; ++i)
+   {
+      if (!Z85_IS_SPACE(source[i]) && symbol-- == 0)
+      {
+         break;
+      }
+   }
+
+   return i;
+}
+
+size_t Z85_decode_skipping_whitespace(const char* source, char* dest, size_t inputSize, size_t* errorPos)
+{
+   char        buf[Z85_WRAP_CHUNK + Z85_COMPACT_SLACK];
+   size_t      bufSize = 0;
+   size_t      frames;
+   const char* src     = source;
+   const char* end     = source + inputSize;
+   const char* chunkEnd;
+   const char* pos;
+   char*       dst     = dest;
+
+   Z85_set_error(errorPos, Z85_NPOS);
+
+   if (!source || !dest)
+   {
+      Z85_set_error(errorPos, 0);
+      return 0;
+   }
+
+   Z85_get_backend(); // resolve kernels
+
+   // symbols are packed into a small buffer, complete frames are decoded right away
+   // and an incomplete one is moved to the front
+   for (; src != end; src = chunkEnd)
+   {
+      chunkEnd = (size_t)(end - src) > Z85_WRAP_CHUNK - bufSize ? src + (Z85_WRAP_CHUNK - bufSize) : end;
+      bufSize  = backends[activeBackend].compact(src, chunkEnd, buf + bufSize) - buf;
+      frames   = bufSize / 5 * 5;
+
+      pos = decodeCheckedKernel(&z85Alphabet, buf, buf + frames, dst);
+      if (pos != buf + frames)
+      {
+         Z85_set_error(errorPos, Z85_symbol_position(source, inputSize, (dst - dest) / 4 * 5 + (pos - buf)));
+         return 0;
+      }
+
+      dst     += frames / 5 * 4;
+      bufSize -= frames;
+      memmove(buf, buf + frames, bufSize);
+   }
+
+   if (bufSize)
+   {
+      Z85_set_error(errorPos, inputSize);
+      return 0;
+   }
+
+   return dst - dest;
+}
+
+size_t Z85_decode_with_padding_skipping_whitespace(const char* source, char* dest, size_t inputSize,
+                                                   size_t* errorPos)
+{
+   size_t first = 0;
+   size_t last  = inputSize;
+   size_t count;
+   size_t decoded;
+   char   tail[6 + 1]; // the scalar kernel writes one byte past the packed symbols
+   size_t tailSize;
+   size_t pos;
+
+   Z85_set_error(errorPos, Z85_NPOS);
+
+   if (!source || !dest)
+   {
+      Z85_set_error(errorPos, 0);
+      return 0;
+   }
+
+   // the tail bytes count goes first, the last frame is decoded separately
+   while (first < inputSize && Z85_IS_SPACE(source[first]))
+   {
+      ++first;
+   }
+
+   for (count = 0; count < 5 && last > first + 1; --last)
+   {
+      count += !Z85_IS_SPACE(source[last - 1]);
+   }
+
+   if (first == inputSize)
+   {
+      return 0; // zero length string is not padded
+   }
+
+   if (count < 5)
+   {
+      Z85_set_error(errorPos, inputSize);
+      return 0;
+   }
+
+   tail[0] = source[first];
+   Z85_compact_scalar(source + last, source + inputSize, tail + 1);
+
+   if ((byte)(tail[0] - '0' - 1) > 3)
+   {
+      Z85_set_error(errorPos, first);
+      return 0;
+   }
+
+   decoded = Z85_decode_skipping_whitespace(source + first + 1, dest, last - first - 1, &pos);
+   if (pos != Z85_NPOS)
+   {
+      Z85_set_error(errorPos, first + 1 + pos);
+      return 0;
+   }
+
+   tailSize = Z85_decode_with_padding_checked(tail, dest + decoded, 6, &pos);
+   if (pos != Z85_NPOS)
+   {
+      Z85_set_error(errorPos, last + Z85_symbol_position(source + last, inputSize - last, pos - 1));
+      return 0;
+   }
+
+   return decoded + tailSize;
+}
+
+
+
+/*******************************************************************************
+ * Streaming encoding/decoding                                                 *
+ *******************************************************************************/
+
+// Transcodes all complete frames of carried 'tail' followed by 'source', except those
+// overlapping the last 'lookahead' symbols. Whatever is left is carried in 'tail'.
+static char* Z85_feed(char* tail, size_t* tailSize, size_t frameSize, size_t lookahead, Z85_kernel kernel,
+                      const char* source, size_t inputSize, char* dst)
+{
+   const size_t available = *tailSize + inputSize;
+   size_t       frames    = available > lookahead ? (available - lookahead) / frameSize : 0;
+   size_t       size;
+
+   // frames starting in the carried tail
+   for (; frames && *tailSize; --frames)
+   {
+      if (*tailSize < frameSize)
+      {
+         size = frameSize - *tailSize;
+         memcpy(tail + *tailSize, source, size);
+         source    += size;
+         inputSize -= size;
+         *tailSize  = frameSize;
+      }
+
+      dst = kernel(tail, tail + frameSize, dst);
+      *tailSize -= frameSize;
+      memmove(tail, tail + frameSize, *tailSize);
+   }
+
+   size = frames * frameSize;
+   dst  = kernel(source, source + size, dst);
+
+   if (inputSize > size)
+   {
+      memcpy(tail + *tailSize, source + size, inputSize - size);
+      *tailSize += inputSize - size;
+   }
+
+   return dst;
+}
+
+static void Z85_encoder_reset(Z85_encoder_t* encoder, int trailingPadding)
+{
+   assert(encoder);
+   encoder->tailSize        = 0;
+   encoder->trailingPadding = trailingPadding;
+   encoder->empty           = 1;
+}
+
+void Z85_encoder_init(Z85_encoder_t* encoder)
+{
+   Z85_encoder_reset(encoder, 0);
+}
+
+void Z85_encoder_init_with_trailing_padding(Z85_encoder_t* encoder)
+{
+   Z85_encoder_reset(encoder, 1);
+}
+
+size_t Z85_encoder_update_bound(size_t size)
+{
+   return Z85_encode_bound(size + 3);
+}
+
+size_t Z85_encoder_update(Z85_encoder_t* encoder, const char* source, char* dest, size_t inputSize)
+{
+   if (!encoder || ((!source || !dest) && inputSize))
+   {
+      assert(!"wrong encoder, source or destination");
+      return 0;
+   }
+
+   encoder->empty = encoder->empty && inputSize == 0;
+
+   return Z85_feed(encoder->tail, &encoder->tailSize, 4, 0, Z85_encode_unsafe,
+                   source, inputSize, dest) - dest;
+}
+
+int Z85_encoder_finish(Z85_encoder_t* encoder, char* dest, size_t* written)
+{
+   char* dst = dest;
+
+   if (written)
+   {
+      *written = 0;
+   }
+
+   if (!encoder)
+   {
+      return 0;
+   }
+
+   if (!encoder->trailingPadding || encoder->empty)
+   {
+      return encoder->tailSize == 0;
+   }
+
+   if (!dest)
+   {
+      assert(!"wrong destination");
+      return 0;
+   }
+
+   dst = Z85_encode_tail(&z85Alphabet, encoder->tail, encoder->tailSize, dst);
+   (dst++)[0] = (encoder->tailSize == 0 ? '4' : '0' + (char)encoder->tailSize);
+   encoder->tailSize = 0;
+
+   if (written)
+   {
+      *written = dst - dest;
+   }
+
+   return 1;
+}
+
+static void Z85_decoder_reset(Z85_decoder_t* decoder, int trailingPadding)
+{
+   assert(decoder);
+   decoder->tailSize        = 0;
+   decoder->trailingPadding = trailingPadding;
+}
+
+void Z85_decoder_init(Z85_decoder_t* decoder)
+{
+   Z85_decoder_reset(decoder, 0);
+}
+
+void Z85_decoder_init_with_trailing_padding(Z85_decoder_t* decoder)
+{
+   Z85_decoder_reset(decoder, 1);
+}
+
+size_t Z85_decoder_update_bound(size_t size)
+{
+   return Z85_decode_bound(size + 4);
+}
+
+size_t Z85_decoder_update(Z85_decoder_t* decoder, const char* source, char* dest, size_t inputSize)
+{
+   if (!decoder || ((!source || !dest) && inputSize))
+   {
+      assert(!"wrong decoder, source or destination");
+      return 0;
+   }
+
+   // the last frame and the tail bytes count are held back until Z85_decoder_finish(),
+   // a frame is surely not the last one when at least 2 more symbols follow it
+   return Z85_feed(decoder->tail, &decoder->tailSize, 5, decoder->trailingPadding ? 2 : 0,
+                   Z85_decode_unsafe, source, inputSize, dest) - dest;
+}
+
+int Z85_decoder_finish(Z85_decoder_t* decoder, char* dest, size_t* written)
+{
+   size_t tailBytes;
+
+   if (written)
+   {
+      *written = 0;
+   }
+
+   if (!decoder)
+   {
+      return 0;
+   }
+
+   if (!decoder->trailingPadding || decoder->tailSize == 0)
+   {
+      return decoder->tailSize == 0;
+   }
+
+   tailBytes = decoder->tail[5] - '0';
+   if (!dest || decoder->tailSize != 6 || tailBytes - 1 > 3)
+   {
+      return 0;
+   }
+
+   Z85_decode_tail(&z85Alphabet, decoder->tail, tailBytes, dest);
+   decoder->tailSize = 0;
+
+   if (written)
+   {
+      *written = tailBytes;
+   }
+
+   return 1;
+}
+
+
+
+/*******************************************************************************
+ * Parallel encoding/decoding                                                  *
+ *******************************************************************************/
+
+#define Z85_DEFAULT_MIN_CHUNK_SIZE (1 << 20)
+#define Z85_MAX_THREADS            256
+
+typedef struct Z85_chunk
+{
+   Z85_alphabet_kernel kernel;
+   const char*         source;
+   const char*         sourceEnd;
+   char*               dest;
+   int                 streaming; // see Z85_set_large_buffer_threshold()
+} Z85_chunk;
+
+#if defined (Z85_THREADS)
+static void* Z85_transcode_chunk(void* arg)
+{
+   Z85_chunk* chunk = (Z85_chunk*)arg;
+   if (chunk->streaming)
+   {
+      Z85_transcode_streaming(chunk->kernel, chunk->source, chunk->sourceEnd, chunk->dest);
+   }
+   else
+   {
+      chunk->kernel(&z85Alphabet, chunk->source, chunk->sourceEnd, chunk->dest);
+   }
+   return NULL;
+}
+#endif
+
+static size_t Z85_cpu_count(void)
+{
+#if defined (Z85_THREADS)
+   long count = sysconf(_SC_NPROCESSORS_ONLN);
+   return count > 0 ? (size_t)count : 1;
+#else
+   return 1;
+#endif
+}
+
+// Splits [source;sourceEnd) into chunks on frame boundaries ('inFrame' input bytes are
+// transcoded into 'outFrame' output bytes) and transcodes them in parallel.
+// Chunks are not smaller than 'minChunkSize' bytes, the calling thread takes the first one.
+static char* Z85_transcode_parallel(int encode, const char* source, const char* sourceEnd, char* dest,
+                                    size_t inFrame, size_t outFrame, size_t threadCount, size_t minChunkSize)
+{
+   const size_t        frames = (sourceEnd - source) / inFrame;
+   size_t              chunkCount;
+   Z85_alphabet_kernel kernel;
+   Z85_chunk           chunks[Z85_MAX_THREADS];
+   size_t              i;
+#if defined (Z85_THREADS)
+   pthread_t           threads[Z85_MAX_THREADS];
+   int                 started[Z85_MAX_THREADS];
+#endif
+
+   if (threadCount == 0)  threadCount  = Z85_cpu_count();
+   if (minChunkSize == 0) minChunkSize = Z85_DEFAULT_MIN_CHUNK_SIZE;
+
+   chunkCount = (sourceEnd - source) / minChunkSize;
+   if (chunkCount > threadCount)     chunkCount = threadCount;
+   if (chunkCount > Z85_MAX_THREADS) chunkCount = Z85_MAX_THREADS;
+
+#if !defined (Z85_THREADS)
+   chunkCount = 1;
+#endif
+
+   if (chunkCount <= 1)
+   {
+      return encode ? Z85_encode_unsafe(source, sourceEnd, dest) : Z85_decode_unsafe(source, sourceEnd, dest);
+   }
+
+   Z85_get_backend(); // resolve kernels before threads start
+   kernel = encode ? encodeKernel : decodeKernel;
+
+   for (i = 0; i < chunkCount; ++i)
+   {
+      const size_t begin = frames / chunkCount * i       + (i     < frames % chunkCount ? i     : frames % chunkCount);
+      const size_t end   = frames / chunkCount * (i + 1) + (i + 1 < frames % chunkCount ? i + 1 : frames % chunkCount);
+
+      chunks[i].kernel    = kernel;
+      chunks[i].source    = source + begin * inFrame;
+      chunks[i].sourceEnd = source + end * inFrame;
+      chunks[i].dest      = dest + begin * outFrame;
+      chunks[i].streaming = (size_t)(sourceEnd - source) >= largeBufferThreshold;
+   }
+
+#if defined (Z85_THREADS)
+   for (i = 1; i < chunkCount; ++i)
+   {
+      started[i] = pthread_create(&threads[i], NULL, Z85_transcode_chunk, &chunks[i]) == 0;
+   }
+
+   Z85_transcode_chunk(&chunks[0]);
+
+   for (i = 1; i < chunkCount; ++i)
+   {
+      if (started[i])
+      {
+         pthread_join(threads[i], NULL);
+      }
+      else
+      {
+         Z85_transcode_chunk(&chunks[i]); // couldn't start a thread, do it here
+      }
+   }
+#endif
+
+   return dest + frames * outFrame;
+}
+
+// unpacks 1-4 trailing bytes as a big-endian frame padded with zeros
+static uint32_t Z85_tail_value(const char* end, size_t tailBytes)
+{
+   const byte* src   = (const byte*)end;
+   uint32_t    value = 0;
+   size_t      i;
+
+   for (i = 0; i < tailBytes; ++i)
+   {
+      value |= (uint32_t)src[i] << (24 - 8 * i);
+   }
+
+   return value;
+}
+
+// encodes 1-3 trailing bytes padded with zeros as a single frame
+static char* Z85_encode_tail(const Z85_alphabet_t* alphabet, const char* end, size_t tailBytes, char* dst)
+{
+   if (tailBytes == 0)
+   {
+      return dst;
+   }
+
+   return Z85_encode_frame(alphabet, Z85_tail_value(end, tailBytes), dst);
+}
+
+// decodes the last frame and keeps 1-4 leading bytes of it
+static char* Z85_decode_tail(const Z85_alphabet_t* alphabet, const char* end, size_t tailBytes, char* dst)
+{
+   char tailBuf[4] = { 0 };
+
+   decodeKernel(alphabet, end, end + 5, tailBuf);
+
+   switch (tailBytes)
+   {
+   case 4:
+      dst[3] = tailBuf[3];
+   case 3:
+      dst[2] = tailBuf[2];
+   case 2:
+      dst[1] = tailBuf[1];
+   case 1:
+      dst[0] = tailBuf[0];
+   }
+
+   return dst + tailBytes;
+}
+
+size_t Z85_encode_parallel(const char* source, char* dest, size_t inputSize, size_t threadCount, size_t minChunkSize)
+{
+   if (!source || !dest || inputSize % 4)
+   {
+      assert(!"wrong source, destination or input size");
+      return 0;
+   }
+
+   return Z85_transcode_parallel(1, source, source + inputSize, dest, 4, 5, threadCount, minChunkSize) - dest;
+}
+
+size_t Z85_decode_parallel(const char* source, char* dest, size_t inputSize, size_t threadCount, size_t minChunkSize)
+{
+   if (!source || !dest || inputSize % 5)
+   {
+      assert(!"wrong source, destination or input size");
+      return 0;
+   }
+
+   return Z85_transcode_parallel(0, source, source + inputSize, dest, 5, 4, threadCount, minChunkSize) - dest;
+}
+
+size_t Z85_encode_with_padding_parallel(const char* source, char* dest, size_t inputSize,
+                                        size_t threadCount, size_t minChunkSize)
+{
+   size_t      tailBytes  = inputSize % 4;
+   char*       dst        = dest;
+   const char* end        = source + inputSize - tailBytes;
+
+   assert(source && dest);
+
+   // zero length string is not padded
+   if (!source || !dest || inputSize == 0)
+   {
+      return 0;
+   }
+
+   (dst++)[0] = (tailBytes == 0 ? '4' : '0' + (char)tailBytes); // write tail bytes count
+   dst = Z85_transcode_parallel(1, source, end, dst, 4, 5,      // write body
+                                threadCount, minChunkSize);
+   dst = Z85_encode_tail(&z85Alphabet, end, tailBytes, dst);    // write tail
+
+   return dst - dest;
+}
+
+size_t Z85_decode_with_padding_parallel(const char* source, char* dest, size_t inputSize,
+                                        size_t threadCount, size_t minChunkSize)
+{
+   char*       dst        = dest;
+   size_t      tailBytes;
+   const char* end        = source + inputSize;
+
+   assert(source && dest && (inputSize == 0 || (inputSize - 1) % 5 == 0));
+
+   // zero length string is not padded
+   if (!source || !dest || inputSize == 0 || (inputSize - 1) % 5)
+   {
+      return 0;
+   }
+
+   tailBytes = (source++)[0] - '0'; // possible values: 1, 2, 3 or 4
+   if (tailBytes - 1 > 3)
+   {
+      assert(!"wrong tail bytes count");
+      return 0;
+   }
+
+   end -= 5;
+   if (source != end)
+   {
+      // decode body
+      dst = Z85_transcode_parallel(0, source, end, dst, 5, 4, threadCount, minChunkSize);
+   }
+
+   // decode last 5 bytes chunk
+   dst = Z85_decode_tail(&z85Alphabet, end, tailBytes, dst);
+
+   return dst - dest;
+}
+
+
+
+/*******************************************************************************
+ * Batch encoding                                                              *
+ *******************************************************************************/
+
+// frames shorter than a bulk kernel iteration are gathered across messages
+#define Z85_BATCH_FRAMES 8
+#define Z85_BATCH_BULK   32 // bytes
+
+typedef struct Z85_frame_batch
+{
+   uint32_t          values[Z85_BATCH_FRAMES];
+   char*             dests[Z85_BATCH_FRAMES];
+   size_t            count;
+   Z85_frames_kernel kernel;
+} Z85_frame_batch;
+
+static void Z85_batch_frame(Z85_frame_batch* batch, uint32_t value, char* dest)
+{
+   batch->values[batch->count] = value;
+   batch->dests[batch->count]  = dest;
+
+   if (++batch->count == Z85_BATCH_FRAMES)
+   {
+      batch->kernel(batch->values, batch->dests, batch->count);
+      batch->count = 0;
+   }
+}
+
+// messages are taken either from 'inputs' or from 'data' split by 'inputOffsets'
+static void Z85_message(const Z85_buffer_t* inputs, const char* data, const size_t* inputOffsets, size_t i,
+                        const char** source, size_t* size)
+{
+   if (inputs)
+   {
+      *source = inputs[i].data;
+      *size   = inputs[i].size;
+   }
+   else
+   {
+      *source = data + inputOffsets[i];
+      *size   = inputOffsets[i + 1] - inputOffsets[i];
+   }
+}
+
+static size_t Z85_encode_with_padding_messages(const Z85_buffer_t* inputs, const char* data,
+                                               const size_t* inputOffsets, size_t count, char* dest, size_t* offsets)
+{
+   Z85_frame_batch batch;
+   const char*     source;
+   const char*     end;
+   const char*     bulkEnd;
+   char*           dst;
+   size_t          size;
+   size_t          tailBytes;
+   size_t          i;
+
+   if (!dest || !offsets)
+   {
+      assert(!"wrong destination or offsets");
+      return 0;
+   }
+
+   // all bounds go first, so the messages can be written in any order
+   offsets[0] = 0;
+   for (i = 0; i < count; ++i)
+   {
+      Z85_message(inputs, data, inputOffsets, i, &source, &size);
+      offsets[i + 1] = offsets[i] + Z85_encode_with_padding_bound(source ? size : 0);
+   }
+
+   Z85_get_backend(); // resolve kernels
+   batch.kernel = backends[activeBackend].encodeFrames;
+   batch.count  = 0;
+
+   for (i = 0; i < count; ++i)
+   {
+      Z85_message(inputs, data, inputOffsets, i, &source, &size);
+      if (!source || size == 0)
+      {
+         continue;
+      }
+
+      tailBytes = size % 4;
+      end       = source + size - tailBytes;
+      bulkEnd   = source + (size - tailBytes) / Z85_BATCH_BULK * Z85_BATCH_BULK;
+      dst       = dest + offsets[i];
+
+      (dst++)[0] = (tailBytes == 0 ? '4' : '0' + (char)tailBytes); // write tail bytes count
+      dst = Z85_encode_unsafe(source, bulkEnd, dst);                // write bulk of the body
+
+      // the rest of the body and the tail are encoded along with frames of other messages
+      for (; bulkEnd != end; bulkEnd += 4, dst += 5)
+      {
+         Z85_batch_frame(&batch, Z85_tail_value(bulkEnd, 4), dst);
+      }
+
+      if (tailBytes)
+      {
+         Z85_batch_frame(&batch, Z85_tail_value(end, tailBytes), dst);
+      }
+   }
+
+   batch.kernel(batch.values, batch.dests, batch.count);
+
+   return offsets[count];
+}
+
+size_t Z85_encode_with_padding_batch_bound(const Z85_buffer_t* inputs, size_t count)
+{
+   size_t bound = 0;
+   size_t i;
+
+   for (i = 0; inputs && i < count; ++i)
+   {
+      bound += Z85_encode_with_padding_bound(inputs[i].data ? inputs[i].size : 0);
+   }
+
+   return bound;
+}
+
+size_t Z85_encode_with_padding_batch(const Z85_buffer_t* inputs, size_t count, char* dest, size_t* offsets)
+{
+   if (count && !inputs)
+   {
+      assert(!"wrong source");
+      return 0;
+   }
+
+   return Z85_encode_with_padding_messages(inputs, NULL, NULL, count, dest, offsets);
+}
+
+size_t Z85_encode_with_padding_columnar_bound(const size_t* inputOffsets, size_t count)
+{
+   size_t bound = 0;
+   size_t i;
+
+   for (i = 0; inputOffsets && i < count; ++i)
+   {
+      bound += Z85_encode_with_padding_bound(inputOffsets[i + 1] - inputOffsets[i]);
+   }
+
+   return bound;
+}
+
+size_t Z85_encode_with_padding_columnar(const char* data, const size_t* inputOffsets, size_t count,
+                                        char* dest, size_t* offsets)
+{
+   if (count && (!data || !inputOffsets))
+   {
+      assert(!"wrong source");
+      return 0;
+   }
+
+   return Z85_encode_with_padding_messages(NULL, data, inputOffsets, count, dest, offsets);
+}
+
+
+
+/*******************************************************************************
+ * In-place encoding/decoding                                                  *
+ *******************************************************************************/
+
+#define Z85_INPLACE_CHUNK 4000 // symbols, a multiple of 5
+
+// Decoding needs no special care: the output is shorter and every kernel loads symbols of a block
+// before storing its bytes, so the output never overtakes the input. Threads would break that,
+// so in-place functions are always sequential.
+
+// encodes 'frames' frames of 'buffer' into 'dest' (not before 'buffer') from back to front
+// through a small buffer, so the output overwrites only frames, which are already encoded
+static void Z85_encode_backward(const char* buffer, size_t frames, char* dest)
+{
+   char   buf[Z85_INPLACE_CHUNK];
+   size_t chunkFrames;
+
+   for (; frames; frames -= chunkFrames)
+   {
+      chunkFrames = frames > Z85_INPLACE_CHUNK / 5 ? Z85_INPLACE_CHUNK / 5 : frames;
+      Z85_encode_unsafe(buffer + (frames - chunkFrames) * 4, buffer + frames * 4, buf);
+      memcpy(dest + (frames - chunkFrames) * 5, buf, chunkFrames * 5);
+   }
+}
+
+size_t Z85_encode_inplace(char* buffer, size_t inputSize)
+{
+   if (!buffer || inputSize % 4)
+   {
+      assert(!"wrong buffer or input size");
+      return 0;
+   }
+
+   Z85_encode_backward(buffer, inputSize / 4, buffer);
+
+   return Z85_encode_bound(inputSize);
+}
+
+size_t Z85_decode_inplace(char* buffer, size_t inputSize)
+{
+   if (!buffer || inputSize % 5)
+   {
+      assert(!"wrong buffer or input size");
+      return 0;
+   }
+
+   return Z85_decode_unsafe(buffer, buffer + inputSize, buffer) - buffer;
+}
+
+size_t Z85_encode_with_padding_inplace(char* buffer, size_t inputSize)
+{
+   size_t tailBytes = inputSize % 4;
+   size_t frames    = inputSize / 4;
+
+   assert(buffer);
+
+   // zero length string is not padded
+   if (!buffer || inputSize == 0)
+   {
+      return 0;
+   }
+
+   // the tail goes first, it's written past the input
+   if (tailBytes)
+   {
+      Z85_encode_frame(&z85Alphabet, Z85_tail_value(buffer + frames * 4, tailBytes), buffer + 1 + frames * 5);
+   }
+
+   Z85_encode_backward(buffer, frames, buffer + 1);
+   buffer[0] = (tailBytes == 0 ? '4' : '0' + (char)tailBytes); // byte 0 is already encoded
+
+   return Z85_encode_with_padding_bound(inputSize);
+}
+
+size_t Z85_decode_with_padding_inplace(char* buffer, size_t inputSize)
+{
+   size_t tailBytes;
+   char*  dst;
+
+   assert(buffer && (inputSize == 0 || (inputSize - 1) % 5 == 0));
+
+   // zero length string is not padded
+   if (!buffer || inputSize == 0 || (inputSize - 1) % 5)
+   {
+      return 0;
+   }
+
+   tailBytes = buffer[0] - '0'; // possible values: 1, 2, 3 or 4
+   if (tailBytes - 1 > 3)
+   {
+      assert(!"wrong tail bytes count");
+      return 0;
+   }
+
+   dst = Z85_decode_unsafe(buffer + 1, buffer + inputSize - 5, buffer);         // decode body
+   dst = Z85_decode_tail(&z85Alphabet, buffer + inputSize - 5, tailBytes, dst); // decode last 5 bytes chunk
+
+   return dst - buffer;
+}
+
+size_t Z85_encode_with_trailing_padding_inplace(char* buffer, size_t inputSize)
+{
+   size_t tailBytes = inputSize % 4;
+   size_t frames    = inputSize / 4;
+   char*  end       = buffer + frames * 5;
+
+   assert(buffer);
+
+   // zero length string is not padded
+   if (!buffer || inputSize == 0)
+   {
+      return 0;
+   }
+
+   // the tail and the tail bytes count go first, they are written past the input
+   if (tailBytes)
+   {
+      end = Z85_encode_frame(&z85Alphabet, Z85_tail_value(buffer + frames * 4, tailBytes), end);
+   }
+   end[0] = (tailBytes == 0 ? '4' : '0' + (char)tailBytes);
+
+   Z85_encode_backward(buffer, frames, buffer);
+
+   return end + 1 - buffer;
+}
+
+size_t Z85_decode_with_trailing_padding_inplace(char* buffer, size_t inputSize)
+{
+   size_t tailBytes;
+   char*  dst;
+
+   assert(buffer && (inputSize == 0 || (inputSize - 1) % 5 == 0));
+
+   // zero length string is not padded
+   if (!buffer || inputSize == 0 || (inputSize - 1) % 5)
+   {
+      return 0;
+   }
+
+   tailBytes = buffer[inputSize - 1] - '0'; // possible values: 1, 2, 3 or 4
+   if (tailBytes - 1 > 3)
+   {
+      assert(!"wrong tail bytes count");
+      return 0;
+   }
+
+   dst = Z85_decode_unsafe(buffer, buffer + inputSize - 6, buffer);             // decode body
+   dst = Z85_decode_tail(&z85Alphabet, buffer + inputSize - 6, tailBytes, dst); // decode last 5 bytes chunk
+
+   return dst - buffer;
+}
+
+
+
+/*******************************************************************************
+ * Custom alphabets                                                            *
+ *******************************************************************************/
+
+const Z85_alphabet_t* Z85_alphabet_z85(void)
+{
+   return &z85Alphabet;
+}
+
+const Z85_alphabet_t* Z85_alphabet_rfc1924(void)
+{
+   return &rfc1924Alphabet;
+}
+
+const Z85_alphabet_t* Z85_alphabet_ascii85(void)
+{
+   return &ascii85Alphabet;
+}
+
+// pair tables share the allocation with the alphabet
+typedef struct Z85_alphabet_storage
+{
+   Z85_alphabet_t alphabet;
+   char           encodePairs[Z85_ENCODE_PAIRS_SIZE];
+   unsigned short decodePairs[Z85_DECODE_PAIRS_SIZE];
+} Z85_alphabet_storage;
+
+Z85_alphabet_t* Z85_alphabet_create(const char* symbols)
+{
+   Z85_alphabet_storage* storage;
+   Z85_alphabet_t*       alphabet;
+   byte                  seen[96] = { 0 };
+   byte                  symbol;
+   size_t                i;
+
+   if (!symbols || strlen(symbols) != 85)
+   {
+      return NULL;
+   }
+
+   for (i = 0; i < 85; ++i)
+   {
+      symbol = (byte)symbols[i];
+      if (symbol < '!' || symbol > '~' || seen[symbol - 32])
+      {
+         return NULL;
+      }
+      seen[symbol - 32] = 1;
+   }
+
+   storage = (Z85_alphabet_storage*)calloc(1, sizeof(Z85_alphabet_storage));
+   if (!storage)
+   {
+      return NULL;
+   }
+
+   alphabet              = &storage->alphabet;
+   alphabet->encodePairs = storage->encodePairs;
+   alphabet->decodePairs = storage->decodePairs;
+
+   for (i = 0; i < 85; ++i)
+   {
+      alphabet->base85[i]                      = symbols[i];
+      alphabet->base256[(byte)symbols[i] - 32] = (byte)i;
+   }
+
+   Z85_init_alphabet_pairs(alphabet);
+   return alphabet;
+}
+
+void Z85_alphabet_free(Z85_alphabet_t* alphabet)
+{
+   // presets are never freed, the storage starts with the alphabet
+   if (alphabet != &z85Alphabet && alphabet != &rfc1924Alphabet && alphabet != &ascii85Alphabet)
+   {
+      free(alphabet);
+   }
+}
+
+const char* Z85_alphabet_symbols(const Z85_alphabet_t* alphabet)
+{
+   assert(alphabet);
+   return alphabet->base85; // zero padded
+}
+
+char* Z85_alphabet_encode_unsafe(const Z85_alphabet_t* alphabet, const char* source, const char* sourceEnd,
+                                 char* dest)
+{
+   assert(alphabet);
+   return encodeKernel(alphabet, source, sourceEnd, dest);
+}
+
+char* Z85_alphabet_decode_unsafe(const Z85_alphabet_t* alphabet, const char* source, const char* sourceEnd,
+                                 char* dest)
+{
+   assert(alphabet);
+   return decodeKernel(alphabet, source, sourceEnd, dest);
+}
+
+size_t Z85_alphabet_encode(const Z85_alphabet_t* alphabet, const char* source, char* dest, size_t inputSize)
+{
+   if (!alphabet || !source || !dest || inputSize % 4)
+   {
+      assert(!"wrong alphabet, source, destination or input size");
+      return 0;
+   }
+
+   return encodeKernel(alphabet, source, source + inputSize, dest) - dest;
+}
+
+size_t Z85_alphabet_decode(const Z85_alphabet_t* alphabet, const char* source, char* dest, size_t inputSize)
+{
+   if (!alphabet || !source || !dest || inputSize % 5)
+   {
+      assert(!"wrong alphabet, source, destination or input size");
+      return 0;
+   }
+
+   return decodeKernel(alphabet, source, source + inputSize, dest) - dest;
+}
+
+size_t Z85_alphabet_encode_with_padding(const Z85_alphabet_t* alphabet, const char* source, char* dest,
+                                        size_t inputSize)
+{
+   size_t      tailBytes = inputSize % 4;
+   char*       dst       = dest;
+   const char* end       = source + inputSize - tailBytes;
+
+   assert(alphabet && source && dest);
+
+   // zero length string is not padded
+   if (!alphabet || !source || !dest || inputSize == 0)
+   {
+      return 0;
+   }
+
+   (dst++)[0] = (tailBytes == 0 ? '4' : '0' + (char)tailBytes); // write tail bytes count
+   dst = encodeKernel(alphabet, source, end, dst);               // write body
+   dst = Z85_encode_tail(alphabet, end, tailBytes, dst);         // write tail
+
+   return dst - dest;
+}
+
+size_t Z85_alphabet_decode_with_padding(const Z85_alphabet_t* alphabet, const char* source, char* dest,
+                                        size_t inputSize)
+{
+   char*  dst = dest;
+   size_t tailBytes;
+
+   assert(alphabet && source && dest && (inputSize == 0 || (inputSize - 1) % 5 == 0));
+
+   // zero length string is not padded
+   if (!alphabet || !source || !dest || inputSize == 0 || (inputSize - 1) % 5)
+   {
+      return 0;
+   }
+
+   tailBytes = source[0] - '0'; // possible values: 1, 2, 3 or 4
+   if (tailBytes - 1 > 3)
+   {
+      assert(!"wrong tail bytes count");
+      return 0;
+   }
+
+   dst = decodeKernel(alphabet, source + 1, source + inputSize - 5, dst);     // decode body
+   dst = Z85_decode_tail(alphabet, source + inputSize - 5, tailBytes, dst); // decode last 5 bytes chunk
+
+   return dst - dest;
+}
+
+
+
+/*******************************************************************************
+ * Ascii85 encoding/decoding                                                   *
+ *******************************************************************************/
+
+#define Z85_ZEROS_SYMBOL  'z'
+#define Z85_SPACES_SYMBOL 'y'
+#define Z85_SPACES_FRAME  0x20202020U
+
+// Dense runs shorter than this many frames are encoded by the scalar kernel: SIMD kernels
+// spend more on setting up their constants (and on AVX state transitions) than on such runs
+#define Z85_ASCII85_SHORT_RUN 64
+
+// true if any of two 32-bit lanes of 'word' is zero: a borrow into bit 31 of a lane
+// comes from the lane itself only if it's zero, the high lane may also get a false hit
+// from the low one, but only if the low one is zero
+#define Z85_HAS_ZERO_LANE(word) \
+   ((((word) - 0x0000000100000001ULL) & ~(word) & 0x8000000080000000ULL) != 0)
+
+// returns the number of leading frames of 'src', which are equal to 'frame' ('frame' bytes are all the same)
+static size_t Z85_count_equal_frames(const char* src, size_t frames, uint32_t frame)
+{
+   const Z85_uint64_t pattern = frame * 0x0000000100000001ULL;
+   Z85_uint64_t       words[4];
+   uint32_t           value;
+   size_t             i = 0;
+
+   for (; frames - i >= 8; i += 8)
+   {
+      memcpy(words, src + i * 4, 32);
+      if (((words[0] ^ pattern) | (words[1] ^ pattern) | (words[2] ^ pattern) | (words[3] ^ pattern)) != 0)
+      {
+         break;
+      }
+   }
+
+   for (; frames - i >= 2; i += 2)
+   {
+      memcpy(words, src + i * 4, 8);
+      if (words[0] != pattern)
+      {
+         break;
+      }
+   }
+
+   for (; i < frames; ++i)
+   {
+      memcpy(&value, src + i * 4, 4);
+      if (value != frame)
+      {
+         break;
+      }
+   }
+
+   return i;
+}
+
+// returns the number of leading frames of 'src', which are neither zeros nor spaces (if 'spaces' is set)
+static size_t Z85_count_other_frames(const char* src, size_t frames, int spaces)
+{
+   const Z85_uint64_t spacesPattern = Z85_SPACES_FRAME * 0x0000000100000001ULL;
+   Z85_uint64_t       word;
+   uint32_t           value;
+   size_t             i = 0;
+
+   for (; frames - i >= 2; i += 2)
+   {
+      memcpy(&word, src + i * 4, 8);
+      if (Z85_HAS_ZERO_LANE(word) || (spaces && Z85_HAS_ZERO_LANE(word ^ spacesPattern)))
+      {
+         break;
+      }
+   }
+
+   for (; i < frames; ++i)
+   {
+      memcpy(&value, src + i * 4, 4);
+      if (value == 0 || (spaces && value == Z85_SPACES_FRAME))
+      {
+         break;
+      }
+   }
+
+   return i;
+}
+
+// returns the number of leading 'symbol's of [src;end)
+static size_t Z85_count_symbols(const char* src, const char* end, char symbol)
+{
+   const Z85_uint64_t pattern = (byte)symbol * 0x0101010101010101ULL;
+   const char*        pos     = src;
+   Z85_uint64_t       word;
+
+   for (; end - pos >= 8; pos += 8)
+   {
+      memcpy(&word, pos, 8);
+      if (word != pattern)
+      {
+         break;
+      }
+   }
+
+   for (; pos != end && *pos == symbol; ++pos)
+   {
+   }
+
+   return pos - src;
+}
+
+size_t Z85_ascii85_encode_bound(size_t size)
+{
+   return Z85_encode_bound(size) + (size % 4 ? size % 4 + 1 : 0) + 4; // framing included
+}
+
+size_t Z85_ascii85_decode_bound(size_t size)
+{
+   return size * 4;
+}
+
+size_t Z85_ascii85_encode(const char* source, char* dest, size_t inputSize, int flags)
+{
+   const int   spaces    = (flags & Z85_ASCII85_SPACES) != 0;
+   size_t      tailBytes = inputSize % 4;
+   const char* src       = source;
+   const char* end       = source + inputSize - tailBytes;
+   char*       dst       = dest;
+   char        tail[5];
+   size_t      count;
+
+   if (!source || !dest)
+   {
+      assert(!"wrong source or destination");
+      return 0;
+   }
+
+   if (flags & Z85_ASCII85_FRAMED)
+   {
+      (dst++)[0] = '<';
+      (dst++)[0] = '~';
+   }
+
+   // dense runs go to the kernels in one piece, zero runs are just counted
+   while (src != end)
+   {
+      count = Z85_count_other_frames(src, (end - src) / 4, spaces);
+      dst   = count < Z85_ASCII85_SHORT_RUN ? Z85_encode_unsafe_scalar(&ascii85Alphabet, src, src + count * 4, dst)
+                                            : encodeKernel(&ascii85Alphabet, src, src + count * 4, dst);
+      src  += count * 4;
+
+      count = Z85_count_equal_frames(src, (end - src) / 4, 0);
+      memset(dst, Z85_ZEROS_SYMBOL, count);
+      dst  += count;
+      src  += count * 4;
+
+      if (spaces)
+      {
+         count = Z85_count_equal_frames(src, (end - src) / 4, Z85_SPACES_FRAME);
+         memset(dst, Z85_SPACES_SYMBOL, count);
+         dst  += count;
+         src  += count * 4;
+      }
+   }
+
+   // the last group keeps 'tailBytes' + 1 symbols
+   if (tailBytes)
+   {
+      Z85_encode_tail(&ascii85Alphabet, end, tailBytes, tail);
+      memcpy(dst, tail, tailBytes + 1);
+      dst += tailBytes + 1;
+   }
+
+   if (flags & Z85_ASCII85_FRAMED)
+   {
+      (dst++)[0] = '~';
+      (dst++)[0] = '>';
+   }
+
+   return dst - dest;
+}
+
+size_t Z85_ascii85_decode(const char* source, char* dest, size_t inputSize, int flags, size_t* errorPos)
+{
+   const int   spaces = (flags & Z85_ASCII85_SPACES) != 0;
+   const char* src    = source;
+   const char* end    = source + inputSize;
+   const char* limit;
+   const char* pos;
+   char*       dst    = dest;
+   char        tail[5];
+   char        tailBuf[4];
+   size_t      count;
+
+   Z85_set_error(errorPos, Z85_NPOS);
+
+   if (!source || !dest)
+   {
+      Z85_set_error(errorPos, 0);
+      return 0;
+   }
+
+   if (inputSize >= 2 && src[0] == '<' && src[1] == '~')
+   {
+      src += 2;
+   }
+
+   if (end - src >= 2 && end[-2] == '~' && end[-1] == '>')
+   {
+      end -= 2;
+   }
+   else if (flags & Z85_ASCII85_FRAMED)
+   {
+      Z85_set_error(errorPos, inputSize);
+      return 0;
+   }
+
+   // 'z' and 'y' are out of the alphabet, so checked kernels stop right at them
+   while (src != end)
+   {
+      limit = src + (end - src) / 5 * 5;
+      pos   = decodeCheckedKernel(&ascii85Alphabet, src, limit, dst);
+      dst  += (pos - src) / 5 * 4;
+      src  += (pos - src) / 5 * 5;
+
+      if (pos == end)
+      {
+         break;
+      }
+
+      if (pos == src && (*pos == Z85_ZEROS_SYMBOL || (spaces && *pos == Z85_SPACES_SYMBOL)))
+      {
+         count = Z85_count_symbols(src, end, *pos);
+         memset(dst, *pos == Z85_ZEROS_SYMBOL ? 0 : ' ', count * 4);
+         dst += count * 4;
+         src += count;
+         continue;
+      }
+
+      if (pos != limit)
+      {
+         Z85_set_error(errorPos, pos - source);
+         return 0;
+      }
+
+      // the last group of 2-4 symbols is padded with the highest digit
+      count = end - src;
+      if (count == 1)
+      {
+         Z85_set_error(errorPos, inputSize);
+         return 0;
+      }
+
+      memcpy(tail, src, count);
+      memset(tail + count, ascii85Alphabet.base85[84], 5 - count);
+
+      pos = Z85_decode_checked_scalar(&ascii85Alphabet, tail, tail + 5, tailBuf);
+      if (pos != tail + 5)
+      {
+         Z85_set_error(errorPos, (src - source) + ((size_t)(pos - tail) < count ? pos - tail : 0));
+         return 0;
+      }
+
+      memcpy(dst, tailBuf, count - 1);
+      dst += count - 1;
+      break;
+   }
+
+   return dst - dest;
+}
+
+
+
+/*******************************************************************************
+ * Checksums                                                                   *
+ *******************************************************************************/
+
+// Transcodes by blocks of Z85_STREAM_BLOCK bytes (symbols) and checksums every block
+// right after the kernel, while its binary side is still in L1 cache
+static char* Z85_encode_crc32c_unsafe(const char* source, const char* sourceEnd, char* dest, uint32_t* crc)
+{
+   const char* blockEnd;
+
+   for (; source != sourceEnd; source = blockEnd)
+   {
+      blockEnd = (size_t)(sourceEnd - source) > Z85_STREAM_BLOCK ? source + Z85_STREAM_BLOCK : sourceEnd;
+
+      dest = encodeKernel(&z85Alphabet, source, blockEnd, dest);
+      *crc = crc32cKernel(*crc, source, blockEnd - source);
+   }
+
+   return dest;
+}
+
+static char* Z85_decode_crc32c_unsafe(const char* source, const char* sourceEnd, char* dest, uint32_t* crc)
+{
+   const char* blockEnd;
+   char*       blockDest;
+
+   for (; source != sourceEnd; source = blockEnd)
+   {
+      blockEnd = (size_t)(sourceEnd - source) > Z85_STREAM_BLOCK ? source + Z85_STREAM_BLOCK : sourceEnd;
+
+      blockDest = dest;
+      dest = decodeKernel(&z85Alphabet, source, blockEnd, dest);
+      *crc = crc32cKernel(*crc, blockDest, dest - blockDest);
+   }
+
+   return dest;
+}
+
+// returns a pointer to the first invalid symbol (frame) or 'sourceEnd', as checked kernels do
+static const char* Z85_decode_crc32c_checked(const char* source, const char* sourceEnd, char* dest, uint32_t* crc)
+{
+   const char* blockEnd;
+   const char* pos;
+   size_t      size;
+
+   for (; source != sourceEnd; source = blockEnd)
+   {
+      blockEnd = (size_t)(sourceEnd - source) > Z85_STREAM_BLOCK ? source + Z85_STREAM_BLOCK : sourceEnd;
+
+      pos = decodeCheckedKernel(&z85Alphabet, source, blockEnd, dest);
+      if (pos != blockEnd)
+      {
+         return pos;
+      }
+
+      size = Z85_decode_bound(blockEnd - source);
+      *crc = crc32cKernel(*crc, dest, size);
+      dest += size;
+   }
+
+   return sourceEnd;
+}
+
+unsigned int Z85_crc32c(unsigned int crc, const char* data, size_t size)
+{
+   assert(data || size == 0);
+
+   if (!data)
+   {
+      return crc;
+   }
+
+   return ~crc32cKernel(~crc, data, size);
+}
+
+size_t Z85_encode_crc32c(const char* source, char* dest, size_t inputSize, unsigned int* crc)
+{
+   uint32_t value;
+
+   if (!source || !dest || !crc || inputSize % 4)
+   {
+      assert(!"wrong source, destination, checksum or input size");
+      return 0;
+   }
+
+   value = ~*crc;
+   Z85_encode_crc32c_unsafe(source, source + inputSize, dest, &value);
+   *crc = ~value;
+
+   return Z85_encode_bound(inputSize);
+}
+
+size_t Z85_decode_crc32c(const char* source, char* dest, size_t inputSize, unsigned int* crc)
+{
+   uint32_t value;
+
+   if (!source || !dest || !crc || inputSize % 5)
+   {
+      assert(!"wrong source, destination, checksum or input size");
+      return 0;
+   }
+
+   value = ~*crc;
+   Z85_decode_crc32c_unsafe(source, source + inputSize, dest, &value);
+   *crc = ~value;
+
+   return Z85_decode_bound(inputSize);
+}
+
+size_t Z85_encode_with_checksum_bound(size_t size)
+{
+   return size == 0 ? 0 : Z85_encode_with_padding_bound(size) + 5;
+}
+
+size_t Z85_decode_with_checksum_bound(const char* source, size_t size)
+{
+   return size < 11 ? 0 : Z85_decode_with_padding_bound(source, size - 5);
+}
+
+size_t Z85_encode_with_checksum(const char* source, char* dest, size_t inputSize)
+{
+   size_t      tailBytes = inputSize % 4;
+   char*       dst       = dest;
+   const char* end       = source + inputSize - tailBytes;
+   uint32_t    crc       = ~0U;
+
+   assert(source && dest);
+
+   // zero length string is not padded
+   if (!source || !dest || inputSize == 0)
+   {
+      return 0;
+   }
+
+   (dst++)[0] = (tailBytes == 0 ? '4' : '0' + (char)tailBytes); // write tail bytes count
+   dst = Z85_encode_crc32c_unsafe(source, end, dst, &crc);      // write body
+   dst = Z85_encode_tail(&z85Alphabet, end, tailBytes, dst);    // write tail
+   crc = crc32cKernel(crc, end, tailBytes);
+   dst = Z85_encode_frame(&z85Alphabet, ~crc, dst);             // write checksum
+
+   return dst - dest;
+}
+
+size_t Z85_decode_with_checksum(const char* source, char* dest, size_t inputSize, size_t* errorPos)
+{
+   char        lastFrames[8]; // tail and checksum
+   size_t      tailBytes;
+   size_t      decoded;
+   const char* end;
+   const char* pos;
+   uint32_t    crc = ~0U;
+
+   Z85_set_error(errorPos, Z85_NPOS);
+
+   if (!source || !dest || inputSize < 11 || (inputSize - 1) % 5)
+   {
+      Z85_set_error(errorPos, (source && dest) ? inputSize : 0);
+      return 0;
+   }
+
+   tailBytes = source[0] - '0'; // possible values: 1, 2, 3 or 4
+   if (tailBytes - 1 > 3)
+   {
+      Z85_set_error(errorPos, 0);
+      return 0;
+   }
+
+   end = source + inputSize - 10;
+   pos = Z85_decode_crc32c_checked(source + 1, end, dest, &crc);
+   if (pos == end)
+   {
+      pos = decodeCheckedKernel(&z85Alphabet, end, end + 10, lastFrames);
+   }
+
+   if (pos != end + 10)
+   {
+      Z85_set_error(errorPos, pos - source);
+      return 0;
+   }
+
+   decoded = Z85_decode_bound(inputSize - 11);
+   memcpy(dest + decoded, lastFrames, tailBytes);
+   crc = crc32cKernel(crc, lastFrames, tailBytes);
+
+   if (~crc != Z85_tail_value(lastFrames + 4, 4))
+   {
+      Z85_set_error(errorPos, inputSize - 5);
+      return 0;
+   }
+
+   return decoded + tailBytes;
+}
+
+
+
+/*******************************************************************************
+ * Instrumentation                                                             *
+ *******************************************************************************/
+
+static const char* const entryPointNames[Z85_ENTRY_COUNT] =
+{
+   "Z85_encode_with_padding",
+   "Z85_decode_with_padding",
+   "Z85_encode_with_trailing_padding",
+   "Z85_decode_with_trailing_padding",
+   "Z85_encode",
+   "Z85_decode",
+   "Z85_encode_unsafe",
+   "Z85_decode_unsafe",
+   "Z85_decode_checked",
+   "Z85_decode_with_padding_checked",
+   "Z85_decode_with_trailing_padding_checked",
+   "Z85_validate",
+   "Z85_encode_wrapped",
+   "Z85_encode_with_padding_wrapped",
+   "Z85_decode_skipping_whitespace",
+   "Z85_decode_with_padding_skipping_whitespace",
+   "Z85_encoder_update",
+   "Z85_encoder_finish",
+   "Z85_decoder_update",
+   "Z85_decoder_finish",
+   "Z85_encode_with_padding_parallel",
+   "Z85_decode_with_padding_parallel",
+   "Z85_encode_parallel",
+   "Z85_decode_parallel",
+   "Z85_encode_with_padding_batch",
+   "Z85_encode_with_padding_columnar",
+   "Z85_encode_with_padding_inplace",
+   "Z85_decode_with_padding_inplace",
+   "Z85_encode_with_trailing_padding_inplace",
+   "Z85_decode_with_trailing_padding_inplace",
+   "Z85_encode_inplace",
+   "Z85_decode_inplace"
+};
+
+const char* Z85_entry_point_name(Z85_entry_point entry)
+{
+   return (size_t)entry < Z85_ENTRY_COUNT ? entryPointNames[entry] : NULL;
+}
+
+#if !defined (Z85_STATS)
+
+int Z85_get_stats(Z85_stats_t* stats)
+{
+   if (stats)
+   {
+      memset(stats, 0, sizeof(Z85_stats_t));
+   }
+
+   return 0;
+}
+
+void Z85_reset_stats(void)
+{
+}
+
+#else
+
+typedef unsigned long long Z85_counter;
+
+#define Z85_COUNTERS (sizeof(Z85_stats_t) / sizeof(Z85_counter))
+
+// counters are summed as a flat array
+typedef char Z85_stats_static_assert[(Z85_COUNTERS * sizeof(Z85_counter) == sizeof(Z85_stats_t)) * 2 - 1];
+typedef char Z85_stats_backends_static_assert[
+   (sizeof(((Z85_stats_t*)0)->backends) / sizeof(Z85_counter) == sizeof(backends) / sizeof(backends[0])) * 2 - 1];
+
+typedef struct Z85_thread_stats
+{
+   Z85_stats_t              stats;
+   struct Z85_thread_stats* next;
+   int                      inUse; // owned by a running thread
+} Z85_thread_stats;
+
+static Z85_thread_stats*          threadStatsList; // blocks of all threads, never freed
+static __thread Z85_thread_stats* threadStats;     // block of the calling thread
+static Z85_stats_t                statsBaseline;   // sums at the last Z85_reset_stats() call
+static char                       statsLock;
+
+// only the owner thread writes its counters, so a plain addition is enough,
+// the relaxed store just makes concurrent reads well defined
+#define Z85_COUNT(counter, value) __atomic_store_n(&(counter), (counter) + (value), __ATOMIC_RELAXED)
+
+#if defined (Z85_THREADS)
+static pthread_key_t  threadStatsKey;
+static pthread_once_t threadStatsOnce = PTHREAD_ONCE_INIT;
+
+// blocks of exited threads are taken over by new threads, their counters keep adding up
+static void Z85_release_thread_stats(void* block)
+{
+   __atomic_store_n(&((Z85_thread_stats*)block)->inUse, 0, __ATOMIC_RELEASE);
+}
+
+static void Z85_create_thread_stats_key(void)
+{
+   pthread_key_create(&threadStatsKey, Z85_release_thread_stats);
+}
+#endif
+
+static Z85_thread_stats* Z85_acquire_thread_stats(void)
+{
+   Z85_thread_stats* block;
+
+   for (block = __atomic_load_n(&threadStatsList, __ATOMIC_ACQUIRE); block; block = block->next)
+   {
+      if (!__atomic_load_n(&block->inUse, __ATOMIC_RELAXED) &&
+          !__atomic_exchange_n(&block->inUse, 1, __ATOMIC_ACQUIRE))
+      {
+         break;
+      }
+   }
+
+   if (!block)
+   {
+      block = (Z85_thread_stats*)calloc(1, sizeof(Z85_thread_stats));
+      if (!block)
+      {
+         return NULL;
+      }
+
+      block->inUse = 1;
+      block->next  = __atomic_load_n(&threadStatsList, __ATOMIC_RELAXED);
+      while (!__atomic_compare_exchange_n(&threadStatsList, &block->next, block, 1,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+      {
+      }
+   }
+
+#if defined (Z85_THREADS)
+   pthread_once(&threadStatsOnce, Z85_create_thread_stats_key);
+   pthread_setspecific(threadStatsKey, block);
+#endif
+
+   threadStats = block;
+   return block;
+}
+
+static Z85_counter Z85_cycles(void)
+{
+#if defined (__x86_64__) || defined (__i386__)
+   return __builtin_ia32_rdtsc();
+#else
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (Z85_counter)now.tv_sec * 1000000000 + now.tv_nsec;
+#endif
+}
+
+static Z85_counter Z85_enter(Z85_entry_point entry, size_t inputSize)
+{
+#if defined (Z85_USDT)
+   DTRACE_PROBE2(z85, entry, entryPointNames[entry], inputSize);
+#else
+   (void)entry;
+   (void)inputSize;
+#endif
+
+   return Z85_cycles();
+}
+
+static void Z85_leave(Z85_entry_point entry, Z85_counter start, size_t inputSize, size_t outputSize,
+                      int error, int padded)
+{
+   Z85_counter        cycles = Z85_cycles() - start;
+   Z85_thread_stats*  block  = threadStats ? threadStats : Z85_acquire_thread_stats();
+   size_t             bucket = inputSize ? 64 - __builtin_clzll((unsigned long long)inputSize) : 0;
+   Z85_entry_stats_t* stats;
+
+#if defined (Z85_USDT)
+   DTRACE_PROBE5(z85, return, entryPointNames[entry], inputSize, outputSize, error, cycles);
+#endif
+
+   if (!block)
+   {
+      return;
+   }
+
+   stats = &block->stats.entries[entry];
+   Z85_COUNT(stats->calls, 1);
+   Z85_COUNT(stats->errors, error != 0);
+   Z85_COUNT(stats->padded, padded != 0);
+   Z85_COUNT(stats->inputBytes, inputSize);
+   Z85_COUNT(stats->outputBytes, outputSize);
+   Z85_COUNT(stats->cycles, cycles);
+   Z85_COUNT(stats->sizes[bucket < Z85_STATS_BUCKETS ? bucket : Z85_STATS_BUCKETS - 1], 1);
+   Z85_COUNT(block->stats.backends[Z85_get_backend()], 1);
+}
+
+// counts a call, which returns output size or 0 on error
+static size_t Z85_leave_sized(Z85_entry_point entry, Z85_counter start, size_t inputSize, size_t result,
+                              int padded)
+{
+   Z85_leave(entry, start, inputSize, result, result == 0 && inputSize != 0, padded);
+   return result;
+}
+
+static size_t Z85_batch_input_size(const Z85_buffer_t* inputs, size_t count)
+{
+   size_t size = 0;
+   size_t i;
+
+   for (i = 0; inputs && i < count; ++i)
+   {
+      size += inputs[i].size;
+   }
+
+   return size;
+}
+
+static void Z85_lock_stats(void)
+{
+   while (__atomic_test_and_set(&statsLock, __ATOMIC_ACQUIRE))
+   {
+   }
+}
+
+static void Z85_unlock_stats(void)
+{
+   __atomic_clear(&statsLock, __ATOMIC_RELEASE);
+}
+
+// sums counters of all threads
+static void Z85_sum_stats(Z85_counter* sums)
+{
+   const Z85_thread_stats* block;
+   const Z85_counter*      counters;
+   size_t                  i;
+
+   memset(sums, 0, sizeof(Z85_stats_t));
+
+   for (block = __atomic_load_n(&threadStatsList, __ATOMIC_ACQUIRE); block; block = block->next)
+   {
+      counters = (const Z85_counter*)&block->stats;
+      for (i = 0; i < Z85_COUNTERS; ++i)
+      {
+         sums[i] += __atomic_load_n(&counters[i], __ATOMIC_RELAXED);
+      }
+   }
+}
+
+int Z85_get_stats(Z85_stats_t* stats)
+{
+   Z85_counter*       sums     = (Z85_counter*)stats;
+   const Z85_counter* baseline = (const Z85_counter*)&statsBaseline;
+   size_t             i;
+
+   if (!stats)
+   {
+      return 1;
+   }
+
+   Z85_lock_stats();
+   Z85_sum_stats(sums);
+   for (i = 0; i < Z85_COUNTERS; ++i)
+   {
+      sums[i] -= baseline[i];
+   }
+   Z85_unlock_stats();
+
+   return 1;
+}
+
+void Z85_reset_stats(void)
+{
+   Z85_lock_stats();
+   Z85_sum_stats((Z85_counter*)&statsBaseline);
+   Z85_unlock_stats();
+}
+
+// public entry points, which count calls of the internal ones
+#undef Z85_encode_with_padding
+#undef Z85_decode_with_padding
+#undef Z85_encode_with_trailing_padding
+#undef Z85_decode_with_trailing_padding
+#undef Z85_encode
+#undef Z85_decode
+#undef Z85_encode_unsafe
+#undef Z85_decode_unsafe
+#undef Z85_decode_checked
+#undef Z85_decode_with_padding_checked
+#undef Z85_decode_with_trailing_padding_checked
+#undef Z85_validate
+#undef Z85_encode_wrapped
+#undef Z85_encode_with_padding_wrapped
+#undef Z85_decode_skipping_whitespace
+#undef Z85_decode_with_padding_skipping_whitespace
+#undef Z85_encoder_update
+#undef Z85_encoder_finish
+#undef Z85_decoder_update
+#undef Z85_decoder_finish
+#undef Z85_encode_with_padding_parallel
+#undef Z85_decode_with_padding_parallel
+#undef Z85_encode_parallel
+#undef Z85_decode_parallel
+#undef Z85_encode_with_padding_batch
+#undef Z85_encode_with_padding_columnar
+#undef Z85_encode_with_padding_inplace
+#undef Z85_decode_with_padding_inplace
+#undef Z85_encode_with_trailing_padding_inplace
+#undef Z85_decode_with_trailing_padding_inplace
+#undef Z85_encode_inplace
+#undef Z85_decode_inplace
+
+size_t Z85_encode_with_padding(const char* source, char* dest, size_t inputSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_ENCODE_WITH_PADDING, inputSize);
+   size_t      result = Z85_encode_with_padding_uncounted(source, dest, inputSize);
+   return Z85_leave_sized(Z85_ENTRY_ENCODE_WITH_PADDING, start, inputSize, result, result && inputSize % 4);
+}
+
+size_t Z85_decode_with_padding(const char* source, char* dest, size_t inputSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_DECODE_WITH_PADDING, inputSize);
+   size_t      result = Z85_decode_with_padding_uncounted(source, dest, inputSize);
+   return Z85_leave_sized(Z85_ENTRY_DECODE_WITH_PADDING, start, inputSize, result, result % 4);
+}
+
+size_t Z85_encode_with_trailing_padding(const char* source, char* dest, size_t inputSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_ENCODE_WITH_TRAILING_PADDING, inputSize);
+   size_t      result = Z85_encode_with_trailing_padding_uncounted(source, dest, inputSize);
+   return Z85_leave_sized(Z85_ENTRY_ENCODE_WITH_TRAILING_PADDING, start, inputSize, result,
+                          result && inputSize % 4);
+}
+
+size_t Z85_decode_with_trailing_padding(const char* source, char* dest, size_t inputSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_DECODE_WITH_TRAILING_PADDING, inputSize);
+   size_t      result = Z85_decode_with_trailing_padding_uncounted(source, dest, inputSize);
+   return Z85_leave_sized(Z85_ENTRY_DECODE_WITH_TRAILING_PADDING, start, inputSize, result, result % 4);
+}
+
+size_t Z85_encode(const char* source, char* dest, size_t inputSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_ENCODE, inputSize);
+   size_t      result = Z85_encode_uncounted(source, dest, inputSize);
+   return Z85_leave_sized(Z85_ENTRY_ENCODE, start, inputSize, result, 0);
+}
+
+size_t Z85_decode(const char* source, char* dest, size_t inputSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_DECODE, inputSize);
+   size_t      result = Z85_decode_uncounted(source, dest, inputSize);
+   return Z85_leave_sized(Z85_ENTRY_DECODE, start, inputSize, result, 0);
+}
+
+char* Z85_encode_unsafe(const char* source, const char* sourceEnd, char* dest)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_ENCODE_UNSAFE, sourceEnd - source);
+   char*       result = Z85_encode_unsafe_uncounted(source, sourceEnd, dest);
+   Z85_leave(Z85_ENTRY_ENCODE_UNSAFE, start, sourceEnd - source, result - dest, 0, 0);
+   return result;
+}
+
+char* Z85_decode_unsafe(const char* source, const char* sourceEnd, char* dest)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_DECODE_UNSAFE, sourceEnd - source);
+   char*       result = Z85_decode_unsafe_uncounted(source, sourceEnd, dest);
+   Z85_leave(Z85_ENTRY_DECODE_UNSAFE, start, sourceEnd - source, result - dest, 0, 0);
+   return result;
+}
+
+size_t Z85_decode_checked(const char* source, char* dest, size_t inputSize, size_t* errorPos)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_DECODE_CHECKED, inputSize);
+   size_t      result = Z85_decode_checked_uncounted(source, dest, inputSize, errorPos);
+   return Z85_leave_sized(Z85_ENTRY_DECODE_CHECKED, start, inputSize, result, 0);
+}
+
+size_t Z85_decode_with_padding_checked(const char* source, char* dest, size_t inputSize, size_t* errorPos)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_DECODE_WITH_PADDING_CHECKED, inputSize);
+   size_t      result = Z85_decode_with_padding_checked_uncounted(source, dest, inputSize, errorPos);
+   return Z85_leave_sized(Z85_ENTRY_DECODE_WITH_PADDING_CHECKED, start, inputSize, result, result % 4);
+}
+
+size_t Z85_decode_with_trailing_padding_checked(const char* source, char* dest, size_t inputSize, size_t* errorPos)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_DECODE_WITH_TRAILING_PADDING_CHECKED, inputSize);
+   size_t      result = Z85_decode_with_trailing_padding_checked_uncounted(source, dest, inputSize, errorPos);
+   return Z85_leave_sized(Z85_ENTRY_DECODE_WITH_TRAILING_PADDING_CHECKED, start, inputSize, result, result % 4);
+}
+
+int Z85_validate(const char* source, size_t inputSize, size_t* errorPos)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_VALIDATE, inputSize);
+   int         result = Z85_validate_uncounted(source, inputSize, errorPos);
+   Z85_leave(Z85_ENTRY_VALIDATE, start, inputSize, 0, !result, 0);
+   return result;
+}
+
+size_t Z85_encode_wrapped(const char* source, char* dest, size_t inputSize, size_t lineLength)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_ENCODE_WRAPPED, inputSize);
+   size_t      result = Z85_encode_wrapped_uncounted(source, dest, inputSize, lineLength);
+   return Z85_leave_sized(Z85_ENTRY_ENCODE_WRAPPED, start, inputSize, result, 0);
+}
+
+size_t Z85_encode_with_padding_wrapped(const char* source, char* dest, size_t inputSize, size_t lineLength)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_ENCODE_WITH_PADDING_WRAPPED, inputSize);
+   size_t      result = Z85_encode_with_padding_wrapped_uncounted(source, dest, inputSize, lineLength);
+   return Z85_leave_sized(Z85_ENTRY_ENCODE_WITH_PADDING_WRAPPED, start, inputSize, result,
+                          result && inputSize % 4);
+}
+
+size_t Z85_decode_skipping_whitespace(const char* source, char* dest, size_t inputSize, size_t* errorPos)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_DECODE_SKIPPING_WHITESPACE, inputSize);
+   size_t      result = Z85_decode_skipping_whitespace_uncounted(source, dest, inputSize, errorPos);
+   return Z85_leave_sized(Z85_ENTRY_DECODE_SKIPPING_WHITESPACE, start, inputSize, result, 0);
+}
+
+size_t Z85_decode_with_padding_skipping_whitespace(const char* source, char* dest, size_t inputSize,
+                                                   size_t* errorPos)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_DECODE_WITH_PADDING_SKIPPING_WHITESPACE, inputSize);
+   size_t      result = Z85_decode_with_padding_skipping_whitespace_uncounted(source, dest, inputSize, errorPos);
+   return Z85_leave_sized(Z85_ENTRY_DECODE_WITH_PADDING_SKIPPING_WHITESPACE, start, inputSize, result, result % 4);
+}
+
+size_t Z85_encoder_update(Z85_encoder_t* encoder, const char* source, char* dest, size_t inputSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_ENCODER_UPDATE, inputSize);
+   size_t      result = Z85_encoder_update_uncounted(encoder, source, dest, inputSize);
+   Z85_leave(Z85_ENTRY_ENCODER_UPDATE, start, inputSize, result, 0, 0);
+   return result;
+}
+
+int Z85_encoder_finish(Z85_encoder_t* encoder, char* dest, size_t* written)
+{
+   size_t      size   = 0;
+   Z85_counter start  = Z85_enter(Z85_ENTRY_ENCODER_FINISH, 0);
+   int         result = Z85_encoder_finish_uncounted(encoder, dest, &size);
+
+   if (written)
+   {
+      *written = size;
+   }
+
+   Z85_leave(Z85_ENTRY_ENCODER_FINISH, start, 0, size, !result, size == 6);
+   return result;
+}
+
+size_t Z85_decoder_update(Z85_decoder_t* decoder, const char* source, char* dest, size_t inputSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_DECODER_UPDATE, inputSize);
+   size_t      result = Z85_decoder_update_uncounted(decoder, source, dest, inputSize);
+   Z85_leave(Z85_ENTRY_DECODER_UPDATE, start, inputSize, result, 0, 0);
+   return result;
+}
+
+int Z85_decoder_finish(Z85_decoder_t* decoder, char* dest, size_t* written)
+{
+   size_t      size   = 0;
+   Z85_counter start  = Z85_enter(Z85_ENTRY_DECODER_FINISH, 0);
+   int         result = Z85_decoder_finish_uncounted(decoder, dest, &size);
+
+   if (written)
+   {
+      *written = size;
+   }
+
+   Z85_leave(Z85_ENTRY_DECODER_FINISH, start, 0, size, !result, size % 4);
+   return result;
+}
+
+size_t Z85_encode_with_padding_parallel(const char* source, char* dest, size_t inputSize,
+                                        size_t threadCount, size_t minChunkSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_ENCODE_WITH_PADDING_PARALLEL, inputSize);
+   size_t      result = Z85_encode_with_padding_parallel_uncounted(source, dest, inputSize,
+                                                                   threadCount, minChunkSize);
+   return Z85_leave_sized(Z85_ENTRY_ENCODE_WITH_PADDING_PARALLEL, start, inputSize, result,
+                          result && inputSize % 4);
+}
+
+size_t Z85_decode_with_padding_parallel(const char* source, char* dest, size_t inputSize,
+                                        size_t threadCount, size_t minChunkSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_DECODE_WITH_PADDING_PARALLEL, inputSize);
+   size_t      result = Z85_decode_with_padding_parallel_uncounted(source, dest, inputSize,
+                                                                   threadCount, minChunkSize);
+   return Z85_leave_sized(Z85_ENTRY_DECODE_WITH_PADDING_PARALLEL, start, inputSize, result, result % 4);
+}
+
+size_t Z85_encode_parallel(const char* source, char* dest, size_t inputSize,
+                           size_t threadCount, size_t minChunkSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_ENCODE_PARALLEL, inputSize);
+   size_t      result = Z85_encode_parallel_uncounted(source, dest, inputSize, threadCount, minChunkSize);
+   return Z85_leave_sized(Z85_ENTRY_ENCODE_PARALLEL, start, inputSize, result, 0);
+}
+
+size_t Z85_decode_parallel(const char* source, char* dest, size_t inputSize,
+                           size_t threadCount, size_t minChunkSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_DECODE_PARALLEL, inputSize);
+   size_t      result = Z85_decode_parallel_uncounted(source, dest, inputSize, threadCount, minChunkSize);
+   return Z85_leave_sized(Z85_ENTRY_DECODE_PARALLEL, start, inputSize, result, 0);
+}
+
+size_t Z85_encode_with_padding_batch(const Z85_buffer_t* inputs, size_t count, char* dest, size_t* offsets)
+{
+   size_t      inputSize = Z85_batch_input_size(inputs, count);
+   Z85_counter start     = Z85_enter(Z85_ENTRY_ENCODE_WITH_PADDING_BATCH, inputSize);
+   size_t      result    = Z85_encode_with_padding_batch_uncounted(inputs, count, dest, offsets);
+   return Z85_leave_sized(Z85_ENTRY_ENCODE_WITH_PADDING_BATCH, start, inputSize, result, 0);
+}
+
+size_t Z85_encode_with_padding_columnar(const char* data, const size_t* inputOffsets, size_t count,
+                                        char* dest, size_t* offsets)
+{
+   size_t      inputSize = inputOffsets && count ? inputOffsets[count] - inputOffsets[0] : 0;
+   Z85_counter start     = Z85_enter(Z85_ENTRY_ENCODE_WITH_PADDING_COLUMNAR, inputSize);
+   size_t      result    = Z85_encode_with_padding_columnar_uncounted(data, inputOffsets, count, dest, offsets);
+   return Z85_leave_sized(Z85_ENTRY_ENCODE_WITH_PADDING_COLUMNAR, start, inputSize, result, 0);
+}
+
+size_t Z85_encode_with_padding_inplace(char* buffer, size_t inputSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_ENCODE_WITH_PADDING_INPLACE, inputSize);
+   size_t      result = Z85_encode_with_padding_inplace_uncounted(buffer, inputSize);
+   return Z85_leave_sized(Z85_ENTRY_ENCODE_WITH_PADDING_INPLACE, start, inputSize, result,
+                          result && inputSize % 4);
+}
+
+size_t Z85_decode_with_padding_inplace(char* buffer, size_t inputSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_DECODE_WITH_PADDING_INPLACE, inputSize);
+   size_t      result = Z85_decode_with_padding_inplace_uncounted(buffer, inputSize);
+   return Z85_leave_sized(Z85_ENTRY_DECODE_WITH_PADDING_INPLACE, start, inputSize, result, result % 4);
+}
+
+size_t Z85_encode_with_trailing_padding_inplace(char* buffer, size_t inputSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_ENCODE_WITH_TRAILING_PADDING_INPLACE, inputSize);
+   size_t      result = Z85_encode_with_trailing_padding_inplace_uncounted(buffer, inputSize);
+   return Z85_leave_sized(Z85_ENTRY_ENCODE_WITH_TRAILING_PADDING_INPLACE, start, inputSize, result,
+                          result && inputSize % 4);
+}
+
+size_t Z85_decode_with_trailing_padding_inplace(char* buffer, size_t inputSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_DECODE_WITH_TRAILING_PADDING_INPLACE, inputSize);
+   size_t      result = Z85_decode_with_trailing_padding_inplace_uncounted(buffer, inputSize);
+   return Z85_leave_sized(Z85_ENTRY_DECODE_WITH_TRAILING_PADDING_INPLACE, start, inputSize, result, result % 4);
+}
+
+size_t Z85_encode_inplace(char* buffer, size_t inputSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_ENCODE_INPLACE, inputSize);
+   size_t      result = Z85_encode_inplace_uncounted(buffer, inputSize);
+   return Z85_leave_sized(Z85_ENTRY_ENCODE_INPLACE, start, inputSize, result, 0);
+}
+
+size_t Z85_decode_inplace(char* buffer, size_t inputSize)
+{
+   Z85_counter start  = Z85_enter(Z85_ENTRY_DECODE_INPLACE, inputSize);
+   size_t      result = Z85_decode_inplace_uncounted(buffer, inputSize);
+   return Z85_leave_sized(Z85_ENTRY_DECODE_INPLACE, start, inputSize, result, 0);
+}
+
+#endif
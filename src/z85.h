@@ -32,6 +32,11 @@
 
 #include <stddef.h>
 
+// Goes before every function, e.g. z85_single.h makes the functions 'static inline' in Z85_STATIC mode
+#if !defined (Z85_API)
+   #define Z85_API
+#endif
+
 #if defined (__cplusplus)
 extern "C" {
 #endif
@@ -51,7 +56,7 @@ extern "C" {
  * @param inputSize in, number of bytes to be encoded
  * @return number of printable symbols written into 'dest' or 0 if something goes wrong
  */
-size_t Z85_encode_with_padding(const char* source, char* dest, size_t inputSize);
+Z85_API size_t Z85_encode_with_padding(const char* source, char* dest, size_t inputSize);
 
 /**
  * @brief Decodes 'inputSize' printable symbols from 'source' into 'dest',
@@ -64,7 +69,7 @@ size_t Z85_encode_with_padding(const char* source, char* dest, size_t inputSize)
  * @param inputSize in, number of symbols to be decoded
  * @return number of bytes written into 'dest' or 0 if something goes wrong
  */
-size_t Z85_decode_with_padding(const char* source, char* dest, size_t inputSize);
+Z85_API size_t Z85_decode_with_padding(const char* source, char* dest, size_t inputSize);
 
 /**
  * @brief Evaluates a size of output buffer needed to encode 'size' bytes
@@ -73,7 +78,7 @@ size_t Z85_decode_with_padding(const char* source, char* dest, size_t inputSize)
  * @param size in, number of bytes to be encoded
  * @return minimal size of output buffer in bytes
  */
-size_t Z85_encode_with_padding_bound(size_t size);
+Z85_API size_t Z85_encode_with_padding_bound(size_t size);
 
 /**
  * @brief Evaluates a size of output buffer needed to decode 'size' symbols
@@ -83,7 +88,64 @@ size_t Z85_encode_with_padding_bound(size_t size);
  * @param size in, number of symbols to be decoded
  * @return minimal size of output buffer in bytes
  */
-size_t Z85_decode_with_padding_bound(const char* source, size_t size);
+Z85_API size_t Z85_decode_with_padding_bound(const char* source, size_t size);
+
+
+
+/*******************************************************************************
+ * ZeroMQ Base-85 encoding/decoding functions with trailing custom padding     *
+ *******************************************************************************/
+
+/**
+ * The same padding as above, but the tail bytes count goes after the encoded data,
+ * e.g. "HelloWorld4" instead of "4HelloWorld". So, the data can be encoded (decoded)
+ * in a single pass without knowing its length in advance, see Z85_encoder_t.
+ */
+
+/**
+ * @brief Encodes 'inputSize' bytes from 'source' into 'dest'.
+ *        If 'inputSize' is not divisible by 4 with no remainder, 'source' is padded.
+ *        Destination buffer must be already allocated. Use Z85_encode_with_trailing_padding_bound() to
+ *        evaluate size of the destination buffer.
+ *
+ * @param source in, input buffer (binary string to be encoded)
+ * @param dest out, destination buffer
+ * @param inputSize in, number of bytes to be encoded
+ * @return number of printable symbols written into 'dest' or 0 if something goes wrong
+ */
+Z85_API size_t Z85_encode_with_trailing_padding(const char* source, char* dest, size_t inputSize);
+
+/**
+ * @brief Decodes 'inputSize' printable symbols from 'source' into 'dest',
+ *        encoded with Z85_encode_with_trailing_padding().
+ *        Destination buffer must be already allocated. Use Z85_decode_with_trailing_padding_bound() to
+ *        evaluate size of the destination buffer.
+ *
+ * @param source in, input buffer (printable string to be decoded)
+ * @param dest out, destination buffer
+ * @param inputSize in, number of symbols to be decoded
+ * @return number of bytes written into 'dest' or 0 if something goes wrong
+ */
+Z85_API size_t Z85_decode_with_trailing_padding(const char* source, char* dest, size_t inputSize);
+
+/**
+ * @brief Evaluates a size of output buffer needed to encode 'size' bytes
+ *        into string of printable symbols using Z85_encode_with_trailing_padding().
+ *
+ * @param size in, number of bytes to be encoded
+ * @return minimal size of output buffer in bytes
+ */
+Z85_API size_t Z85_encode_with_trailing_padding_bound(size_t size);
+
+/**
+ * @brief Evaluates a size of output buffer needed to decode 'size' symbols
+ *        into binary string using Z85_decode_with_trailing_padding().
+ *
+ * @param source in, input buffer (last symbol is read from 'source' to evaluate padding)
+ * @param size in, number of symbols to be decoded
+ * @return minimal size of output buffer in bytes
+ */
+Z85_API size_t Z85_decode_with_trailing_padding_bound(const char* source, size_t size);
 
 
 
@@ -102,7 +164,7 @@ size_t Z85_decode_with_padding_bound(const char* source, size_t size);
  * @param inputSize in, number of bytes to be encoded
  * @return number of printable symbols written into 'dest' or 0 if something goes wrong
  */
-size_t Z85_encode(const char* source, char* dest, size_t inputSize);
+Z85_API size_t Z85_encode(const char* source, char* dest, size_t inputSize);
 
 /**
  * @brief Decodes 'inputSize' printable symbols from 'source' into 'dest'.
@@ -115,7 +177,7 @@ size_t Z85_encode(const char* source, char* dest, size_t inputSize);
  * @param inputSize in, number of symbols to be decoded
  * @return number of bytes written into 'dest' or 0 if something goes wrong
  */
-size_t Z85_decode(const char* source, char* dest, size_t inputSize);
+Z85_API size_t Z85_decode(const char* source, char* dest, size_t inputSize);
 
 /**
  * @brief Evaluates a size of output buffer needed to encode 'size' bytes
@@ -124,7 +186,7 @@ size_t Z85_decode(const char* source, char* dest, size_t inputSize);
  * @param size in, number of bytes to be encoded
  * @return minimal size of output buffer in bytes
  */
-size_t Z85_encode_bound(size_t size);
+Z85_API size_t Z85_encode_bound(size_t size);
 
 /**
  * @brief Evaluates a size of output buffer needed to decode 'size' symbols
@@ -133,7 +195,7 @@ size_t Z85_encode_bound(size_t size);
  * @param size in, number of symbols to be decoded
  * @return minimal size of output buffer in bytes
  */
-size_t Z85_decode_bound(size_t size);
+Z85_API size_t Z85_decode_bound(size_t size);
 
 
 
@@ -153,7 +215,7 @@ size_t Z85_decode_bound(size_t size);
  * @param dest out, output buffer
  * @return a pointer immediately after last symbol written into the 'dest'
  */
-char* Z85_encode_unsafe(const char* source, const char* sourceEnd, char* dest);
+Z85_API char* Z85_encode_unsafe(const char* source, const char* sourceEnd, char* dest);
 
 /**
  * @brief Decodes symbols from [source;sourceEnd) range into 'dest'.
@@ -167,7 +229,832 @@ char* Z85_encode_unsafe(const char* source, const char* sourceEnd, char* dest);
  * @param dest out, output buffer
  * @return a pointer immediately after last byte written into the 'dest'
  */
-char* Z85_decode_unsafe(const char* source, const char* sourceEnd, char* dest);
+Z85_API char* Z85_decode_unsafe(const char* source, const char* sourceEnd, char* dest);
+
+
+
+/*******************************************************************************
+ * ZeroMQ Base-85 checked decoding functions                                   *
+ *******************************************************************************/
+
+/**
+ * Functions above don't check the input: symbols outside of the alphabet and frames
+ * exceeding 2^32 - 1 are silently decoded into garbage. The functions below reject such
+ * input. Validation is fused with decoding, so it doesn't need a separate pass over memory.
+ *
+ * Error position is reported through 'errorPos' (optional, may be NULL):
+ *    - offset of the first invalid symbol;
+ *    - offset of the first symbol of a frame exceeding 2^32 - 1;
+ *    - offset of the tail bytes count if it's wrong (padded functions only);
+ *    - 'inputSize' if the input size is wrong;
+ *    - Z85_NPOS if everything is fine.
+ * Contents of 'dest' is unspecified on error.
+ */
+#define Z85_NPOS ((size_t)-1)
+
+/**
+ * @brief Checked version of Z85_decode().
+ *
+ * @param source in, input buffer (printable string to be decoded)
+ * @param dest out, destination buffer
+ * @param inputSize in, number of symbols to be decoded
+ * @param errorPos out, position of the first error
+ * @return number of bytes written into 'dest' or 0 if something goes wrong
+ */
+Z85_API size_t Z85_decode_checked(const char* source, char* dest, size_t inputSize, size_t* errorPos);
+
+/**
+ * @brief Checked version of Z85_decode_with_padding().
+ */
+Z85_API size_t Z85_decode_with_padding_checked(const char* source, char* dest, size_t inputSize, size_t* errorPos);
+
+/**
+ * @brief Checked version of Z85_decode_with_trailing_padding().
+ */
+Z85_API size_t Z85_decode_with_trailing_padding_checked(const char* source, char* dest, size_t inputSize, size_t* errorPos);
+
+/**
+ * @brief Checks that 'source' can be decoded with Z85_decode_checked() without writing it anywhere.
+ *
+ * @param source in, input buffer (printable string to be checked)
+ * @param inputSize in, number of symbols to be checked
+ * @param errorPos out, position of the first error
+ * @return 1 if 'source' is valid or 0 otherwise
+ */
+Z85_API int Z85_validate(const char* source, size_t inputSize, size_t* errorPos);
+
+
+
+/*******************************************************************************
+ * ZeroMQ Base-85 line wrapped encoding/decoding                               *
+ *******************************************************************************/
+
+/**
+ * Encoded data may be broken into lines for email, config files or logs. Decoding functions
+ * below skip ASCII whitespace (' ', '\t', '\n', '\v', '\f', '\r') anywhere in the input,
+ * so CR/LF line breaks are fine too. None of these symbols is in Z85 alphabet.
+ */
+
+/**
+ * @brief Encodes like Z85_encode(), but puts '\n' after every 'lineLength' symbols,
+ *        the last line isn't terminated. 'lineLength' 0 means no line breaks.
+ *        Use Z85_encode_wrapped_bound() to evaluate size of the destination buffer.
+ *
+ * @return number of symbols written into 'dest' or 0 if something goes wrong
+ */
+Z85_API size_t Z85_encode_wrapped(const char* source, char* dest, size_t inputSize, size_t lineLength);
+
+/**
+ * @brief Encodes like Z85_encode_with_padding(), but breaks lines, see Z85_encode_wrapped().
+ *        Use Z85_encode_with_padding_wrapped_bound() to evaluate size of the destination buffer.
+ */
+Z85_API size_t Z85_encode_with_padding_wrapped(const char* source, char* dest, size_t inputSize, size_t lineLength);
+
+/**
+ * @brief Evaluates a size of output buffer needed to encode 'size' bytes using Z85_encode_wrapped().
+ */
+Z85_API size_t Z85_encode_wrapped_bound(size_t size, size_t lineLength);
+
+/**
+ * @brief Evaluates a size of output buffer needed to encode 'size' bytes using Z85_encode_with_padding_wrapped().
+ */
+Z85_API size_t Z85_encode_with_padding_wrapped_bound(size_t size, size_t lineLength);
+
+/**
+ * @brief Checked version of Z85_decode(), which skips whitespace in 'source'.
+ *        Z85_decode_bound('inputSize') is enough for the destination buffer.
+ *
+ * @param source in, input buffer (printable string to be decoded)
+ * @param dest out, destination buffer
+ * @param inputSize in, number of symbols to be decoded, including whitespace
+ * @param errorPos out, position of the first error in 'source'
+ * @return number of bytes written into 'dest' or 0 if something goes wrong
+ */
+Z85_API size_t Z85_decode_skipping_whitespace(const char* source, char* dest, size_t inputSize, size_t* errorPos);
+
+/**
+ * @brief Checked version of Z85_decode_with_padding(), which skips whitespace in 'source'.
+ *        Z85_decode_bound('inputSize') is enough for the destination buffer.
+ */
+Z85_API size_t Z85_decode_with_padding_skipping_whitespace(const char* source, char* dest, size_t inputSize,
+                                                           size_t* errorPos);
+
+
+
+/*******************************************************************************
+ * ZeroMQ Base-85 streaming encoding/decoding (specification compliant)        *
+ *******************************************************************************/
+
+/**
+ * Stream state, data can be fed in chunks of any size. Bytes (symbols) of an incomplete
+ * frame are carried between calls, everything else goes straight to the bulk kernels,
+ * so the memory footprint doesn't depend on the stream length.
+ * The concatenated output is the same as of Z85_encode() (Z85_decode()) for the whole stream.
+ */
+typedef struct Z85_encoder_t
+{
+   char   tail[4];         /* bytes of the incomplete frame */
+   size_t tailSize;
+   int    trailingPadding; /* Z85_encode_with_trailing_padding() format */
+   int    empty;           /* nothing has been fed yet */
+} Z85_encoder_t;
+
+typedef struct Z85_decoder_t
+{
+   char   tail[6];         /* symbols of the incomplete frame (the last frame and the tail bytes count) */
+   size_t tailSize;
+   int    trailingPadding; /* Z85_encode_with_trailing_padding() format */
+} Z85_decoder_t;
+
+/**
+ * @brief Initializes 'encoder' to start a new stream.
+ */
+Z85_API void Z85_encoder_init(Z85_encoder_t* encoder);
+
+/**
+ * @brief Initializes 'encoder' to start a new stream of Z85_encode_with_trailing_padding() format.
+ *        The stream may have any length, padding is written by Z85_encoder_finish().
+ */
+Z85_API void Z85_encoder_init_with_trailing_padding(Z85_encoder_t* encoder);
+
+/**
+ * @brief Evaluates a size of output buffer needed for Z85_encoder_update() with 'size' bytes.
+ *
+ * @param size in, number of bytes passed to Z85_encoder_update()
+ * @return minimal size of output buffer in bytes
+ */
+Z85_API size_t Z85_encoder_update_bound(size_t size);
+
+/**
+ * @brief Encodes all complete frames of the stream available so far into 'dest'.
+ *        Destination buffer must be already allocated. Use Z85_encoder_update_bound() to
+ *        evaluate size of the destination buffer.
+ *
+ * @param encoder in/out, stream state
+ * @param source in, next chunk of the stream
+ * @param dest out, destination buffer
+ * @param inputSize in, number of bytes in 'source'
+ * @return number of printable symbols written into 'dest'
+ */
+Z85_API size_t Z85_encoder_update(Z85_encoder_t* encoder, const char* source, char* dest, size_t inputSize);
+
+/**
+ * @brief Finishes the stream.
+ *
+ * @param encoder in/out, stream state
+ * @param dest out, destination buffer of at least 6 bytes for the padded stream
+ *             (nothing is written for the specification compliant stream)
+ * @param written out, number of printable symbols written into 'dest'
+ * @return 1 on success or 0 if the specification compliant stream length isn't divisible
+ *         by 4 with no remainder
+ */
+Z85_API int Z85_encoder_finish(Z85_encoder_t* encoder, char* dest, size_t* written);
+
+/**
+ * @brief Initializes 'decoder' to start a new stream.
+ */
+Z85_API void Z85_decoder_init(Z85_decoder_t* decoder);
+
+/**
+ * @brief Initializes 'decoder' to start a new stream of Z85_encode_with_trailing_padding() format.
+ *        The last frame is held back until Z85_decoder_finish().
+ */
+Z85_API void Z85_decoder_init_with_trailing_padding(Z85_decoder_t* decoder);
+
+/**
+ * @brief Evaluates a size of output buffer needed for Z85_decoder_update() with 'size' symbols.
+ *
+ * @param size in, number of symbols passed to Z85_decoder_update()
+ * @return minimal size of output buffer in bytes
+ */
+Z85_API size_t Z85_decoder_update_bound(size_t size);
+
+/**
+ * @brief Decodes all complete frames of the stream available so far into 'dest'.
+ *        Destination buffer must be already allocated. Use Z85_decoder_update_bound() to
+ *        evaluate size of the destination buffer.
+ *
+ * @param decoder in/out, stream state
+ * @param source in, next chunk of the stream
+ * @param dest out, destination buffer
+ * @param inputSize in, number of symbols in 'source'
+ * @return number of bytes written into 'dest'
+ */
+Z85_API size_t Z85_decoder_update(Z85_decoder_t* decoder, const char* source, char* dest, size_t inputSize);
+
+/**
+ * @brief Finishes the stream.
+ *
+ * @param decoder in/out, stream state
+ * @param dest out, destination buffer of at least 4 bytes for the padded stream
+ *             (nothing is written for the specification compliant stream)
+ * @param written out, number of bytes written into 'dest'
+ * @return 1 on success or 0 if the specification compliant stream length isn't divisible
+ *         by 5 with no remainder or the padded stream is malformed
+ */
+Z85_API int Z85_decoder_finish(Z85_decoder_t* decoder, char* dest, size_t* written);
+
+
+
+/*******************************************************************************
+ * Parallel encoding/decoding functions                                        *
+ *******************************************************************************/
+
+/**
+ * The functions below split input on frame boundaries (4 bytes or 5 symbols) and
+ * transcode the chunks in parallel. The output is the same as of their sequential
+ * counterparts. Threads are started per call, so it only pays off for large buffers.
+ *
+ * @param threadCount in, maximal number of threads including the calling one,
+ *                    0 means the number of online CPUs
+ * @param minChunkSize in, minimal number of input bytes per thread, 0 means 1 MiB
+ */
+
+/**
+ * @brief Parallel version of Z85_encode_with_padding().
+ */
+Z85_API size_t Z85_encode_with_padding_parallel(const char* source, char* dest, size_t inputSize,
+                                                size_t threadCount, size_t minChunkSize);
+
+/**
+ * @brief Parallel version of Z85_decode_with_padding().
+ */
+Z85_API size_t Z85_decode_with_padding_parallel(const char* source, char* dest, size_t inputSize,
+                                                size_t threadCount, size_t minChunkSize);
+
+/**
+ * @brief Parallel version of Z85_encode().
+ */
+Z85_API size_t Z85_encode_parallel(const char* source, char* dest, size_t inputSize,
+                                   size_t threadCount, size_t minChunkSize);
+
+/**
+ * @brief Parallel version of Z85_decode().
+ */
+Z85_API size_t Z85_decode_parallel(const char* source, char* dest, size_t inputSize,
+                                   size_t threadCount, size_t minChunkSize);
+
+
+
+/*******************************************************************************
+ * Large buffer mode                                                           *
+ *******************************************************************************/
+
+/**
+ * Buffers much larger than the last level cache gain nothing from going through it, but evict
+ * working sets of other threads and processes sharing the cache. From the threshold size on,
+ * Z85_encode(), Z85_decode(), their padded, unsafe and parallel counterparts transcode by blocks
+ * of a few kilobytes into a buffer in L1 cache and copy them out with non-temporal stores,
+ * the input is prefetched a block ahead into L2 cache (low temporal locality hint, prefetcht2 on x86),
+ * keeping L1 free for the block buffer. Non-x86 CPUs only prefetch.
+ * The output is the same, the mode is off by default.
+ */
+#define Z85_LARGE_BUFFER_OFF ((size_t)-1)
+
+/**
+ * @brief Sets input size, from which the large buffer mode is used.
+ *        It isn't synchronized with encoding/decoding running in other threads, see Z85_set_backend().
+ *
+ * @param size in, number of input bytes (symbols for decoding), Z85_LARGE_BUFFER_OFF disables the mode
+ * @return previous threshold
+ */
+Z85_API size_t Z85_set_large_buffer_threshold(size_t size);
+
+/**
+ * @brief Allocates a buffer on transparent huge pages (Linux), so large inputs and outputs take
+ *        fewer TLB entries. Other systems get malloc().
+ *
+ * @param size in, buffer size in bytes
+ * @return buffer to be freed with Z85_large_buffer_free() or NULL if something goes wrong
+ */
+Z85_API void* Z85_large_buffer_alloc(size_t size);
+
+/**
+ * @brief Frees a buffer allocated with Z85_large_buffer_alloc('size'), NULL is ignored.
+ */
+Z85_API void Z85_large_buffer_free(void* buffer, size_t size);
+
+
+
+/*******************************************************************************
+ * In-place encoding/decoding functions                                        *
+ *******************************************************************************/
+
+/**
+ * The functions below transcode 'inputSize' bytes at the beginning of 'buffer' and leave
+ * the result at the beginning of the same buffer, so large payloads don't need a second buffer.
+ * Encoding needs 'buffer' of the bound size of its counterpart, e.g. Z85_encode_bound(),
+ * decoding just shrinks the data. They always run in the calling thread, the output is
+ * the same as of their out-of-place counterparts.
+ */
+
+/**
+ * @brief In-place version of Z85_encode_with_padding().
+ *        'buffer' must have room for Z85_encode_with_padding_bound('inputSize') bytes.
+ */
+Z85_API size_t Z85_encode_with_padding_inplace(char* buffer, size_t inputSize);
+
+/**
+ * @brief In-place version of Z85_decode_with_padding().
+ */
+Z85_API size_t Z85_decode_with_padding_inplace(char* buffer, size_t inputSize);
+
+/**
+ * @brief In-place version of Z85_encode_with_trailing_padding().
+ *        'buffer' must have room for Z85_encode_with_trailing_padding_bound('inputSize') bytes.
+ */
+Z85_API size_t Z85_encode_with_trailing_padding_inplace(char* buffer, size_t inputSize);
+
+/**
+ * @brief In-place version of Z85_decode_with_trailing_padding().
+ */
+Z85_API size_t Z85_decode_with_trailing_padding_inplace(char* buffer, size_t inputSize);
+
+/**
+ * @brief In-place version of Z85_encode().
+ *        'buffer' must have room for Z85_encode_bound('inputSize') bytes.
+ */
+Z85_API size_t Z85_encode_inplace(char* buffer, size_t inputSize);
+
+/**
+ * @brief In-place version of Z85_decode().
+ */
+Z85_API size_t Z85_decode_inplace(char* buffer, size_t inputSize);
+
+
+
+/*******************************************************************************
+ * Batch encoding functions                                                    *
+ *******************************************************************************/
+
+/**
+ * The functions below encode many small messages in one call, each message the same way as
+ * Z85_encode_with_padding() does. Encoded messages are written back to back into 'dest',
+ * message 'i' takes symbols ['offsets[i]'; 'offsets[i + 1]'), so 'offsets' must have room
+ * for 'count' + 1 entries. Empty messages are encoded as empty strings.
+ * Frames that don't fill the bulk kernels are gathered across messages and encoded together.
+ */
+
+typedef struct Z85_buffer_t
+{
+   const char* data;
+   size_t      size;
+} Z85_buffer_t;
+
+/**
+ * @brief Evaluates a size of output buffer needed to encode 'count' messages from 'inputs'
+ *        using Z85_encode_with_padding_batch().
+ *
+ * @param inputs in, messages to be encoded
+ * @param count in, number of messages
+ * @return minimal size of output buffer in bytes
+ */
+Z85_API size_t Z85_encode_with_padding_batch_bound(const Z85_buffer_t* inputs, size_t count);
+
+/**
+ * @brief Encodes 'count' messages from 'inputs' into 'dest'.
+ *        Destination buffer must be already allocated. Use Z85_encode_with_padding_batch_bound() to
+ *        evaluate size of the destination buffer.
+ *
+ * @param inputs in, messages to be encoded
+ * @param count in, number of messages
+ * @param dest out, destination buffer
+ * @param offsets out, 'count' + 1 offsets of the encoded messages in 'dest'
+ * @return number of printable symbols written into 'dest' or 0 if something goes wrong
+ */
+Z85_API size_t Z85_encode_with_padding_batch(const Z85_buffer_t* inputs, size_t count, char* dest, size_t* offsets);
+
+/**
+ * @brief Evaluates a size of output buffer needed to encode 'count' messages
+ *        using Z85_encode_with_padding_columnar().
+ *
+ * @param inputOffsets in, 'count' + 1 offsets of the messages
+ * @param count in, number of messages
+ * @return minimal size of output buffer in bytes
+ */
+Z85_API size_t Z85_encode_with_padding_columnar_bound(const size_t* inputOffsets, size_t count);
+
+/**
+ * @brief Encodes 'count' messages stored back to back in 'data' (Arrow-like layout) into 'dest',
+ *        message 'i' takes bytes ['inputOffsets[i]'; 'inputOffsets[i + 1]') of 'data'.
+ *        Destination buffer must be already allocated. Use Z85_encode_with_padding_columnar_bound() to
+ *        evaluate size of the destination buffer.
+ *
+ * @param data in, messages to be encoded
+ * @param inputOffsets in, 'count' + 1 offsets of the messages in 'data'
+ * @param count in, number of messages
+ * @param dest out, destination buffer
+ * @param offsets out, 'count' + 1 offsets of the encoded messages in 'dest'
+ * @return number of printable symbols written into 'dest' or 0 if something goes wrong
+ */
+Z85_API size_t Z85_encode_with_padding_columnar(const char* data, const size_t* inputOffsets, size_t count,
+                                                char* dest, size_t* offsets);
+
+
+
+/*******************************************************************************
+ * Custom alphabets                                                            *
+ *******************************************************************************/
+
+/**
+ * The same base-85 transform with another alphabet, e.g. RFC 1924 (IPv6 addresses, git binary
+ * patches). All backends work with any alphabet at the same speed, since their lookup tables are
+ * taken from the alphabet. The padded format is the same as above, i.e. the tail bytes count
+ * is written as '1', '2', '3' or '4' whatever the alphabet is.
+ * Functions of the sections above always use the Z85 alphabet.
+ */
+typedef struct Z85_alphabet_t Z85_alphabet_t;
+
+/**
+ * @brief Returns built-in Z85 alphabet (the one used by all other functions).
+ */
+Z85_API const Z85_alphabet_t* Z85_alphabet_z85(void);
+
+/**
+ * @brief Returns built-in RFC 1924 alphabet: 0-9, A-Z, a-z, !#$%&()*+-;<=>?@^_`{|}~
+ */
+Z85_API const Z85_alphabet_t* Z85_alphabet_rfc1924(void);
+
+/**
+ * @brief Returns built-in Ascii85 alphabet: '!' to 'u' (no 'z' compression, see Z85_ascii85_encode()).
+ */
+Z85_API const Z85_alphabet_t* Z85_alphabet_ascii85(void);
+
+/**
+ * @brief Creates an alphabet from 85 distinct printable ASCII symbols ('!' to '~'),
+ *        'symbols[i]' is the symbol of digit i. All lookup tables are built here,
+ *        so the alphabet is ready to use from any thread.
+ *
+ * @param symbols in, null-terminated string of 85 symbols
+ * @return alphabet to be freed with Z85_alphabet_free() or NULL if 'symbols' is wrong or out of memory
+ */
+Z85_API Z85_alphabet_t* Z85_alphabet_create(const char* symbols);
+
+/**
+ * @brief Frees an alphabet created by Z85_alphabet_create(), NULL is ignored.
+ */
+Z85_API void Z85_alphabet_free(Z85_alphabet_t* alphabet);
+
+/**
+ * @brief Returns null-terminated string of 85 symbols of 'alphabet'.
+ */
+Z85_API const char* Z85_alphabet_symbols(const Z85_alphabet_t* alphabet);
+
+/**
+ * @brief Z85_encode_unsafe() with 'alphabet'.
+ */
+Z85_API char* Z85_alphabet_encode_unsafe(const Z85_alphabet_t* alphabet, const char* source, const char* sourceEnd,
+                                         char* dest);
+
+/**
+ * @brief Z85_decode_unsafe() with 'alphabet'.
+ */
+Z85_API char* Z85_alphabet_decode_unsafe(const Z85_alphabet_t* alphabet, const char* source, const char* sourceEnd,
+                                         char* dest);
+
+/**
+ * @brief Z85_encode() with 'alphabet'.
+ */
+Z85_API size_t Z85_alphabet_encode(const Z85_alphabet_t* alphabet, const char* source, char* dest, size_t inputSize);
+
+/**
+ * @brief Z85_decode() with 'alphabet'.
+ */
+Z85_API size_t Z85_alphabet_decode(const Z85_alphabet_t* alphabet, const char* source, char* dest, size_t inputSize);
+
+/**
+ * @brief Z85_encode_with_padding() with 'alphabet'.
+ */
+Z85_API size_t Z85_alphabet_encode_with_padding(const Z85_alphabet_t* alphabet, const char* source, char* dest,
+                                                size_t inputSize);
+
+/**
+ * @brief Z85_decode_with_padding() with 'alphabet'.
+ */
+Z85_API size_t Z85_alphabet_decode_with_padding(const Z85_alphabet_t* alphabet, const char* source, char* dest,
+                                                size_t inputSize);
+
+/**
+ * @brief Z85_decode_checked() with 'alphabet', symbols out of 'alphabet' are errors.
+ */
+Z85_API size_t Z85_alphabet_decode_checked(const Z85_alphabet_t* alphabet, const char* source, char* dest,
+                                           size_t inputSize, size_t* errorPos);
+
+/**
+ * @brief Z85_decode_with_padding_checked() with 'alphabet', symbols out of 'alphabet' are errors.
+ */
+Z85_API size_t Z85_alphabet_decode_with_padding_checked(const Z85_alphabet_t* alphabet, const char* source, char* dest,
+                                                        size_t inputSize, size_t* errorPos);
+
+
+
+/*******************************************************************************
+ * Ascii85 encoding/decoding                                                   *
+ *******************************************************************************/
+
+/**
+ * Adobe Ascii85 (btoa) format: Z85_alphabet_ascii85() symbols, an all-zero group of 4 bytes
+ * is written as a single 'z', the last group of 1-3 bytes is padded with zeros and written
+ * as 2-4 symbols. Runs of zero groups are found with 8 byte compares and skipped at once,
+ * the rest goes through the same kernels as Z85, so sparse data is encoded faster, not slower.
+ * Whitespace isn't allowed in the input of the decoder.
+ */
+typedef enum Z85_ascii85_flags
+{
+   Z85_ASCII85_FRAMED = 1, /* "<~" and "~>" around the data, the decoder requires "~>" */
+   Z85_ASCII85_SPACES = 2  /* a group of 4 spaces is written as 'y' (btoa 4.2) */
+} Z85_ascii85_flags;
+
+/**
+ * @brief Evaluates a size of output buffer needed to encode 'size' bytes with Z85_ascii85_encode().
+ *
+ * @param size in, number of bytes to be encoded
+ * @return minimal size of output buffer in bytes (including framing)
+ */
+Z85_API size_t Z85_ascii85_encode_bound(size_t size);
+
+/**
+ * @brief Evaluates a size of output buffer needed to decode 'size' symbols with Z85_ascii85_decode(),
+ *        every symbol may stand for 4 bytes.
+ *
+ * @param size in, number of symbols to be decoded
+ * @return minimal size of output buffer in bytes
+ */
+Z85_API size_t Z85_ascii85_decode_bound(size_t size);
+
+/**
+ * @brief Encodes 'inputSize' bytes from 'source' into 'dest' in Ascii85 format.
+ *
+ * @param source in, input buffer (binary string to be encoded)
+ * @param dest out, destination buffer of Z85_ascii85_encode_bound('inputSize') bytes
+ * @param inputSize in, number of bytes to be encoded
+ * @param flags in, combination of Z85_ascii85_flags
+ * @return number of printable symbols written into 'dest' or 0 if something goes wrong
+ */
+Z85_API size_t Z85_ascii85_encode(const char* source, char* dest, size_t inputSize, int flags);
+
+/**
+ * @brief Decodes 'inputSize' symbols of Ascii85 format from 'source' into 'dest'. Leading "<~" and
+ *        trailing "~>" are skipped. 'y' is accepted with Z85_ASCII85_SPACES flag only.
+ *        Errors are reported as by Z85_decode_checked(): invalid symbols ('z' or 'y' inside
+ *        a group too), overflowing groups, 'inputSize' if the last group is a single symbol
+ *        or "~>" is missing while Z85_ASCII85_FRAMED is set.
+ *
+ * @param source in, input buffer (printable string to be decoded)
+ * @param dest out, destination buffer of Z85_ascii85_decode_bound('inputSize') bytes
+ * @param inputSize in, number of symbols to be decoded
+ * @param flags in, combination of Z85_ascii85_flags
+ * @param errorPos out, position of the first error (optional, may be NULL)
+ * @return number of bytes written into 'dest' or 0 if something goes wrong
+ */
+Z85_API size_t Z85_ascii85_decode(const char* source, char* dest, size_t inputSize, int flags, size_t* errorPos);
+
+
+
+/*******************************************************************************
+ * Checksums                                                                   *
+ *******************************************************************************/
+
+/**
+ * CRC32C (Castagnoli polynomial, as in iSCSI, ext4 and SSE4.2 crc32 instruction) of the binary
+ * data is computed in the same pass as encoding/decoding: the data is transcoded by blocks of
+ * a few kilobytes and every block is checksummed while it's still in L1 cache, so it's read
+ * from memory once. x86 CPUs with SSE4.2 use crc32 instruction, others use 8K of tables.
+ * Checksums are chained: start with 0 and pass the result of the previous piece to continue,
+ * e.g. Z85_crc32c(Z85_crc32c(0, a, aSize), b, bSize) is a checksum of 'a' followed by 'b'.
+ */
+
+/**
+ * @brief Computes CRC32C of 'size' bytes of 'data'.
+ *
+ * @param crc in, checksum of the preceding data or 0
+ * @param data in, input buffer
+ * @param size in, number of bytes in 'data'
+ * @return updated checksum
+ */
+Z85_API unsigned int Z85_crc32c(unsigned int crc, const char* data, size_t size);
+
+/**
+ * @brief Z85_encode(), which updates CRC32C of 'source' at the same time.
+ *
+ * @param source in, input buffer (binary string to be encoded)
+ * @param dest out, destination buffer
+ * @param inputSize in, number of bytes to be encoded
+ * @param crc in/out, checksum of the preceding data or 0, is updated if the input is valid
+ * @return number of printable symbols written into 'dest' or 0 if something goes wrong
+ */
+Z85_API size_t Z85_encode_crc32c(const char* source, char* dest, size_t inputSize, unsigned int* crc);
+
+/**
+ * @brief Z85_decode(), which updates CRC32C of the decoded data at the same time.
+ *
+ * @param source in, input buffer (printable string to be decoded)
+ * @param dest out, destination buffer
+ * @param inputSize in, number of symbols to be decoded
+ * @param crc in/out, checksum of the preceding data or 0, is updated if the input is valid
+ * @return number of bytes written into 'dest' or 0 if something goes wrong
+ */
+Z85_API size_t Z85_decode_crc32c(const char* source, char* dest, size_t inputSize, unsigned int* crc);
+
+/**
+ * @brief Evaluates a size of output buffer needed to encode 'size' bytes with Z85_encode_with_checksum().
+ *
+ * @param size in, number of bytes to be encoded
+ * @return minimal size of output buffer in bytes
+ */
+Z85_API size_t Z85_encode_with_checksum_bound(size_t size);
+
+/**
+ * @brief Evaluates a size of output buffer needed to decode 'size' symbols from 'source'
+ *        with Z85_decode_with_checksum().
+ *
+ * @param source in, input buffer (first symbol is read only)
+ * @param size in, number of symbols to be decoded
+ * @return minimal size of output buffer in bytes
+ */
+Z85_API size_t Z85_decode_with_checksum_bound(const char* source, size_t size);
+
+/**
+ * @brief Encodes 'inputSize' bytes as Z85_encode_with_padding() does and appends their CRC32C
+ *        as one more frame (5 symbols, big-endian), e.g. "4HelloWorld" becomes "4HelloWorldD%InE".
+ *
+ * @param source in, input buffer (binary string to be encoded)
+ * @param dest out, destination buffer
+ * @param inputSize in, number of bytes to be encoded
+ * @return number of printable symbols written into 'dest' or 0 if something goes wrong
+ */
+Z85_API size_t Z85_encode_with_checksum(const char* source, char* dest, size_t inputSize);
+
+/**
+ * @brief Decodes the output of Z85_encode_with_checksum() and verifies the checksum.
+ *        Invalid symbols are reported as by Z85_decode_with_padding_checked(), a checksum
+ *        mismatch at the position of the checksum frame ('inputSize' - 5).
+ *
+ * @param source in, input buffer (printable string to be decoded)
+ * @param dest out, destination buffer
+ * @param inputSize in, number of symbols to be decoded
+ * @param errorPos out, position of the first error (optional, may be NULL)
+ * @return number of bytes written into 'dest' or 0 if something goes wrong
+ */
+Z85_API size_t Z85_decode_with_checksum(const char* source, char* dest, size_t inputSize, size_t* errorPos);
+
+
+
+/*******************************************************************************
+ * Backend selection                                                           *
+ *******************************************************************************/
+
+/**
+ * Kernels used by all encoding/decoding functions above.
+ * By default the best backend supported by the CPU is picked when the library is loaded
+ * (GCC and Clang) or on the first call, either way safely for any number of threads.
+ * Z85_BACKEND environment variable ("scalar", "word64", "pairs", "sse4.1", "avx2" or "auto")
+ * overrides the default choice.
+ */
+typedef enum Z85_backend
+{
+   Z85_BACKEND_AUTO   = 0, /* the best backend supported by the CPU */
+   Z85_BACKEND_SCALAR = 1, /* portable C loops */
+   Z85_BACKEND_SSE41  = 2, /* SSE4.1 decoding, pair table encoding */
+   Z85_BACKEND_AVX2   = 3, /* AVX2 encoding and decoding */
+   Z85_BACKEND_PAIRS  = 4, /* portable C loops, which look up two symbols at once */
+   Z85_BACKEND_WORD64 = 5  /* portable C loops, which transcode two frames at once */
+} Z85_backend;
+
+/**
+ * @brief Forces all encoding/decoding functions to use 'backend'.
+ *        It isn't synchronized with encoding/decoding running in other threads,
+ *        so call it before any of them start.
+ *
+ * @param backend in, backend to use, Z85_BACKEND_AUTO picks the best one
+ * @return 1 on success or 0 if 'backend' isn't supported by the CPU or isn't compiled in
+ */
+Z85_API int Z85_set_backend(Z85_backend backend);
+
+/**
+ * @brief The same as Z85_set_backend(), but takes backend name (see Z85_backend_name()).
+ *
+ * @param name in, backend name
+ * @return 1 on success or 0 if backend is unknown or isn't supported
+ */
+Z85_API int Z85_set_backend_by_name(const char* name);
+
+/**
+ * @brief Returns backend used by encoding/decoding functions, never Z85_BACKEND_AUTO.
+ */
+Z85_API Z85_backend Z85_get_backend(void);
+
+/**
+ * @brief Returns human readable name of 'backend' or NULL if it's unknown.
+ */
+Z85_API const char* Z85_backend_name(Z85_backend backend);
+
+/**
+ * @brief Returns the number of bytes of lookup tables touched by 'backend' on valid input,
+ *        i.e. its share of L1 data cache. Table driven backends are faster on their own,
+ *        but may lose when the caller's working set competes for L1.
+ *
+ * @param backend in, backend, Z85_BACKEND_AUTO stands for the current one
+ * @return table size or 0 if 'backend' isn't supported
+ */
+Z85_API size_t Z85_backend_table_size(Z85_backend backend);
+
+
+
+/*******************************************************************************
+ * Instrumentation                                                             *
+ *******************************************************************************/
+
+/**
+ * When the library is compiled with Z85_STATS defined (Z85_STATS CMake option), every call
+ * of the functions below from outside of the library is counted by per-thread counters,
+ * which the calling threads update without locks. Nested calls (e.g. Z85_encode() calls
+ * Z85_encode_parallel()) are counted once. On Linux, "z85:entry" and "z85:return" USDT probes
+ * are placed around the calls, if <sys/sdt.h> is available:
+ *
+ *    entry:  arg0 - function name, arg1 - input size
+ *    return: arg0 - function name, arg1 - input size, arg2 - output size, arg3 - 1 on error,
+ *            arg4 - cycles spent in the call
+ *
+ * Without Z85_STATS all of it is compiled out and Z85_get_stats() reports nothing.
+ */
+typedef enum Z85_entry_point
+{
+   Z85_ENTRY_ENCODE_WITH_PADDING,
+   Z85_ENTRY_DECODE_WITH_PADDING,
+   Z85_ENTRY_ENCODE_WITH_TRAILING_PADDING,
+   Z85_ENTRY_DECODE_WITH_TRAILING_PADDING,
+   Z85_ENTRY_ENCODE,
+   Z85_ENTRY_DECODE,
+   Z85_ENTRY_ENCODE_UNSAFE,
+   Z85_ENTRY_DECODE_UNSAFE,
+   Z85_ENTRY_DECODE_CHECKED,
+   Z85_ENTRY_DECODE_WITH_PADDING_CHECKED,
+   Z85_ENTRY_DECODE_WITH_TRAILING_PADDING_CHECKED,
+   Z85_ENTRY_VALIDATE,
+   Z85_ENTRY_ENCODE_WRAPPED,
+   Z85_ENTRY_ENCODE_WITH_PADDING_WRAPPED,
+   Z85_ENTRY_DECODE_SKIPPING_WHITESPACE,
+   Z85_ENTRY_DECODE_WITH_PADDING_SKIPPING_WHITESPACE,
+   Z85_ENTRY_ENCODER_UPDATE,
+   Z85_ENTRY_ENCODER_FINISH,
+   Z85_ENTRY_DECODER_UPDATE,
+   Z85_ENTRY_DECODER_FINISH,
+   Z85_ENTRY_ENCODE_WITH_PADDING_PARALLEL,
+   Z85_ENTRY_DECODE_WITH_PADDING_PARALLEL,
+   Z85_ENTRY_ENCODE_PARALLEL,
+   Z85_ENTRY_DECODE_PARALLEL,
+   Z85_ENTRY_ENCODE_WITH_PADDING_BATCH,
+   Z85_ENTRY_ENCODE_WITH_PADDING_COLUMNAR,
+   Z85_ENTRY_ENCODE_WITH_PADDING_INPLACE,
+   Z85_ENTRY_DECODE_WITH_PADDING_INPLACE,
+   Z85_ENTRY_ENCODE_WITH_TRAILING_PADDING_INPLACE,
+   Z85_ENTRY_DECODE_WITH_TRAILING_PADDING_INPLACE,
+   Z85_ENTRY_ENCODE_INPLACE,
+   Z85_ENTRY_DECODE_INPLACE,
+   Z85_ENTRY_COUNT
+} Z85_entry_point;
+
+/* bucket 0 counts empty inputs, bucket 'i' counts inputs of [2^(i-1); 2^i) bytes,
+   the last bucket counts all larger inputs too */
+#define Z85_STATS_BUCKETS 41
+
+typedef struct Z85_entry_stats_t
+{
+   unsigned long long calls;
+   unsigned long long errors;      /* calls, which failed */
+   unsigned long long padded;      /* calls, which encoded or decoded a partial frame */
+   unsigned long long inputBytes;
+   unsigned long long outputBytes;
+   unsigned long long cycles;      /* time stamp counter on x86, nanoseconds elsewhere */
+   unsigned long long sizes[Z85_STATS_BUCKETS]; /* log2 histogram of input sizes */
+} Z85_entry_stats_t;
+
+typedef struct Z85_stats_t
+{
+   Z85_entry_stats_t  entries[Z85_ENTRY_COUNT];
+   unsigned long long backends[6]; /* calls by the backend, which served them (see Z85_backend) */
+} Z85_stats_t;
+
+/**
+ * @brief Sums counters of all threads since the last Z85_reset_stats() call.
+ *        Counters updated concurrently may be a few calls behind.
+ *
+ * @param stats out, counters, zeroed if instrumentation isn't compiled in
+ * @return 1 if instrumentation is compiled in, otherwise 0
+ */
+Z85_API int Z85_get_stats(Z85_stats_t* stats);
+
+/**
+ * @brief Starts counting from zero. Counters of other threads aren't touched,
+ *        so the calls in flight aren't lost.
+ */
+Z85_API void Z85_reset_stats(void);
+
+/**
+ * @brief Returns function name of 'entry' (e.g. "Z85_encode") or NULL if it's unknown.
+ */
+Z85_API const char* Z85_entry_point_name(Z85_entry_point entry);
 
 #if defined (__cplusplus)
 }
@@ -32,6 +32,25 @@
 
 #include <stddef.h>
 #include <string>
+#include <vector>
+
+#if __cplusplus > 199711L // if C++11
+   #include <array>
+   #include <stdint.h>
+
+   #include "z85_tables.hpp"
+#endif
+
+#if __cplusplus >= 202002L
+   #include <span>
+#endif
+
+#if __cplusplus >= 201703L && defined (__has_include)
+   #if __has_include(<memory_resource>)
+      #include <memory_resource>
+      #include <string_view>
+   #endif
+#endif
 
 // Used to forbid implicit std::string construction from const char*
 #if __cplusplus > 199711L // if C++11
@@ -40,8 +59,18 @@
    #define Z85_DELETE_FUNCTION_DEFINITION
 #endif
 
+// see z85.h
+typedef struct Z85_alphabet_t Z85_alphabet_t;
+
+// z85_single.h puts the C++ API into an unnamed namespace in Z85_STATIC mode
+#if !defined (Z85_CPP_API_BEGIN)
+   #define Z85_CPP_API_BEGIN
+   #define Z85_CPP_API_END
+#endif
+
 namespace z85
 {
+Z85_CPP_API_BEGIN
 
 /*******************************************************************************
  * ZeroMQ Base-85 encoding/decoding functions with custom padding              *
@@ -60,6 +89,24 @@ std::string encode_with_padding(const std::string& source);
 
 std::string encode_with_padding(const char*) Z85_DELETE_FUNCTION_DEFINITION;
 
+/**
+ * @brief The same as encode_with_padding() above, but doesn't allocate a new string.
+ *        The result is appended to 'dest' string or vector, reusing their capacity,
+ *        or written to 'dest' buffer of 'destSize' bytes (nothing is written if it's too small).
+ *
+ * @return number of symbols appended/written, 0 on error
+ */
+size_t encode_with_padding(const char* source, size_t inputSize, std::string& dest);
+size_t encode_with_padding(const char* source, size_t inputSize, std::vector<char>& dest);
+size_t encode_with_padding(const char* source, size_t inputSize, char* dest, size_t destSize);
+
+#if defined (__cpp_lib_span)
+inline size_t encode_with_padding(std::span<const char> source, std::span<char> dest)
+{
+   return encode_with_padding(source.data(), source.size(), dest.data(), dest.size());
+}
+#endif
+
 /**
  * @brief Decodes 'inputSize' printable symbols from 'source',
  *        encoded with encode_with_padding().
@@ -73,6 +120,99 @@ std::string decode_with_padding(const std::string& source);
 
 std::string decode_with_padding(const char*) Z85_DELETE_FUNCTION_DEFINITION;
 
+/**
+ * @brief The same as decode_with_padding() above, but appends to 'dest' or writes to 'dest' buffer,
+ *        see encode_with_padding(const char*, size_t, std::string&).
+ *
+ * @return number of bytes appended/written, 0 on error
+ */
+size_t decode_with_padding(const char* source, size_t inputSize, std::string& dest);
+size_t decode_with_padding(const char* source, size_t inputSize, std::vector<char>& dest);
+size_t decode_with_padding(const char* source, size_t inputSize, char* dest, size_t destSize);
+
+#if defined (__cpp_lib_span)
+inline size_t decode_with_padding(std::span<const char> source, std::span<char> dest)
+{
+   return decode_with_padding(source.data(), source.size(), dest.data(), dest.size());
+}
+#endif
+
+/**
+ * @brief Encodes each of 'sources' with encode_with_padding() in a single call,
+ *        see Z85_encode_with_padding_batch(). Encoded messages are appended to 'dest',
+ *        message 'i' takes symbols ['offsets[i]'; 'offsets[i + 1]') of 'dest'.
+ *
+ * @return number of symbols appended
+ */
+size_t encode_with_padding_batch(const std::vector<std::string>& sources, std::string& dest,
+                                 std::vector<size_t>& offsets);
+
+
+/*******************************************************************************
+ * ZeroMQ Base-85 encoding/decoding functions with trailing custom padding     *
+ *******************************************************************************/
+
+/**
+ * @brief Encodes 'inputSize' bytes from 'source'.
+ *        If 'inputSize' is not divisible by 4 with no remainder, 'source' is padded.
+ *        Tail bytes count goes after the encoded data, see Z85_encode_with_trailing_padding().
+ *
+ * @param source in, input buffer (binary string to be encoded)
+ * @param inputSize in, number of bytes to be encoded
+ * @return printable string
+ */
+std::string encode_with_trailing_padding(const char* source, size_t inputSize);
+std::string encode_with_trailing_padding(const std::string& source);
+
+std::string encode_with_trailing_padding(const char*) Z85_DELETE_FUNCTION_DEFINITION;
+
+/**
+ * @brief The same as encode_with_trailing_padding() above, but appends to 'dest' or writes to 'dest' buffer,
+ *        see encode_with_padding(const char*, size_t, std::string&).
+ *
+ * @return number of symbols appended/written, 0 on error
+ */
+size_t encode_with_trailing_padding(const char* source, size_t inputSize, std::string& dest);
+size_t encode_with_trailing_padding(const char* source, size_t inputSize, std::vector<char>& dest);
+size_t encode_with_trailing_padding(const char* source, size_t inputSize, char* dest, size_t destSize);
+
+#if defined (__cpp_lib_span)
+inline size_t encode_with_trailing_padding(std::span<const char> source, std::span<char> dest)
+{
+   return encode_with_trailing_padding(source.data(), source.size(), dest.data(), dest.size());
+}
+#endif
+
+/**
+ * @brief Decodes 'inputSize' printable symbols from 'source',
+ *        encoded with encode_with_trailing_padding().
+ *
+ * @param source in, input buffer (printable string to be decoded)
+ * @param inputSize in, number of symbols to be decoded
+ * @return decoded string
+ */
+std::string decode_with_trailing_padding(const char* source, size_t inputSize);
+std::string decode_with_trailing_padding(const std::string& source);
+
+std::string decode_with_trailing_padding(const char*) Z85_DELETE_FUNCTION_DEFINITION;
+
+/**
+ * @brief The same as decode_with_trailing_padding() above, but appends to 'dest' or writes to 'dest' buffer,
+ *        see encode_with_padding(const char*, size_t, std::string&).
+ *
+ * @return number of bytes appended/written, 0 on error
+ */
+size_t decode_with_trailing_padding(const char* source, size_t inputSize, std::string& dest);
+size_t decode_with_trailing_padding(const char* source, size_t inputSize, std::vector<char>& dest);
+size_t decode_with_trailing_padding(const char* source, size_t inputSize, char* dest, size_t destSize);
+
+#if defined (__cpp_lib_span)
+inline size_t decode_with_trailing_padding(std::span<const char> source, std::span<char> dest)
+{
+   return decode_with_trailing_padding(source.data(), source.size(), dest.data(), dest.size());
+}
+#endif
+
 
 /*******************************************************************************
  * ZeroMQ Base-85 encoding/decoding functions (specification compliant)        *
@@ -91,6 +231,23 @@ std::string encode(const std::string& source);
 
 std::string encode(const char*) Z85_DELETE_FUNCTION_DEFINITION;
 
+/**
+ * @brief The same as encode() above, but appends to 'dest' or writes to 'dest' buffer,
+ *        see encode_with_padding(const char*, size_t, std::string&).
+ *
+ * @return number of symbols appended/written, 0 on error
+ */
+size_t encode(const char* source, size_t inputSize, std::string& dest);
+size_t encode(const char* source, size_t inputSize, std::vector<char>& dest);
+size_t encode(const char* source, size_t inputSize, char* dest, size_t destSize);
+
+#if defined (__cpp_lib_span)
+inline size_t encode(std::span<const char> source, std::span<char> dest)
+{
+   return encode(source.data(), source.size(), dest.data(), dest.size());
+}
+#endif
+
 /**
  * @brief Decodes 'inputSize' printable symbols from 'source'.
  *        If 'inputSize' is not divisible by 5 with no remainder, empty string is returned.
@@ -104,6 +261,597 @@ std::string decode(const std::string& source);
 
 std::string decode(const char*) Z85_DELETE_FUNCTION_DEFINITION;
 
+/**
+ * @brief The same as decode() above, but appends to 'dest' or writes to 'dest' buffer,
+ *        see encode_with_padding(const char*, size_t, std::string&).
+ *
+ * @return number of bytes appended/written, 0 on error
+ */
+size_t decode(const char* source, size_t inputSize, std::string& dest);
+size_t decode(const char* source, size_t inputSize, std::vector<char>& dest);
+size_t decode(const char* source, size_t inputSize, char* dest, size_t destSize);
+
+#if defined (__cpp_lib_span)
+inline size_t decode(std::span<const char> source, std::span<char> dest)
+{
+   return decode(source.data(), source.size(), dest.data(), dest.size());
+}
+#endif
+
+
+
+/*******************************************************************************
+ * Parallel encoding/decoding functions                                        *
+ *******************************************************************************/
+
+/**
+ * Parallel versions of the functions above, see Z85_encode_parallel() for details.
+ *
+ * @param threadCount in, maximal number of threads, 0 means the number of online CPUs
+ * @param minChunkSize in, minimal number of input bytes per thread, 0 means 1 MiB
+ */
+std::string encode_with_padding_parallel(const char* source, size_t inputSize,
+                                         size_t threadCount = 0, size_t minChunkSize = 0);
+std::string encode_with_padding_parallel(const std::string& source,
+                                         size_t threadCount = 0, size_t minChunkSize = 0);
+
+std::string encode_with_padding_parallel(const char*) Z85_DELETE_FUNCTION_DEFINITION;
+
+std::string decode_with_padding_parallel(const char* source, size_t inputSize,
+                                         size_t threadCount = 0, size_t minChunkSize = 0);
+std::string decode_with_padding_parallel(const std::string& source,
+                                         size_t threadCount = 0, size_t minChunkSize = 0);
+
+std::string decode_with_padding_parallel(const char*) Z85_DELETE_FUNCTION_DEFINITION;
+
+std::string encode_parallel(const char* source, size_t inputSize,
+                            size_t threadCount = 0, size_t minChunkSize = 0);
+std::string encode_parallel(const std::string& source,
+                            size_t threadCount = 0, size_t minChunkSize = 0);
+
+std::string encode_parallel(const char*) Z85_DELETE_FUNCTION_DEFINITION;
+
+std::string decode_parallel(const char* source, size_t inputSize,
+                            size_t threadCount = 0, size_t minChunkSize = 0);
+std::string decode_parallel(const std::string& source,
+                            size_t threadCount = 0, size_t minChunkSize = 0);
+
+std::string decode_parallel(const char*) Z85_DELETE_FUNCTION_DEFINITION;
+
+
+
+/*******************************************************************************
+ * In-place encoding/decoding functions                                        *
+ *******************************************************************************/
+
+/**
+ * In-place versions of the functions above, see Z85_encode_inplace() for details.
+ * 'buffer' is resized to the output size, encoding doesn't reallocate it if its capacity
+ * is already enough, e.g. after reserve(Z85_encode_bound(size)).
+ *
+ * @return output size or 0 if something goes wrong ('buffer' is left unchanged)
+ */
+size_t encode_with_padding_inplace(std::string& buffer);
+size_t decode_with_padding_inplace(std::string& buffer);
+
+size_t encode_with_trailing_padding_inplace(std::string& buffer);
+size_t decode_with_trailing_padding_inplace(std::string& buffer);
+
+size_t encode_inplace(std::string& buffer);
+size_t decode_inplace(std::string& buffer);
+
+
+
+/*******************************************************************************
+ * Custom alphabets                                                            *
+ *******************************************************************************/
+
+/**
+ * Versions of the functions above with another alphabet, see Z85_alphabet_create().
+ * Built-in alphabets are returned by Z85_alphabet_z85() and Z85_alphabet_rfc1924().
+ */
+std::string encode_with_padding(const Z85_alphabet_t* alphabet, const std::string& source);
+std::string decode_with_padding(const Z85_alphabet_t* alphabet, const std::string& source);
+
+std::string encode(const Z85_alphabet_t* alphabet, const std::string& source);
+std::string decode(const Z85_alphabet_t* alphabet, const std::string& source);
+
+/**
+ * Owns an alphabet created from 85 symbols, it converts to 'const Z85_alphabet_t*',
+ * so it can be passed to the functions above. Check valid() after construction.
+ */
+class alphabet
+{
+public:
+   explicit alphabet(const char* symbols);
+   ~alphabet();
+
+   bool valid() const { return m_alphabet != NULL; }
+   operator const Z85_alphabet_t*() const { return m_alphabet; }
+
+private:
+   alphabet(const alphabet&) Z85_DELETE_FUNCTION_DEFINITION;
+   alphabet& operator=(const alphabet&) Z85_DELETE_FUNCTION_DEFINITION;
+
+   Z85_alphabet_t* m_alphabet;
+};
+
+
+
+/*******************************************************************************
+ * Ascii85 encoding/decoding                                                   *
+ *******************************************************************************/
+
+/**
+ * @brief Encodes 'source' in Ascii85 format, see Z85_ascii85_encode().
+ *
+ * @param source in, binary string to be encoded
+ * @param flags in, combination of Z85_ascii85_flags
+ * @return printable string
+ */
+std::string ascii85_encode(const std::string& source, int flags = 0);
+
+/**
+ * @brief Decodes 'source' encoded in Ascii85 format, see Z85_ascii85_decode().
+ *
+ * @param source in, printable string to be decoded
+ * @param flags in, combination of Z85_ascii85_flags
+ * @return decoded string, empty on error
+ */
+std::string ascii85_decode(const std::string& source, int flags = 0);
+
+
+
+/*******************************************************************************
+ * Checksums                                                                   *
+ *******************************************************************************/
+
+/**
+ * @brief Encodes 'source' with padding and appends its CRC32C, see Z85_encode_with_checksum().
+ *
+ * @param source in, binary string to be encoded
+ * @return printable string
+ */
+std::string encode_with_checksum(const std::string& source);
+
+/**
+ * @brief Decodes 'source' encoded with encode_with_checksum() and verifies the checksum.
+ *
+ * @param source in, printable string to be decoded
+ * @return decoded string, empty on invalid input or checksum mismatch
+ */
+std::string decode_with_checksum(const std::string& source);
+
+
+
+/*******************************************************************************
+ * Allocator-aware encoding/decoding functions                                 *
+ *******************************************************************************/
+
+namespace detail
+{
+
+// exact output size (an upper bound for decode_with_trailing_padding()),
+// 0 on wrong input: NULL, wrong length or tail bytes count
+size_t encode_with_padding_size(const char* source, size_t inputSize);
+size_t decode_with_padding_size(const char* source, size_t inputSize);
+size_t encode_with_trailing_padding_size(const char* source, size_t inputSize);
+size_t decode_with_trailing_padding_size(const char* source, size_t inputSize);
+size_t encode_size(const char* source, size_t inputSize);
+size_t decode_size(const char* source, size_t inputSize);
+
+typedef size_t (*size_fn)(const char* source, size_t inputSize);
+typedef size_t (*transcode_fn)(const char* source, size_t inputSize, char* dest, size_t destSize);
+
+// Output adapter, which appends to basic_string, skipping zero-initialization where the library
+// allows: write(bound, fn) lets 'fn' write at most 'bound' bytes and returns the number of bytes
+// 'fn' has written (0 leaves the string unchanged). z85_impl.cpp uses it for std::string.
+template<typename Traits, typename Alloc>
+class string_output
+{
+   std::basic_string<char, Traits, Alloc>& m_dest;
+
+public:
+   explicit string_output(std::basic_string<char, Traits, Alloc>& dest) : m_dest(dest) {}
+
+   template<typename Fn>
+   size_t write(size_t bound, Fn fn)
+   {
+      const size_t oldSize = m_dest.size();
+      size_t written = 0;
+
+#if defined (__cpp_lib_string_resize_and_overwrite)
+      m_dest.resize_and_overwrite(oldSize + bound, [&](char* p, size_t)
+      {
+         written = fn(p + oldSize);
+         return oldSize + written;
+      });
+#else
+      m_dest.resize(oldSize + bound);
+      written = fn(&m_dest[0] + oldSize);
+      m_dest.resize(oldSize + written);
+#endif
+
+      return written;
+   }
+};
+
+// 'fn' of string_output::write(), which runs 'transcode' into at most 'bound' bytes
+struct transcode_call
+{
+   const char*  source;
+   size_t       inputSize;
+   size_t       bound;
+   transcode_fn transcode;
+
+   size_t operator()(char* dest) const
+   {
+      return transcode(source, inputSize, dest, bound);
+   }
+};
+
+template<typename Traits, typename Alloc>
+size_t append(const char* source, size_t inputSize, std::basic_string<char, Traits, Alloc>& dest,
+              size_fn size, transcode_fn transcode)
+{
+   const size_t bound = size(source, inputSize);
+   if (bound == 0)
+   {
+      return 0;
+   }
+
+   const transcode_call call = { source, inputSize, bound, transcode };
+   return string_output<Traits, Alloc>(dest).write(bound, call);
+}
+
+} // namespace detail
+
+/**
+ * The functions above for strings with any traits and allocator, e.g. the result goes to
+ * an arena instead of the global heap. Appending versions take the allocator from 'dest':
+ *
+ *    size_t encode(const char* source, size_t inputSize, basic_string<char, Traits, Alloc>& dest);
+ *
+ * Returning versions take the string type and its allocator:
+ *
+ *    my_string text = z85::encode<my_string>(source, inputSize, alloc);
+ *
+ * @return number of symbols/bytes appended, 0 on error; or the string, empty on error
+ */
+template<typename Traits, typename Alloc>
+size_t encode_with_padding(const char* source, size_t inputSize, std::basic_string<char, Traits, Alloc>& dest)
+{
+   return detail::append(source, inputSize, dest, detail::encode_with_padding_size, encode_with_padding);
+}
+
+template<typename Traits, typename Alloc>
+size_t decode_with_padding(const char* source, size_t inputSize, std::basic_string<char, Traits, Alloc>& dest)
+{
+   return detail::append(source, inputSize, dest, detail::decode_with_padding_size, decode_with_padding);
+}
+
+template<typename Traits, typename Alloc>
+size_t encode_with_trailing_padding(const char* source, size_t inputSize,
+                                    std::basic_string<char, Traits, Alloc>& dest)
+{
+   return detail::append(source, inputSize, dest, detail::encode_with_trailing_padding_size,
+                         encode_with_trailing_padding);
+}
+
+template<typename Traits, typename Alloc>
+size_t decode_with_trailing_padding(const char* source, size_t inputSize,
+                                    std::basic_string<char, Traits, Alloc>& dest)
+{
+   return detail::append(source, inputSize, dest, detail::decode_with_trailing_padding_size,
+                         decode_with_trailing_padding);
+}
+
+template<typename Traits, typename Alloc>
+size_t encode(const char* source, size_t inputSize, std::basic_string<char, Traits, Alloc>& dest)
+{
+   return detail::append(source, inputSize, dest, detail::encode_size, encode);
+}
+
+template<typename Traits, typename Alloc>
+size_t decode(const char* source, size_t inputSize, std::basic_string<char, Traits, Alloc>& dest)
+{
+   return detail::append(source, inputSize, dest, detail::decode_size, decode);
+}
+
+template<typename String>
+String encode_with_padding(const char* source, size_t inputSize,
+                           const typename String::allocator_type& alloc = typename String::allocator_type())
+{
+   String result(alloc);
+   encode_with_padding(source, inputSize, result);
+   return result;
+}
+
+template<typename String>
+String decode_with_padding(const char* source, size_t inputSize,
+                           const typename String::allocator_type& alloc = typename String::allocator_type())
+{
+   String result(alloc);
+   decode_with_padding(source, inputSize, result);
+   return result;
+}
+
+template<typename String>
+String encode_with_trailing_padding(const char* source, size_t inputSize,
+                                    const typename String::allocator_type& alloc = typename String::allocator_type())
+{
+   String result(alloc);
+   encode_with_trailing_padding(source, inputSize, result);
+   return result;
+}
+
+template<typename String>
+String decode_with_trailing_padding(const char* source, size_t inputSize,
+                                    const typename String::allocator_type& alloc = typename String::allocator_type())
+{
+   String result(alloc);
+   decode_with_trailing_padding(source, inputSize, result);
+   return result;
+}
+
+template<typename String>
+String encode(const char* source, size_t inputSize,
+              const typename String::allocator_type& alloc = typename String::allocator_type())
+{
+   String result(alloc);
+   encode(source, inputSize, result);
+   return result;
+}
+
+template<typename String>
+String decode(const char* source, size_t inputSize,
+              const typename String::allocator_type& alloc = typename String::allocator_type())
+{
+   String result(alloc);
+   decode(source, inputSize, result);
+   return result;
+}
+
+#if defined (__cpp_lib_memory_resource)
+
+namespace detail
+{
+
+inline std::string_view transcode_view(const char* source, size_t inputSize, std::pmr::memory_resource* resource,
+                                       size_fn size, transcode_fn transcode)
+{
+   const size_t bound = size(source, inputSize);
+   if (bound == 0)
+   {
+      return std::string_view();
+   }
+
+   char* const dest = static_cast<char*>(resource->allocate(bound, 1));
+   const size_t written = transcode(source, inputSize, dest, bound);
+   return written ? std::string_view(dest, written) : std::string_view();
+}
+
+} // namespace detail
+
+/**
+ * std::pmr::string versions of the functions above, the string allocates from 'resource'.
+ */
+inline std::pmr::string encode_with_padding(const char* source, size_t inputSize, std::pmr::memory_resource* resource)
+{
+   return encode_with_padding<std::pmr::string>(source, inputSize, resource);
+}
+
+inline std::pmr::string decode_with_padding(const char* source, size_t inputSize, std::pmr::memory_resource* resource)
+{
+   return decode_with_padding<std::pmr::string>(source, inputSize, resource);
+}
+
+inline std::pmr::string encode_with_trailing_padding(const char* source, size_t inputSize,
+                                                     std::pmr::memory_resource* resource)
+{
+   return encode_with_trailing_padding<std::pmr::string>(source, inputSize, resource);
+}
+
+inline std::pmr::string decode_with_trailing_padding(const char* source, size_t inputSize,
+                                                     std::pmr::memory_resource* resource)
+{
+   return decode_with_trailing_padding<std::pmr::string>(source, inputSize, resource);
+}
+
+inline std::pmr::string encode(const char* source, size_t inputSize, std::pmr::memory_resource* resource)
+{
+   return encode<std::pmr::string>(source, inputSize, resource);
+}
+
+inline std::pmr::string decode(const char* source, size_t inputSize, std::pmr::memory_resource* resource)
+{
+   return decode<std::pmr::string>(source, inputSize, resource);
+}
+
+/**
+ * @brief Writes the output to a block allocated from 'resource' and returns a view of it.
+ *        The block is never deallocated, it's meant for arenas like std::pmr::monotonic_buffer_resource,
+ *        which free everything at once, e.g. at the end of a request.
+ *
+ * @return view of the output, empty on error (nothing is allocated if the length
+ *         or the tail bytes count is wrong)
+ */
+inline std::string_view encode_with_padding_view(const char* source, size_t inputSize,
+                                                 std::pmr::memory_resource* resource)
+{
+   return detail::transcode_view(source, inputSize, resource, detail::encode_with_padding_size, encode_with_padding);
+}
+
+inline std::string_view decode_with_padding_view(const char* source, size_t inputSize,
+                                                 std::pmr::memory_resource* resource)
+{
+   return detail::transcode_view(source, inputSize, resource, detail::decode_with_padding_size, decode_with_padding);
+}
+
+inline std::string_view encode_view(const char* source, size_t inputSize, std::pmr::memory_resource* resource)
+{
+   return detail::transcode_view(source, inputSize, resource, detail::encode_size, encode);
+}
+
+inline std::string_view decode_view(const char* source, size_t inputSize, std::pmr::memory_resource* resource)
+{
+   return detail::transcode_view(source, inputSize, resource, detail::decode_size, decode);
+}
+
+#endif // __cpp_lib_memory_resource
+
+
+#if __cplusplus > 199711L // if C++11
+
+/*******************************************************************************
+ * Fixed size encoding/decoding functions                                      *
+ *******************************************************************************/
+
+namespace detail
+{
+
+inline void encode_frame(const uint8_t* src, char* dst)
+{
+   const char* base85 = z85::detail::tables<>::base85; // shared, not in Z85_CPP_API_BEGIN
+   uint32_t value = ((uint32_t)src[0] << 24) | ((uint32_t)src[1] << 16) | ((uint32_t)src[2] << 8) | src[3];
+
+   dst[4] = base85[value % 85]; value /= 85;
+   dst[3] = base85[value % 85]; value /= 85;
+   dst[2] = base85[value % 85]; value /= 85;
+   dst[1] = base85[value % 85]; value /= 85;
+   dst[0] = base85[value];
+}
+
+inline void decode_frame(const char* src, uint8_t* dst)
+{
+   const unsigned char* base256 = z85::detail::tables<>::base256;
+   uint32_t value;
+
+   value =              base256[((unsigned char)src[0] - 32) & 127];
+   value = value * 85 + base256[((unsigned char)src[1] - 32) & 127];
+   value = value * 85 + base256[((unsigned char)src[2] - 32) & 127];
+   value = value * 85 + base256[((unsigned char)src[3] - 32) & 127];
+   value = value * 85 + base256[((unsigned char)src[4] - 32) & 127];
+
+   dst[0] = (uint8_t)(value >> 24);
+   dst[1] = (uint8_t)(value >> 16);
+   dst[2] = (uint8_t)(value >> 8);
+   dst[3] = (uint8_t)value;
+}
+
+// unrolls 'Count' frames at compile time
+template<size_t Count>
+struct frames
+{
+   static void encode(const uint8_t* src, char* dst)
+   {
+      encode_frame(src, dst);
+      frames<Count - 1>::encode(src + 4, dst + 5);
+   }
+
+   static void decode(const char* src, uint8_t* dst)
+   {
+      decode_frame(src, dst);
+      frames<Count - 1>::decode(src + 5, dst + 4);
+   }
+};
+
+template<>
+struct frames<0>
+{
+   static void encode(const uint8_t*, char*) {}
+   static void decode(const char*, uint8_t*) {}
+};
+
+} // namespace detail
+
+/**
+ * String of 'N' symbols stored in place, so it doesn't allocate.
+ * It's zero terminated, but symbols are left uninitialized by default constructor.
+ */
+template<size_t N>
+class fixed_string
+{
+   char m_data[N + 1];
+
+public:
+   fixed_string()
+   {
+      m_data[N] = '\0';
+   }
+
+   static constexpr size_t size() { return N; }
+
+   char*       data()        { return m_data; }
+   const char* data()  const { return m_data; }
+   const char* c_str() const { return m_data; }
+
+   char*       begin()       { return m_data; }
+   const char* begin() const { return m_data; }
+   char*       end()         { return m_data + N; }
+   const char* end()   const { return m_data + N; }
+
+   char&       operator[](size_t i)       { return m_data[i]; }
+   const char& operator[](size_t i) const { return m_data[i]; }
+
+   std::string str() const { return std::string(m_data, N); }
+};
+
+template<size_t N>
+bool operator==(const fixed_string<N>& a, const fixed_string<N>& b)
+{
+   return std::string::traits_type::compare(a.data(), b.data(), N) == 0;
+}
+
+template<size_t N>
+bool operator!=(const fixed_string<N>& a, const fixed_string<N>& b)
+{
+   return !(a == b);
+}
+
+/**
+ * @brief Encodes 'N' bytes, 'N' must be divisible by 4. All frames are unrolled
+ *        at compile time, e.g. encode<32>() encodes a CURVE key without loops and allocations.
+ *
+ * @param source in, bytes to be encoded
+ * @return printable string of N / 4 * 5 symbols
+ */
+template<size_t N>
+fixed_string<N / 4 * 5> encode(const std::array<uint8_t, N>& source)
+{
+   static_assert(N % 4 == 0, "input size must be divisible by 4");
+
+   fixed_string<N / 4 * 5> result;
+   detail::frames<N / 4>::encode(source.data(), result.data());
+   return result;
+}
+
+/**
+ * @brief Decodes 'M' symbols, 'M' must be divisible by 5. All frames are unrolled
+ *        at compile time. Input isn't validated, use Z85_validate() for untrusted input.
+ *
+ * @param source in, printable string of 'M' symbols
+ * @return M / 5 * 4 decoded bytes
+ */
+template<size_t M>
+std::array<uint8_t, M / 5 * 4> decode(const char* source)
+{
+   static_assert(M % 5 == 0, "input size must be divisible by 5");
+
+   std::array<uint8_t, M / 5 * 4> result;
+   detail::frames<M / 5>::decode(source, result.data());
+   return result;
+}
+
+template<size_t M>
+std::array<uint8_t, M / 5 * 4> decode(const fixed_string<M>& source)
+{
+   return decode<M>(source.data());
+}
+
+#endif // C++11
+
+Z85_CPP_API_END
 } // namespace z85
 
 #undef Z85_DELETE_FUNCTION_DEFINITION
@@ -0,0 +1,246 @@
+/*
+ * Copyright 2013 Stanislav Artemkin <artemkin@gmail.com>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Implementation of 32/Z85 specification (http://rfc.zeromq.org/spec:32/Z85)
+ * Source repository: http://github.com/artemkin/z85
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#if defined (__cpp_consteval)
+   #include <array>
+   #include <cstddef>
+#endif
+
+// Header-only constexpr encoding/decoding kernels (C++14 or later).
+// They follow portable loops of z85.c and can run at compile time,
+// e.g. to embed ZeroMQ CURVE keys as Z85 text without decoding them at startup:
+//
+//    using namespace z85::literals;
+//    constexpr auto key = "rq:rM>}U?@Lns47E1%kR.o@n%FcmmsL/@{H8]yf7"_z85; // std::array<std::byte, 32>
+//
+// Run time code should prefer functions from z85.h, which use SIMD kernels.
+
+#if __cplusplus >= 201402L
+
+#include "z85_tables.hpp"
+
+namespace z85
+{
+
+// 'ct' stands for 'compile time'
+namespace ct
+{
+
+namespace detail
+{
+
+// returns digit of 'symbol' or -1 if 'symbol' isn't from the alphabet
+constexpr int digit(char symbol)
+{
+   for (int i = 0; i < 85; ++i)
+   {
+      if (z85::detail::tables<>::base85[i] == symbol)
+      {
+         return i;
+      }
+   }
+   return -1;
+}
+
+// isn't constexpr, so calling it during constant evaluation is a compile error
+inline void invalid_z85_literal() {}
+
+} // namespace detail
+
+/**
+ * @brief Encodes [source;sourceEnd) range of bytes into 'dest', see Z85_encode_unsafe().
+ *        'Byte' is char, unsigned char or std::byte.
+ *
+ * @return a pointer immediately after the last symbol written into 'dest'
+ */
+template<typename Byte>
+constexpr char* encode_unsafe(const Byte* source, const Byte* sourceEnd, char* dest)
+{
+   for (; source != sourceEnd; source += 4, dest += 5)
+   {
+      // unpack big-endian frame
+      unsigned long value = ((unsigned long)static_cast<unsigned char>(source[0]) << 24) |
+                            ((unsigned long)static_cast<unsigned char>(source[1]) << 16) |
+                            ((unsigned long)static_cast<unsigned char>(source[2]) << 8)  |
+                             (unsigned long)static_cast<unsigned char>(source[3]);
+
+      for (int i = 4; i >= 0; --i)
+      {
+         dest[i] = z85::detail::tables<>::base85[value % 85];
+         value /= 85;
+      }
+   }
+
+   return dest;
+}
+
+/**
+ * @brief Decodes [source;sourceEnd) range of symbols into 'dest', see Z85_decode_unsafe().
+ *        Invalid symbols are decoded as zeros.
+ *
+ * @return a pointer immediately after the last byte written into 'dest'
+ */
+template<typename Byte>
+constexpr Byte* decode_unsafe(const char* source, const char* sourceEnd, Byte* dest)
+{
+   for (; source != sourceEnd; source += 5, dest += 4)
+   {
+      unsigned long value = 0;
+      for (int i = 0; i < 5; ++i)
+      {
+         const int digit = detail::digit(source[i]);
+         value = value * 85 + (digit < 0 ? 0 : digit);
+      }
+
+      // pack big-endian frame
+      dest[0] = static_cast<Byte>((value >> 24) & 0xFF);
+      dest[1] = static_cast<Byte>((value >> 16) & 0xFF);
+      dest[2] = static_cast<Byte>((value >> 8) & 0xFF);
+      dest[3] = static_cast<Byte>(value & 0xFF);
+   }
+
+   return dest;
+}
+
+/**
+ * @brief Decodes [source;sourceEnd) range of symbols into 'dest' until the first invalid
+ *        symbol or the first frame exceeding 2^32 - 1, see Z85_decode_checked().
+ *
+ * @return a pointer to the invalid symbol, to the beginning of the invalid frame
+ *         or 'sourceEnd' if everything is decoded
+ */
+template<typename Byte>
+constexpr const char* decode_checked(const char* source, const char* sourceEnd, Byte* dest)
+{
+   for (; source != sourceEnd; source += 5, dest += 4)
+   {
+      unsigned long long value = 0;
+      for (int i = 0; i < 5; ++i)
+      {
+         const int digit = detail::digit(source[i]);
+         if (digit < 0)
+         {
+            return source + i;
+         }
+         value = value * 85 + digit;
+      }
+
+      if (value > 0xFFFFFFFFULL)
+      {
+         return source;
+      }
+
+      // pack big-endian frame
+      dest[0] = static_cast<Byte>((value >> 24) & 0xFF);
+      dest[1] = static_cast<Byte>((value >> 16) & 0xFF);
+      dest[2] = static_cast<Byte>((value >> 8) & 0xFF);
+      dest[3] = static_cast<Byte>(value & 0xFF);
+   }
+
+   return sourceEnd;
+}
+
+// consteval makes sure invalid literals are compile errors, a run time call couldn't report them
+#if defined (__cpp_consteval)
+
+/**
+ * @brief Decodes string literal 'text' at compile time (C++20). Bad length or invalid symbols
+ *        (including frames exceeding 2^32 - 1) are compile errors.
+ *
+ * @return decoded bytes
+ */
+template<size_t N>
+consteval std::array<std::byte, (N - 1) / 5 * 4> decode_literal(const char (&text)[N])
+{
+   static_assert(N > 0 && (N - 1) % 5 == 0, "Z85 literal length must be divisible by 5");
+
+   std::array<std::byte, (N - 1) / 5 * 4> result{};
+
+   if (decode_checked(text, text + N - 1, result.data()) != text + N - 1)
+   {
+      detail::invalid_z85_literal();
+   }
+
+   return result;
+}
+
+#endif // consteval
+
+} // namespace ct
+
+#if defined (__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+
+namespace ct
+{
+namespace detail
+{
+
+// string literal as a template argument
+template<size_t N>
+struct literal
+{
+   char text[N];
+
+   constexpr literal(const char (&source)[N])
+      : text()
+   {
+      for (size_t i = 0; i < N; ++i)
+      {
+         text[i] = source[i];
+      }
+   }
+};
+
+} // namespace detail
+} // namespace ct
+
+namespace literals
+{
+
+/**
+ * @brief Decodes Z85 literal at compile time: "HelloWorld"_z85 is std::array<std::byte, 8>.
+ */
+template<ct::detail::literal Text>
+consteval auto operator""_z85()
+{
+   return ct::decode_literal(Text.text);
+}
+
+} // namespace literals
+
+#endif // class type template arguments
+
+} // namespace z85
+
+#endif // C++14
@@ -37,105 +37,623 @@
 
 namespace z85
 {
+Z85_CPP_API_BEGIN
 
-std::string encode_with_padding(const char* source, size_t inputSize)
+namespace
+{
+
+/*******************************************************************************
+ * Output adapters: each one provides write(bound, fn), which lets 'fn' write   *
+ * at most 'bound' bytes and returns the number of bytes 'fn' has written      *
+ *******************************************************************************/
+
+// Appends to std::string, shared with the allocator-aware functions of z85.hpp
+typedef detail::string_output<std::char_traits<char>, std::allocator<char> > string_output;
+
+class vector_output
+{
+   std::vector<char>& m_dest;
+
+public:
+   explicit vector_output(std::vector<char>& dest) : m_dest(dest) {}
+
+   template<typename Fn>
+   size_t write(size_t bound, Fn fn)
+   {
+      const size_t oldSize = m_dest.size();
+
+      m_dest.resize(oldSize + bound);
+      const size_t written = fn(&m_dest[0] + oldSize);
+      m_dest.resize(oldSize + written);
+
+      return written;
+   }
+};
+
+// Writes to caller's buffer, nothing is written if the buffer is too small
+class buffer_output
+{
+   char*  m_dest;
+   size_t m_destSize;
+
+public:
+   buffer_output(char* dest, size_t destSize) : m_dest(dest), m_destSize(destSize) {}
+
+   template<typename Fn>
+   size_t write(size_t bound, Fn fn)
+   {
+      return (m_dest && bound <= m_destSize) ? fn(m_dest) : 0;
+   }
+};
+
+/*******************************************************************************
+ * Encoding/decoding to any output                                             *
+ *******************************************************************************/
+
+template<typename Output>
+size_t encode_with_padding_to(const char* source, size_t inputSize, Output out,
+                              size_t threadCount, size_t minChunkSize)
 {
    if (!source || inputSize == 0)
    {
-      return std::string();
+      return 0;
    }
 
-   std::string buf;
-   buf.resize(Z85_encode_with_padding_bound(inputSize));
+   const size_t bound = Z85_encode_with_padding_bound(inputSize);
 
-   const size_t encodedBytes = Z85_encode_with_padding(source, &buf[0], inputSize);
-   assert(encodedBytes == buf.size()); (void)encodedBytes;
+   return out.write(bound, [&](char* dest)
+   {
+      const size_t encodedBytes = Z85_encode_with_padding_parallel(source, dest, inputSize, threadCount, minChunkSize);
+      assert(encodedBytes == bound); (void)encodedBytes;
+      return bound;
+   });
+}
 
-   return buf;
+template<typename Output>
+size_t decode_with_padding_to(const char* source, size_t inputSize, Output out,
+                              size_t threadCount, size_t minChunkSize)
+{
+   if (!source || inputSize == 0)
+   {
+      return 0;
+   }
+
+   const size_t bound = Z85_decode_with_padding_bound(source, inputSize);
+   if (bound == 0)
+   {
+      assert(!"wrong padding");
+      return 0;
+   }
+
+   return out.write(bound, [&](char* dest)
+   {
+      return Z85_decode_with_padding_parallel(source, dest, inputSize, threadCount, minChunkSize);
+   });
 }
 
-std::string encode_with_padding(const std::string& source)
+template<typename Output>
+size_t encode_with_trailing_padding_to(const char* source, size_t inputSize, Output out)
 {
-   return encode_with_padding(source.c_str(), source.size());
+   if (!source || inputSize == 0)
+   {
+      return 0;
+   }
+
+   const size_t bound = Z85_encode_with_trailing_padding_bound(inputSize);
+
+   return out.write(bound, [&](char* dest)
+   {
+      const size_t encodedBytes = Z85_encode_with_trailing_padding(source, dest, inputSize);
+      assert(encodedBytes == bound); (void)encodedBytes;
+      return bound;
+   });
 }
 
-std::string decode_with_padding(const char* source, size_t inputSize)
+template<typename Output>
+size_t decode_with_trailing_padding_to(const char* source, size_t inputSize, Output out)
 {
    if (!source || inputSize == 0)
    {
-      return std::string();
+      return 0;
    }
 
-   const size_t bufSize = Z85_decode_with_padding_bound(source, inputSize);
-   if (bufSize == 0)
+   const size_t bound = Z85_decode_with_trailing_padding_bound(source, inputSize);
+   if (bound == 0)
    {
       assert(!"wrong padding");
-      return std::string();
+      return 0;
    }
 
-   std::string buf;
-   buf.resize(bufSize);
+   return out.write(bound, [&](char* dest)
+   {
+      const size_t decodedBytes = Z85_decode_with_trailing_padding(source, dest, inputSize);
+      assert(decodedBytes != 0 && "wrong input size");
+      return decodedBytes;
+   });
+}
 
-   const size_t decodedBytes = Z85_decode_with_padding(source, &buf[0], inputSize);
-   assert(decodedBytes == buf.size()); (void)decodedBytes;
+template<typename Output>
+size_t encode_to(const char* source, size_t inputSize, Output out,
+                 size_t threadCount, size_t minChunkSize)
+{
+   if (!source || inputSize == 0)
+   {
+      return 0;
+   }
 
-   return buf;
+   return out.write(Z85_encode_bound(inputSize), [&](char* dest)
+   {
+      const size_t encodedBytes = Z85_encode_parallel(source, dest, inputSize, threadCount, minChunkSize);
+      assert(encodedBytes != 0 && "wrong input size");
+      return encodedBytes;
+   });
 }
 
-std::string decode_with_padding(const std::string& source)
+template<typename Output>
+size_t decode_to(const char* source, size_t inputSize, Output out,
+                 size_t threadCount, size_t minChunkSize)
 {
-   return decode_with_padding(source.c_str(), source.size());
+   if (!source || inputSize == 0)
+   {
+      return 0;
+   }
+
+   return out.write(Z85_decode_bound(inputSize), [&](char* dest)
+   {
+      const size_t decodedBytes = Z85_decode_parallel(source, dest, inputSize, threadCount, minChunkSize);
+      assert(decodedBytes != 0 && "wrong input size");
+      return decodedBytes;
+   });
 }
 
-std::string encode(const char* source, size_t inputSize)
+} // namespace
+
+std::string encode_with_padding(const char* source, size_t inputSize)
 {
-   if (!source || inputSize == 0)
+   return encode_with_padding_parallel(source, inputSize, 1, 0);
+}
+
+std::string encode_with_padding(const std::string& source)
+{
+   return encode_with_padding(source.c_str(), source.size());
+}
+
+size_t encode_with_padding(const char* source, size_t inputSize, std::string& dest)
+{
+   return encode_with_padding_to(source, inputSize, string_output(dest), 1, 0);
+}
+
+size_t encode_with_padding(const char* source, size_t inputSize, std::vector<char>& dest)
+{
+   return encode_with_padding_to(source, inputSize, vector_output(dest), 1, 0);
+}
+
+size_t encode_with_padding(const char* source, size_t inputSize, char* dest, size_t destSize)
+{
+   return encode_with_padding_to(source, inputSize, buffer_output(dest, destSize), 1, 0);
+}
+
+size_t encode_with_padding_batch(const std::vector<std::string>& sources, std::string& dest,
+                                 std::vector<size_t>& offsets)
+{
+   std::vector<Z85_buffer_t> inputs(sources.size());
+   for (size_t i = 0; i < sources.size(); ++i)
    {
-      return std::string();
+      inputs[i].data = sources[i].data();
+      inputs[i].size = sources[i].size();
    }
 
-   std::string buf;
-   buf.resize(Z85_encode_bound(inputSize));
+   const size_t oldSize = dest.size();
+   const size_t bound   = Z85_encode_with_padding_batch_bound(inputs.data(), inputs.size());
 
-   const size_t encodedBytes = Z85_encode(source, &buf[0], inputSize);
-   if (encodedBytes == 0)
+   offsets.resize(inputs.size() + 1);
+
+   const size_t written = string_output(dest).write(bound, [&](char* p)
+   {
+      return Z85_encode_with_padding_batch(inputs.data(), inputs.size(), p, offsets.data());
+   });
+
+   // the C API offsets start from the appended part
+   for (size_t i = 0; i < offsets.size(); ++i)
    {
-      assert(!"wrong input size");
-      return std::string();
+      offsets[i] += oldSize;
    }
 
+   return written;
+}
+
+std::string decode_with_padding(const char* source, size_t inputSize)
+{
+   return decode_with_padding_parallel(source, inputSize, 1, 0);
+}
+
+std::string decode_with_padding(const std::string& source)
+{
+   return decode_with_padding(source.c_str(), source.size());
+}
+
+size_t decode_with_padding(const char* source, size_t inputSize, std::string& dest)
+{
+   return decode_with_padding_to(source, inputSize, string_output(dest), 1, 0);
+}
+
+size_t decode_with_padding(const char* source, size_t inputSize, std::vector<char>& dest)
+{
+   return decode_with_padding_to(source, inputSize, vector_output(dest), 1, 0);
+}
+
+size_t decode_with_padding(const char* source, size_t inputSize, char* dest, size_t destSize)
+{
+   return decode_with_padding_to(source, inputSize, buffer_output(dest, destSize), 1, 0);
+}
+
+std::string encode_with_trailing_padding(const char* source, size_t inputSize)
+{
+   std::string buf;
+   encode_with_trailing_padding(source, inputSize, buf);
+   return buf;
+}
+
+std::string encode_with_trailing_padding(const std::string& source)
+{
+   return encode_with_trailing_padding(source.c_str(), source.size());
+}
+
+size_t encode_with_trailing_padding(const char* source, size_t inputSize, std::string& dest)
+{
+   return encode_with_trailing_padding_to(source, inputSize, string_output(dest));
+}
+
+size_t encode_with_trailing_padding(const char* source, size_t inputSize, std::vector<char>& dest)
+{
+   return encode_with_trailing_padding_to(source, inputSize, vector_output(dest));
+}
+
+size_t encode_with_trailing_padding(const char* source, size_t inputSize, char* dest, size_t destSize)
+{
+   return encode_with_trailing_padding_to(source, inputSize, buffer_output(dest, destSize));
+}
+
+std::string decode_with_trailing_padding(const char* source, size_t inputSize)
+{
+   std::string buf;
+   decode_with_trailing_padding(source, inputSize, buf);
    return buf;
 }
 
+std::string decode_with_trailing_padding(const std::string& source)
+{
+   return decode_with_trailing_padding(source.c_str(), source.size());
+}
+
+size_t decode_with_trailing_padding(const char* source, size_t inputSize, std::string& dest)
+{
+   return decode_with_trailing_padding_to(source, inputSize, string_output(dest));
+}
+
+size_t decode_with_trailing_padding(const char* source, size_t inputSize, std::vector<char>& dest)
+{
+   return decode_with_trailing_padding_to(source, inputSize, vector_output(dest));
+}
+
+size_t decode_with_trailing_padding(const char* source, size_t inputSize, char* dest, size_t destSize)
+{
+   return decode_with_trailing_padding_to(source, inputSize, buffer_output(dest, destSize));
+}
+
+std::string encode(const char* source, size_t inputSize)
+{
+   return encode_parallel(source, inputSize, 1, 0);
+}
+
 std::string encode(const std::string& source)
 {
    return encode(source.c_str(), source.size());
 }
 
+size_t encode(const char* source, size_t inputSize, std::string& dest)
+{
+   return encode_to(source, inputSize, string_output(dest), 1, 0);
+}
+
+size_t encode(const char* source, size_t inputSize, std::vector<char>& dest)
+{
+   return encode_to(source, inputSize, vector_output(dest), 1, 0);
+}
+
+size_t encode(const char* source, size_t inputSize, char* dest, size_t destSize)
+{
+   return encode_to(source, inputSize, buffer_output(dest, destSize), 1, 0);
+}
+
 std::string decode(const char* source, size_t inputSize)
 {
-   if (!source || inputSize == 0)
+   return decode_parallel(source, inputSize, 1, 0);
+}
+
+std::string decode(const std::string& source)
+{
+   return decode(source.c_str(), source.size());
+}
+
+size_t decode(const char* source, size_t inputSize, std::string& dest)
+{
+   return decode_to(source, inputSize, string_output(dest), 1, 0);
+}
+
+size_t decode(const char* source, size_t inputSize, std::vector<char>& dest)
+{
+   return decode_to(source, inputSize, vector_output(dest), 1, 0);
+}
+
+size_t decode(const char* source, size_t inputSize, char* dest, size_t destSize)
+{
+   return decode_to(source, inputSize, buffer_output(dest, destSize), 1, 0);
+}
+
+std::string encode_with_padding_parallel(const char* source, size_t inputSize,
+                                         size_t threadCount, size_t minChunkSize)
+{
+   std::string buf;
+   encode_with_padding_to(source, inputSize, string_output(buf), threadCount, minChunkSize);
+   return buf;
+}
+
+std::string encode_with_padding_parallel(const std::string& source, size_t threadCount, size_t minChunkSize)
+{
+   return encode_with_padding_parallel(source.c_str(), source.size(), threadCount, minChunkSize);
+}
+
+std::string decode_with_padding_parallel(const char* source, size_t inputSize,
+                                         size_t threadCount, size_t minChunkSize)
+{
+   std::string buf;
+   decode_with_padding_to(source, inputSize, string_output(buf), threadCount, minChunkSize);
+   return buf;
+}
+
+std::string decode_with_padding_parallel(const std::string& source, size_t threadCount, size_t minChunkSize)
+{
+   return decode_with_padding_parallel(source.c_str(), source.size(), threadCount, minChunkSize);
+}
+
+std::string encode_parallel(const char* source, size_t inputSize,
+                            size_t threadCount, size_t minChunkSize)
+{
+   std::string buf;
+   encode_to(source, inputSize, string_output(buf), threadCount, minChunkSize);
+   return buf;
+}
+
+std::string encode_parallel(const std::string& source, size_t threadCount, size_t minChunkSize)
+{
+   return encode_parallel(source.c_str(), source.size(), threadCount, minChunkSize);
+}
+
+std::string decode_parallel(const char* source, size_t inputSize,
+                            size_t threadCount, size_t minChunkSize)
+{
+   std::string buf;
+   decode_to(source, inputSize, string_output(buf), threadCount, minChunkSize);
+   return buf;
+}
+
+std::string decode_parallel(const std::string& source, size_t threadCount, size_t minChunkSize)
+{
+   return decode_parallel(source.c_str(), source.size(), threadCount, minChunkSize);
+}
+
+size_t encode_with_padding_inplace(std::string& buffer)
+{
+   const size_t inputSize = buffer.size();
+   if (inputSize == 0)
+   {
+      return 0;
+   }
+
+   buffer.resize(Z85_encode_with_padding_bound(inputSize));
+   return Z85_encode_with_padding_inplace(&buffer[0], inputSize);
+}
+
+size_t decode_with_padding_inplace(std::string& buffer)
+{
+   const size_t decodedBytes = buffer.empty() ? 0 : Z85_decode_with_padding_inplace(&buffer[0], buffer.size());
+   if (decodedBytes)
+   {
+      buffer.resize(decodedBytes);
+   }
+
+   return decodedBytes;
+}
+
+size_t encode_with_trailing_padding_inplace(std::string& buffer)
+{
+   const size_t inputSize = buffer.size();
+   if (inputSize == 0)
+   {
+      return 0;
+   }
+
+   buffer.resize(Z85_encode_with_trailing_padding_bound(inputSize));
+   return Z85_encode_with_trailing_padding_inplace(&buffer[0], inputSize);
+}
+
+size_t decode_with_trailing_padding_inplace(std::string& buffer)
+{
+   if (buffer.empty() || (buffer.size() - 1) % 5)
+   {
+      return 0;
+   }
+
+   const size_t decodedBytes = Z85_decode_with_trailing_padding_inplace(&buffer[0], buffer.size());
+   if (decodedBytes)
    {
-      return std::string();
+      buffer.resize(decodedBytes);
    }
 
+   return decodedBytes;
+}
+
+size_t encode_inplace(std::string& buffer)
+{
+   const size_t inputSize = buffer.size();
+   if (inputSize == 0 || inputSize % 4)
+   {
+      return 0;
+   }
+
+   buffer.resize(Z85_encode_bound(inputSize));
+   return Z85_encode_inplace(&buffer[0], inputSize);
+}
+
+size_t decode_inplace(std::string& buffer)
+{
+   if (buffer.empty() || buffer.size() % 5)
+   {
+      return 0;
+   }
+
+   buffer.resize(Z85_decode_inplace(&buffer[0], buffer.size()));
+   return buffer.size();
+}
+
+std::string encode_with_padding(const Z85_alphabet_t* alphabet, const std::string& source)
+{
    std::string buf;
-   buf.resize(Z85_decode_bound(inputSize));
+   if (alphabet && !source.empty())
+   {
+      string_output(buf).write(Z85_encode_with_padding_bound(source.size()), [&](char* dest)
+      {
+         return Z85_alphabet_encode_with_padding(alphabet, source.c_str(), dest, source.size());
+      });
+   }
+   return buf;
+}
 
-   const size_t decodedBytes = Z85_decode(source, &buf[0], inputSize);
-   if (decodedBytes == 0)
+std::string decode_with_padding(const Z85_alphabet_t* alphabet, const std::string& source)
+{
+   std::string  buf;
+   const size_t bound = Z85_decode_with_padding_bound(source.c_str(), source.size());
+   if (alphabet && bound)
    {
-      assert(!"wrong input size");
-      return std::string();
+      string_output(buf).write(bound, [&](char* dest)
+      {
+         return Z85_alphabet_decode_with_padding(alphabet, source.c_str(), dest, source.size());
+      });
    }
+   return buf;
+}
 
+std::string encode(const Z85_alphabet_t* alphabet, const std::string& source)
+{
+   std::string buf;
+   if (alphabet && !source.empty())
+   {
+      string_output(buf).write(Z85_encode_bound(source.size()), [&](char* dest)
+      {
+         return Z85_alphabet_encode(alphabet, source.c_str(), dest, source.size());
+      });
+   }
    return buf;
 }
 
-std::string decode(const std::string& source)
+std::string decode(const Z85_alphabet_t* alphabet, const std::string& source)
 {
-   return decode(source.c_str(), source.size());
+   std::string buf;
+   if (alphabet && !source.empty())
+   {
+      string_output(buf).write(Z85_decode_bound(source.size()), [&](char* dest)
+      {
+         return Z85_alphabet_decode(alphabet, source.c_str(), dest, source.size());
+      });
+   }
+   return buf;
 }
 
-} // namespace z85
+alphabet::alphabet(const char* symbols)
+   : m_alphabet(Z85_alphabet_create(symbols))
+{
+}
+
+alphabet::~alphabet()
+{
+   Z85_alphabet_free(m_alphabet);
+}
 
+std::string ascii85_encode(const std::string& source, int flags)
+{
+   std::string buf;
+   string_output(buf).write(Z85_ascii85_encode_bound(source.size()), [&](char* dest)
+   {
+      return Z85_ascii85_encode(source.c_str(), dest, source.size(), flags);
+   });
+   return buf;
+}
+
+std::string ascii85_decode(const std::string& source, int flags)
+{
+   std::string buf;
+   string_output(buf).write(Z85_ascii85_decode_bound(source.size()), [&](char* dest)
+   {
+      return Z85_ascii85_decode(source.c_str(), dest, source.size(), flags, NULL);
+   });
+   return buf;
+}
+
+std::string encode_with_checksum(const std::string& source)
+{
+   std::string buf;
+   string_output(buf).write(Z85_encode_with_checksum_bound(source.size()), [&](char* dest)
+   {
+      return Z85_encode_with_checksum(source.c_str(), dest, source.size());
+   });
+   return buf;
+}
+
+std::string decode_with_checksum(const std::string& source)
+{
+   std::string buf;
+   string_output(buf).write(Z85_decode_with_checksum_bound(source.c_str(), source.size()), [&](char* dest)
+   {
+      return Z85_decode_with_checksum(source.c_str(), dest, source.size(), NULL);
+   });
+   return buf;
+}
+
+namespace detail
+{
+
+size_t encode_with_padding_size(const char* source, size_t inputSize)
+{
+   return (source && inputSize != 0) ? Z85_encode_with_padding_bound(inputSize) : 0;
+}
+
+size_t decode_with_padding_size(const char* source, size_t inputSize)
+{
+   return (source && inputSize != 0 && (inputSize - 1) % 5 == 0) ? Z85_decode_with_padding_bound(source, inputSize) : 0;
+}
+
+size_t encode_with_trailing_padding_size(const char* source, size_t inputSize)
+{
+   return (source && inputSize != 0) ? Z85_encode_with_trailing_padding_bound(inputSize) : 0;
+}
+
+size_t decode_with_trailing_padding_size(const char* source, size_t inputSize)
+{
+   return (source && inputSize != 0 && (inputSize - 1) % 5 == 0) ? Z85_decode_with_trailing_padding_bound(source, inputSize) : 0;
+}
+
+size_t encode_size(const char* source, size_t inputSize)
+{
+   return (source && inputSize % 4 == 0) ? Z85_encode_bound(inputSize) : 0;
+}
+
+size_t decode_size(const char* source, size_t inputSize)
+{
+   return (source && inputSize % 5 == 0) ? Z85_decode_bound(inputSize) : 0;
+}
+
+} // namespace detail
+
+Z85_CPP_API_END
+} // namespace z85
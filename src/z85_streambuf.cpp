@@ -0,0 +1,211 @@
+/*
+ * Copyright 2013 Stanislav Artemkin <artemkin@gmail.com>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Implementation of 32/Z85 specification (http://rfc.zeromq.org/spec:32/Z85)
+ * Source repository: http://github.com/artemkin/z85
+ */
+
+#include "z85_streambuf.hpp"
+
+#include <cstring>
+
+
+namespace z85
+{
+Z85_CPP_API_BEGIN
+
+encoding_streambuf::encoding_streambuf(std::streambuf* sink, bool trailingPadding, size_t blockSize)
+   : m_sink(sink)
+   , m_block(blockSize ? (blockSize + 3) / 4 * 4 : 4)
+   , m_output(Z85_encoder_update_bound(m_block.size()))
+   , m_finished(false)
+   , m_failed(!sink)
+{
+   if (trailingPadding)
+   {
+      Z85_encoder_init_with_trailing_padding(&m_encoder);
+   }
+   else
+   {
+      Z85_encoder_init(&m_encoder);
+   }
+
+   setp(&m_block[0], &m_block[0] + m_block.size());
+}
+
+encoding_streambuf::~encoding_streambuf()
+{
+   finish();
+}
+
+// encodes 'size' bytes block by block and writes the symbols into the sink
+bool encoding_streambuf::encode(const char* source, size_t size)
+{
+   while (size && !m_failed)
+   {
+      const size_t chunkSize = size < m_block.size() ? size : m_block.size();
+      const size_t encoded   = Z85_encoder_update(&m_encoder, source, &m_output[0], chunkSize);
+
+      m_failed = m_sink->sputn(&m_output[0], encoded) != (std::streamsize)encoded;
+      source += chunkSize;
+      size   -= chunkSize;
+   }
+
+   return !m_failed;
+}
+
+encoding_streambuf::int_type encoding_streambuf::overflow(int_type ch)
+{
+   if (m_finished || !encode(pbase(), pptr() - pbase()))
+   {
+      return traits_type::eof();
+   }
+
+   setp(&m_block[0], &m_block[0] + m_block.size());
+
+   if (!traits_type::eq_int_type(ch, traits_type::eof()))
+   {
+      *pptr() = traits_type::to_char_type(ch);
+      pbump(1);
+   }
+
+   return traits_type::not_eof(ch);
+}
+
+std::streamsize encoding_streambuf::xsputn(const char* source, std::streamsize size)
+{
+   if (size < epptr() - pptr())
+   {
+      std::memcpy(pptr(), source, (size_t)size);
+      pbump((int)size);
+      return size;
+   }
+
+   // large writes skip the block, only the incomplete frame is carried by the encoder
+   if (m_finished || !encode(pbase(), pptr() - pbase()) || !encode(source, (size_t)size))
+   {
+      return 0;
+   }
+
+   setp(&m_block[0], &m_block[0] + m_block.size());
+   return size;
+}
+
+int encoding_streambuf::sync()
+{
+   // finish() has flushed everything, the put area stays closed, so later writes fail
+   if (m_finished)
+   {
+      return m_failed ? -1 : 0;
+   }
+
+   if (!encode(pbase(), pptr() - pbase()))
+   {
+      return -1;
+   }
+
+   setp(&m_block[0], &m_block[0] + m_block.size());
+   return m_failed || m_sink->pubsync() != 0 ? -1 : 0;
+}
+
+bool encoding_streambuf::finish()
+{
+   if (m_finished)
+   {
+      return !m_failed;
+   }
+
+   char   padding[6];
+   size_t written = 0;
+
+   if (encode(pbase(), pptr() - pbase()) && !Z85_encoder_finish(&m_encoder, padding, &written))
+   {
+      m_failed = true;
+   }
+
+   if (!m_failed && written)
+   {
+      m_failed = m_sink->sputn(padding, written) != (std::streamsize)written;
+   }
+
+   m_finished = true;
+   setp(NULL, NULL);
+
+   return !m_failed && m_sink->pubsync() == 0;
+}
+
+decoding_streambuf::decoding_streambuf(std::streambuf* source, bool trailingPadding, size_t blockSize)
+   : m_source(source)
+   , m_block(blockSize ? (blockSize + 4) / 5 * 5 : 5)
+   , m_output(Z85_decoder_update_bound(m_block.size()))
+   , m_finished(!source)
+   , m_failed(!source)
+{
+   if (trailingPadding)
+   {
+      Z85_decoder_init_with_trailing_padding(&m_decoder);
+   }
+   else
+   {
+      Z85_decoder_init(&m_decoder);
+   }
+}
+
+decoding_streambuf::int_type decoding_streambuf::underflow()
+{
+   if (gptr() < egptr())
+   {
+      return traits_type::to_int_type(*gptr());
+   }
+
+   // a block may end inside a frame, which is carried by the decoder, so read until bytes come out
+   while (!m_finished)
+   {
+      const std::streamsize read = m_source->sgetn(&m_block[0], m_block.size());
+      size_t decoded = 0;
+
+      if (read > 0)
+      {
+         decoded = Z85_decoder_update(&m_decoder, &m_block[0], &m_output[0], (size_t)read);
+      }
+      else
+      {
+         m_finished = true;
+         m_failed   = !Z85_decoder_finish(&m_decoder, &m_output[0], &decoded);
+      }
+
+      if (decoded)
+      {
+         setg(&m_output[0], &m_output[0], &m_output[0] + decoded);
+         return traits_type::to_int_type(m_output[0]);
+      }
+   }
+
+   return traits_type::eof();
+}
+
+Z85_CPP_API_END
+} // namespace z85
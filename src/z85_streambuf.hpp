@@ -0,0 +1,159 @@
+/*
+ * Copyright 2013 Stanislav Artemkin <artemkin@gmail.com>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Implementation of 32/Z85 specification (http://rfc.zeromq.org/spec:32/Z85)
+ * Source repository: http://github.com/artemkin/z85
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <streambuf>
+#include <vector>
+
+#include "z85.h"
+
+// z85_single.h puts the C++ API into an unnamed namespace in Z85_STATIC mode
+#if !defined (Z85_CPP_API_BEGIN)
+   #define Z85_CPP_API_BEGIN
+   #define Z85_CPP_API_END
+#endif
+
+namespace z85
+{
+Z85_CPP_API_BEGIN
+
+/*******************************************************************************
+ * Stream buffers, which encode/decode data passing through them               *
+ *******************************************************************************/
+
+/**
+ * Output stream buffer, which encodes everything written to it into 'sink'.
+ * Written bytes are gathered into a block of 'blockSize' bytes and the whole block is encoded
+ * by the bulk kernels (see Z85_encoder_update()), so memory footprint doesn't depend on the
+ * stream length. Large writes are encoded straight from the caller's buffer.
+ *
+ * The leading tail bytes count of encode_with_padding() isn't known until the end of the stream,
+ * so the stream is either encoded with encode_with_trailing_padding() format or isn't padded at all
+ * (encode(), the stream length must be divisible by 4). Padding is written by finish(),
+ * which is called by destructor too. sync() (e.g. std::flush) writes all complete frames.
+ *
+ * Usage:
+ *    std::ofstream file("data.z85", std::ios::binary);
+ *    z85::encoding_streambuf buf(file.rdbuf());
+ *    std::ostream out(&buf);
+ *    out << object;
+ *    buf.finish();
+ */
+class encoding_streambuf : public std::streambuf
+{
+   std::streambuf*   m_sink;
+   Z85_encoder_t     m_encoder;
+   std::vector<char> m_block;  // bytes written so far, the put area
+   std::vector<char> m_output; // symbols of a block
+   bool              m_finished;
+   bool              m_failed;
+
+public:
+   /**
+    * @param sink in, stream buffer to write symbols into, it must outlive this one
+    * @param trailingPadding in, encode the stream with encode_with_trailing_padding() format
+    * @param blockSize in, size of the internal buffer, rounded up to whole frames
+    */
+   explicit encoding_streambuf(std::streambuf* sink, bool trailingPadding = true, size_t blockSize = 4096);
+   ~encoding_streambuf();
+
+   /**
+    * @brief Encodes the rest of the stream and writes padding. Nothing can be written afterwards.
+    *
+    * @return false if 'sink' failed or the length of the stream without padding isn't divisible by 4
+    */
+   bool finish();
+
+   /**
+    * @brief Returns true if 'sink' failed or finish() has found the stream length wrong.
+    */
+   bool failed() const { return m_failed; }
+
+protected:
+   int_type overflow(int_type ch);
+   std::streamsize xsputn(const char* source, std::streamsize size);
+   int sync();
+
+private:
+   bool encode(const char* source, size_t size);
+
+   encoding_streambuf(const encoding_streambuf&) = delete;
+   encoding_streambuf& operator=(const encoding_streambuf&) = delete;
+};
+
+/**
+ * Input stream buffer, which decodes symbols read from 'source'.
+ * Symbols are read by blocks of 'blockSize' symbols and decoded by the bulk kernels
+ * (see Z85_decoder_update()), so memory footprint doesn't depend on the stream length.
+ * Like decode(), it doesn't validate symbols, use Z85_validate() for untrusted input.
+ *
+ * The stream ends at the end of 'source'. If 'source' ends in the middle of a frame
+ * or padding is malformed, the last frame is dropped and failed() returns true.
+ *
+ * Usage:
+ *    std::ifstream file("data.z85", std::ios::binary);
+ *    z85::decoding_streambuf buf(file.rdbuf());
+ *    std::istream in(&buf);
+ *    in >> object;
+ */
+class decoding_streambuf : public std::streambuf
+{
+   std::streambuf*   m_source;
+   Z85_decoder_t     m_decoder;
+   std::vector<char> m_block;  // symbols of a block
+   std::vector<char> m_output; // decoded bytes, the get area
+   bool              m_finished;
+   bool              m_failed;
+
+public:
+   /**
+    * @param source in, stream buffer to read symbols from, it must outlive this one
+    * @param trailingPadding in, the stream is encoded with encode_with_trailing_padding() format
+    * @param blockSize in, number of symbols read at once, rounded up to whole frames
+    */
+   explicit decoding_streambuf(std::streambuf* source, bool trailingPadding = true, size_t blockSize = 5120);
+
+   /**
+    * @brief Returns true if the stream has ended in the middle of a frame or padding is malformed.
+    */
+   bool failed() const { return m_failed; }
+
+protected:
+   int_type underflow();
+
+private:
+   decoding_streambuf(const decoding_streambuf&) = delete;
+   decoding_streambuf& operator=(const decoding_streambuf&) = delete;
+};
+
+Z85_CPP_API_END
+} // namespace z85
@@ -2,10 +2,15 @@
 #include <cstring>
 #include <cstdlib>
 #include <cstddef>
+#include <algorithm>
+#include <sstream>
+#include <thread>
 
 #include "lest.hpp"
 #include "z85.h"
 #include "z85.hpp"
+#include "z85_constexpr.hpp"
+#include "z85_streambuf.hpp"
 
 using namespace std;
 
@@ -75,6 +80,110 @@ void for_random_data(size_t divisibleBy, Fn f)
    }
 }
 
+// Runs 'f' with every backend supported by the CPU
+template<typename Fn>
+void for_each_backend(Fn f)
+{
+   for (int backend = Z85_BACKEND_SCALAR; Z85_backend_name((Z85_backend)backend); ++backend)
+   {
+      if (Z85_set_backend((Z85_backend)backend))
+      {
+         f();
+      }
+   }
+
+   Z85_set_backend(Z85_BACKEND_AUTO);
+}
+
+const char c_alphabet[] =
+   "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ.-:+=^!/*?&<>()[]{}@%$#";
+
+// Straightforward implementation of the specification to check optimized kernels against
+string reference_encode(const string& bin)
+{
+   string txt;
+   for (size_t i = 0; i + 4 <= bin.size(); i += 4)
+   {
+      unsigned long value = 0;
+      for (size_t j = 0; j < 4; ++j)
+      {
+         value = value * 256 + (unsigned char)bin[i + j];
+      }
+
+      char frame[5];
+      for (int j = 4; j >= 0; --j)
+      {
+         frame[j] = c_alphabet[value % 85];
+         value /= 85;
+      }
+      txt.append(frame, 5);
+   }
+   return txt;
+}
+
+string reference_decode(const string& txt)
+{
+   string bin;
+   for (size_t i = 0; i + 5 <= txt.size(); i += 5)
+   {
+      unsigned long value = 0;
+      for (size_t j = 0; j < 5; ++j)
+      {
+         value = value * 85 + (strchr(c_alphabet, txt[i + j]) - c_alphabet);
+      }
+
+      for (int j = 3; j >= 0; --j)
+      {
+         bin += (char)(value >> (j * 8));
+      }
+   }
+   return bin;
+}
+
+// Random printable string made of Z85 alphabet
+string random_text(size_t size)
+{
+   string txt;
+   for (size_t i = 0; i < size; ++i)
+   {
+      txt += c_alphabet[rand() % 85];
+   }
+   return txt;
+}
+
+// Counts allocated bytes, the strings below check which allocator is used
+size_t g_counted_bytes = 0;
+
+template<typename T>
+struct counting_allocator : std::allocator<T>
+{
+   typedef T value_type;
+
+   counting_allocator() {}
+   template<typename U> counting_allocator(const counting_allocator<U>&) {}
+   template<typename U> struct rebind { typedef counting_allocator<U> other; };
+
+   T* allocate(size_t n)
+   {
+      g_counted_bytes += n * sizeof(T);
+      return std::allocator<T>::allocate(n);
+   }
+};
+
+typedef basic_string<char, char_traits<char>, counting_allocator<char> > counted_string;
+
+// test_single.c and test_single.cpp, compiled with private copies of z85_single.h
+extern "C" size_t single_encode_key(const char* key, char* dest);
+extern "C" size_t single_decode_key(const char* text, char* dest);
+string single_encode_with_padding(const string& source);
+string single_decode_with_padding(const string& source);
+
+#if defined (Z85_TEST_CXX17)
+// test_constexpr.cpp, compiled as C++17
+string cxx17_encode(const string& bin);
+size_t cxx17_decode_checked(const string& txt, string& bin);
+#endif
+
 const lest::test specification[] =
 {
    "Hello world!", []
@@ -179,6 +288,282 @@ const lest::test specification[] =
            "4JTKVSB%%)wK0E.X)V>+}o?pNmC{O&4W4b!Ni{Lh6");
    },
 
+   "Test Z85_encode_unsafe() against reference", []
+   {
+      for_each_backend([]{
+      for_random_data(4, [](const string& bin)
+      {
+         if (bin.size() > 1000) return;
+
+         // odd offset to check unaligned loads and stores
+         for (size_t offset = 0; offset < 2; ++offset)
+         {
+            const string src = string(offset, '\0') + bin;
+            const string txt = reference_encode(bin);
+
+            with_strict_buf(txt.size() + offset, [&](strict_buf& txt_buf) {
+
+            char* txt_end = Z85_encode_unsafe(src.c_str() + offset, src.c_str() + src.size(), txt_buf.p() + offset);
+
+            EXPECT((txt_end - txt_buf.p()) == (int)(txt.size() + offset));
+            EXPECT(txt_buf.data().substr(offset) == txt);
+
+            });
+         }
+      });
+      });
+   },
+
+   "Test Z85_decode_unsafe() against reference", []
+   {
+      for_each_backend([]{
+      srand(0);
+
+      for (size_t size = 0; size < 1000; size += 5)
+      {
+         const string txt = random_text(size);
+         const string bin = reference_decode(txt);
+
+         // odd offset to check unaligned loads and stores
+         for (size_t offset = 0; offset < 2; ++offset)
+         {
+            const string src = string(offset, '0') + txt;
+
+            with_strict_buf(bin.size() + offset, [&](strict_buf& bin_buf) {
+
+            char* bin_end = Z85_decode_unsafe(src.c_str() + offset, src.c_str() + src.size(), bin_buf.p() + offset);
+
+            EXPECT((bin_end - bin_buf.p()) == (int)(bin.size() + offset));
+            EXPECT(bin_buf.data().substr(offset) == bin);
+
+            });
+         }
+      }
+      });
+   },
+
+   "Test checked decoding", []
+   {
+      for_each_backend([]{
+      srand(0);
+
+      const char invalid[] = { '\0', ' ', '"', '\'', ',', ';', '\\', '_', '`', '|', '~', '\x7F', '\x80', '\xFF' };
+
+      for (size_t size = 5; size < 500; size += 5)
+      {
+         string bin;
+         for (size_t i = 0; i < size / 5 * 4; ++i)
+         {
+            bin += (char)(rand() % 256);
+         }
+         const string txt = reference_encode(bin);
+
+         string buf(bin.size(), '\0');
+         size_t errorPos = 0;
+         EXPECT(Z85_decode_checked(txt.c_str(), &buf[0], txt.size(), &errorPos) == bin.size());
+         EXPECT(errorPos == Z85_NPOS);
+         EXPECT(buf == bin);
+         EXPECT(Z85_validate(txt.c_str(), txt.size(), &errorPos) == 1);
+         EXPECT(errorPos == Z85_NPOS);
+
+         for (size_t i = 0; i < 3; ++i)
+         {
+            string bad = txt;
+            const size_t pos = rand() % size;
+            bad[pos] = invalid[rand() % sizeof(invalid)];
+
+            // another error after the first one doesn't matter
+            if (pos + 7 < size) bad[pos + 7] = ' ';
+
+            EXPECT(Z85_decode_checked(bad.c_str(), &buf[0], bad.size(), &errorPos) == 0);
+            EXPECT(errorPos == pos);
+            EXPECT(Z85_validate(bad.c_str(), bad.size(), &errorPos) == 0);
+            EXPECT(errorPos == pos);
+         }
+
+         // frames exceeding 2^32 - 1
+         const size_t frame = rand() % (size / 5) * 5;
+         string overflow = txt;
+         overflow.replace(frame, 5, rand() % 2 ? "%nSc1" : "#####");
+
+         EXPECT(Z85_decode_checked(overflow.c_str(), &buf[0], overflow.size(), &errorPos) == 0);
+         EXPECT(errorPos == frame);
+         EXPECT(Z85_validate(overflow.c_str(), overflow.size(), &errorPos) == 0);
+         EXPECT(errorPos == frame);
+
+         overflow.replace(frame, 5, "%nSc0");
+         EXPECT(Z85_validate(overflow.c_str(), overflow.size(), &errorPos) == 1);
+      }
+      });
+
+      char buf[100];
+      size_t errorPos = 0;
+      EXPECT(Z85_decode_checked("HelloWorld", buf, 10, &errorPos) == 8);
+      EXPECT(Z85_decode_checked("HelloWorld", buf, 9, &errorPos) == 0);
+      EXPECT(errorPos == 9);
+      EXPECT(Z85_decode_checked(NULL, buf, 10, &errorPos) == 0);
+      EXPECT(errorPos == 0);
+      EXPECT(Z85_decode_checked("", buf, 0, &errorPos) == 0);
+      EXPECT(errorPos == Z85_NPOS);
+
+      EXPECT(Z85_decode_with_padding_checked("4HelloWorld", buf, 11, &errorPos) == 8);
+      EXPECT(string(buf, 8) == "\x86\x4F\xD2\x6F\xB5\x59\xF7\x5B");
+      EXPECT(Z85_decode_with_padding_checked("3HelloWorld", buf, 11, &errorPos) == 7);
+      EXPECT(Z85_decode_with_padding_checked("5HelloWorld", buf, 11, &errorPos) == 0);
+      EXPECT(errorPos == 0);
+      EXPECT(Z85_decode_with_padding_checked("4Hello World", buf, 12, &errorPos) == 0);
+      EXPECT(errorPos == 12);
+      EXPECT(Z85_decode_with_padding_checked("4HelloWor|d", buf, 11, &errorPos) == 0);
+      EXPECT(errorPos == 9);
+      EXPECT(Z85_decode_with_padding_checked("4He lo%nSc1", buf, 11, &errorPos) == 0);
+      EXPECT(errorPos == 3);
+
+      EXPECT(Z85_decode_with_trailing_padding_checked("HelloWorld4", buf, 11, &errorPos) == 8);
+      EXPECT(Z85_decode_with_trailing_padding_checked("HelloWorld9", buf, 11, &errorPos) == 0);
+      EXPECT(errorPos == 10);
+      EXPECT(Z85_decode_with_trailing_padding_checked("Hello%nSc14", buf, 11, &errorPos) == 0);
+      EXPECT(errorPos == 5);
+   },
+
+   "Test backend selection", []
+   {
+      EXPECT(Z85_get_backend() != Z85_BACKEND_AUTO);
+
+      EXPECT(Z85_set_backend(Z85_BACKEND_SCALAR) == 1);
+      EXPECT(Z85_get_backend() == Z85_BACKEND_SCALAR);
+      EXPECT(Z85_set_backend_by_name("no such backend") == 0);
+      EXPECT(Z85_get_backend() == Z85_BACKEND_SCALAR);
+      EXPECT(Z85_set_backend((Z85_backend)100) == 0);
+      EXPECT(Z85_get_backend() == Z85_BACKEND_SCALAR);
+      EXPECT(Z85_set_backend_by_name("auto") == 1);
+      EXPECT(Z85_get_backend() != Z85_BACKEND_AUTO);
+
+      EXPECT(string(Z85_backend_name(Z85_BACKEND_SCALAR)) == "scalar");
+      EXPECT(Z85_backend_name((Z85_backend)100) == NULL);
+
+      // portable backends are always available
+      EXPECT(Z85_set_backend_by_name("pairs") == 1);
+      EXPECT(Z85_get_backend() == Z85_BACKEND_PAIRS);
+      EXPECT(Z85_backend_table_size(Z85_BACKEND_AUTO) == Z85_backend_table_size(Z85_BACKEND_PAIRS));
+      EXPECT(Z85_backend_table_size(Z85_BACKEND_PAIRS) > Z85_backend_table_size(Z85_BACKEND_SCALAR));
+      EXPECT(Z85_backend_table_size((Z85_backend)100) == 0);
+      EXPECT(Z85_set_backend(Z85_BACKEND_AUTO) == 1);
+
+      // every backend produces the same result
+      for_each_backend([]
+      {
+         EXPECT(z85::encode_with_padding(string("\x86\x4F\xD2\x6F\xB5\x59\xF7\x5B")) == "4HelloWorld");
+         EXPECT(z85::decode_with_padding(string("4HelloWorld")) == "\x86\x4F\xD2\x6F\xB5\x59\xF7\x5B");
+      });
+   },
+
+   "Test with trailing padding", []
+   {
+      auto test = [](const string& bin, const string& txt)
+      {
+         with_strict_buf(txt.size(), [&](strict_buf& txt_buf) {
+         with_strict_buf(bin.size(), [&](strict_buf& bin_buf) {
+
+         size_t txt_written = Z85_encode_with_trailing_padding(bin.c_str(), txt_buf.p(), bin.size());
+         size_t bin_written = Z85_decode_with_trailing_padding(txt_buf.p(), bin_buf.p(), txt_written);
+
+         EXPECT(txt_written == txt.size());
+         EXPECT(bin_written == bin.size());
+         EXPECT(bin_buf.data() == bin);
+         EXPECT(txt_buf.data() == txt);
+         EXPECT(Z85_encode_with_trailing_padding_bound(bin.size()) == txt.size());
+         EXPECT(Z85_decode_with_trailing_padding_bound(txt.c_str(), txt.size()) == bin.size());
+
+         });});
+      };
+
+      test("", "");
+      test("\x86\x4F\xD2\x6F\xB5\x59\xF7\x5B", "HelloWorld4");
+      test("\x86\x4F\xD2\x6F\xB5", "HelloWeZgb1");
+      test("\x86\x4F\xD2\x6F\xB5\x59\xF7", "HelloWork73");
+
+      char buf[100];
+      EXPECT(Z85_decode_with_trailing_padding("HelloWorld0", buf, 11) == 0);
+      EXPECT(Z85_decode_with_trailing_padding("HelloWorld5", buf, 11) == 0);
+      EXPECT(Z85_decode_with_trailing_padding("HelloWorld", buf, 10) == 0);
+   },
+
+   "Test with trailing padding roundtrip", []
+   {
+      for_random_data(1, [](const string& bin)
+      {
+         const string txt = z85::encode_with_trailing_padding(bin);
+
+         // the same as leading padding, but the tail bytes count is moved to the end
+         EXPECT(txt == z85::encode_with_padding(bin).substr(1) + z85::encode_with_padding(bin)[0]);
+         EXPECT(z85::decode_with_trailing_padding(txt) == bin);
+      });
+   },
+
+   "Test streaming with trailing padding", []
+   {
+      srand(0);
+
+      for (size_t size = 0; size < 300; ++size)
+      {
+         string bin;
+         for (size_t i = 0; i < size; ++i)
+         {
+            bin += (char)(rand() % 256);
+         }
+         const string txt = z85::encode_with_trailing_padding(bin);
+         const size_t maxChunk = size % 17 + 1;
+
+         Z85_encoder_t encoder;
+         Z85_encoder_init_with_trailing_padding(&encoder);
+
+         string encoded;
+         for (size_t pos = 0; pos < bin.size();)
+         {
+            const size_t chunk = std::min(bin.size() - pos, (size_t)rand() % maxChunk + 1);
+
+            string buf(Z85_encoder_update_bound(chunk), '\0');
+            encoded += buf.substr(0, Z85_encoder_update(&encoder, &bin[pos], &buf[0], chunk));
+            pos += chunk;
+         }
+
+         char tail[6];
+         size_t written = 0;
+         EXPECT(Z85_encoder_finish(&encoder, tail, &written) == 1);
+         encoded += string(tail, written);
+         EXPECT(encoded == txt);
+
+         Z85_decoder_t decoder;
+         Z85_decoder_init_with_trailing_padding(&decoder);
+
+         string decoded;
+         for (size_t pos = 0; pos < txt.size();)
+         {
+            const size_t chunk = std::min(txt.size() - pos, (size_t)rand() % maxChunk + 1);
+
+            string buf(Z85_decoder_update_bound(chunk), '\0');
+            decoded += buf.substr(0, Z85_decoder_update(&decoder, &txt[pos], &buf[0], chunk));
+            pos += chunk;
+         }
+
+         EXPECT(Z85_decoder_finish(&decoder, tail, &written) == 1);
+         decoded += string(tail, written);
+         EXPECT(decoded == bin);
+      }
+
+      // malformed streams
+      char buf[10];
+      size_t written = 0;
+      Z85_decoder_t decoder;
+      Z85_decoder_init_with_trailing_padding(&decoder);
+      EXPECT(Z85_decoder_update(&decoder, "Hello", buf, 5) == 0);
+      EXPECT(Z85_decoder_finish(&decoder, buf, &written) == 0);
+
+      Z85_decoder_init_with_trailing_padding(&decoder);
+      EXPECT(Z85_decoder_update(&decoder, "HelloWorld7", buf, 11) == 4);
+      EXPECT(Z85_decoder_finish(&decoder, buf, &written) == 0);
+   },
+
    "Test no padding roundtrip", []
    {
       for_random_data(4, [](const string& bin)
@@ -201,6 +586,1063 @@ const lest::test specification[] =
       });
    },
 
+   "Test encoding/decoding to caller's storage", []
+   {
+      const string bin("\x86\x4F\xD2\x6F\xB5\x59\xF7\x5B");
+
+      // appends reusing capacity
+      string txt("prefix:");
+      txt.reserve(100);
+      const char* data = txt.data();
+      EXPECT(z85::encode(bin.data(), bin.size(), txt) == 10);
+      EXPECT(txt == "prefix:HelloWorld");
+      EXPECT(txt.data() == data);
+
+      string out("x");
+      EXPECT(z85::decode(txt.data() + 7, 10, out) == 8);
+      EXPECT(out == "x" + bin);
+
+      vector<char> vec(1, 'y');
+      EXPECT(z85::encode_with_padding(bin.data(), 5, vec) == 11);
+      EXPECT(string(vec.begin(), vec.end()) == "y" + z85::encode_with_padding(bin.data(), 5));
+      vector<char> vec2;
+      EXPECT(z85::decode_with_padding(&vec[1], 11, vec2) == 5);
+      EXPECT(string(vec2.begin(), vec2.end()) == bin.substr(0, 5));
+
+      // errors append nothing
+      EXPECT(z85::encode(bin.data(), 5, out) == 0);
+      EXPECT(z85::decode(txt.data(), 4, vec) == 0);
+      EXPECT(out == "x" + bin);
+      EXPECT(vec.size() == 12u);
+
+      // buffer of limited size
+      char buf[16] = {};
+      EXPECT(z85::encode(bin.data(), bin.size(), buf, 9) == 0);
+      EXPECT(buf[0] == '\0');
+      EXPECT(z85::encode(bin.data(), bin.size(), buf, 10) == 10);
+      EXPECT(string(buf, 10) == "HelloWorld");
+      EXPECT(z85::decode(buf, 10, buf, sizeof(buf)) == 8);
+      EXPECT(string(buf, 8) == bin);
+
+      string trailing;
+      EXPECT(z85::encode_with_trailing_padding(bin.data(), 5, trailing) == 11);
+      EXPECT(trailing == z85::encode_with_trailing_padding(bin.data(), 5));
+      EXPECT(z85::decode_with_trailing_padding(trailing.data(), trailing.size(), buf, 4) == 0);
+      EXPECT(z85::decode_with_trailing_padding(trailing.data(), trailing.size(), buf, 5) == 5);
+      EXPECT(string(buf, 5) == bin.substr(0, 5));
+
+      // malformed length (not 1 + 5 * n symbols) writes and appends nothing
+      const char malformed[] = "4HelloWo";
+      memset(buf, 0, sizeof(buf));
+      EXPECT(z85::decode_with_padding(malformed, 8, buf, sizeof(buf)) == 0);
+      EXPECT(buf[0] == '\0');
+      string padded("x");
+      EXPECT(z85::decode_with_padding(malformed, 8, padded) == 0);
+      EXPECT(padded == "x");
+      vector<char> paddedVec(1, 'y');
+      EXPECT(z85::decode_with_padding(malformed, 8, paddedVec) == 0);
+      EXPECT(paddedVec.size() == 1u);
+      EXPECT(z85::decode_with_padding(malformed, 8).empty());
+   },
+
+   "Test allocator-aware functions", []
+   {
+      const string bin("\x86\x4F\xD2\x6F\xB5\x59\xF7\x5B");
+
+      // appends with the string's allocator
+      g_counted_bytes = 0;
+      counted_string txt("prefix:");
+      EXPECT(z85::encode(bin.data(), bin.size(), txt) == 10);
+      EXPECT(txt == "prefix:HelloWorld");
+      EXPECT(g_counted_bytes != 0);
+
+      counted_string out;
+      EXPECT(z85::decode(txt.data() + 7, 10, out) == 8);
+      EXPECT(string(out.data(), out.size()) == bin);
+      EXPECT(z85::decode(txt.data(), 4, out) == 0);
+      EXPECT(out.size() == 8u);
+
+      // returns a string of the given type
+      EXPECT(z85::encode<counted_string>(bin.data(), bin.size()) == "HelloWorld");
+      EXPECT(z85::encode<counted_string>(bin.data(), 5).empty());
+      EXPECT(z85::decode<counted_string>("HelloWorld", 10) == counted_string(bin.data(), bin.size()));
+
+      for_random_data(1, [](const string& data)
+      {
+         const counted_string padded = z85::encode_with_padding<counted_string>(data.data(), data.size());
+         EXPECT(padded == z85::encode_with_padding(data).c_str());
+         EXPECT(z85::decode_with_padding<counted_string>(padded.data(), padded.size()) ==
+                counted_string(data.data(), data.size()));
+
+         const counted_string trailing = z85::encode_with_trailing_padding<counted_string>(data.data(), data.size());
+         EXPECT(trailing == z85::encode_with_trailing_padding(data).c_str());
+         EXPECT(z85::decode_with_trailing_padding<counted_string>(trailing.data(), trailing.size()) ==
+                counted_string(data.data(), data.size()));
+      });
+
+      // wrong length or tail bytes count
+      EXPECT(z85::decode_with_padding<counted_string>("4HelloWo", 8).empty());
+      EXPECT(z85::decode_with_padding<counted_string>("5HelloWorld", 11).empty());
+      EXPECT(z85::decode_with_trailing_padding<counted_string>("HelloWo4", 8).empty());
+      EXPECT(z85::decode<counted_string>("HelloWo", 7).empty());
+
+#if defined (__cpp_lib_memory_resource)
+      // nothing comes from the global heap, an allocation past the arena would throw
+      char arena[256];
+      std::pmr::monotonic_buffer_resource resource(arena, sizeof(arena), std::pmr::null_memory_resource());
+
+      const std::pmr::string pmrText = z85::encode(bin.data(), bin.size(), &resource);
+      EXPECT(pmrText == "HelloWorld");
+      EXPECT(pmrText.get_allocator().resource() == &resource);
+      EXPECT(z85::decode(pmrText.data(), pmrText.size(), &resource) == bin.c_str());
+      EXPECT(z85::decode_with_padding(z85::encode_with_padding(bin.data(), 5, &resource).data(), 11, &resource) ==
+             bin.substr(0, 5).c_str());
+      EXPECT(z85::decode_with_trailing_padding(z85::encode_with_trailing_padding(bin.data(), 5, &resource).data(), 11,
+                                               &resource) == bin.substr(0, 5).c_str());
+
+      // views into the arena
+      const std::string_view view = z85::decode_view("HelloWorld", 10, &resource);
+      EXPECT(view == bin);
+      EXPECT(view.data() >= arena && view.data() + view.size() <= arena + sizeof(arena));
+      EXPECT(z85::encode_view(view.data(), view.size(), &resource) == "HelloWorld");
+      EXPECT(z85::decode_with_padding_view(z85::encode_with_padding_view(bin.data(), 5, &resource).data(), 11,
+                                           &resource) == bin.substr(0, 5));
+      EXPECT(z85::decode_view("Hello", 4, &resource).empty());
+      EXPECT(z85::encode_view(bin.data(), 0, &resource).empty());
+
+      // wrong input allocates nothing, any allocation from this arena would throw
+      char noSpace[1];
+      std::pmr::monotonic_buffer_resource empty(noSpace, sizeof(noSpace), std::pmr::null_memory_resource());
+      EXPECT(z85::decode_with_padding_view("4HelloWo", 8, &empty).empty());
+      EXPECT(z85::decode_with_padding_view("5HelloWorld", 11, &empty).empty());
+      EXPECT(z85::decode_view("HelloWo", 7, &empty).empty());
+      EXPECT(z85::encode_view(bin.data(), 5, &empty).empty());
+      EXPECT(z85::decode_with_padding("4HelloWo", 8, &empty).empty());
+#endif
+   },
+
+   "Test fixed size encoding/decoding", []
+   {
+      const std::array<uint8_t, 8> hello = {{ 0x86, 0x4F, 0xD2, 0x6F, 0xB5, 0x59, 0xF7, 0x5B }};
+      const z85::fixed_string<10> txt = z85::encode(hello);
+      EXPECT(txt.size() == 10u);
+      EXPECT(txt.str() == "HelloWorld");
+      EXPECT(string(txt.c_str()) == "HelloWorld");
+      EXPECT(z85::decode(txt) == hello);
+      EXPECT(z85::decode<10>("HelloWorld") == hello);
+
+      const char keyText[] = "rq:rM>}U?@Lns47E1%kR.o@n%FcmmsL/@{H8]yf7";
+      const std::array<uint8_t, 32> key = z85::decode<40>(keyText);
+      EXPECT(string(key.begin(), key.end()) == z85::decode(string(keyText)));
+      EXPECT(z85::encode<32>(key).str() == keyText);
+      EXPECT(z85::encode(key) == z85::encode(z85::decode(z85::encode(key))));
+
+      // small inputs of the C API take a separate path
+      for_random_data(1, [](const string& bin)
+      {
+         if (bin.size() > 100) return;
+
+         string txt(Z85_encode_with_padding_bound(bin.size()), '\0');
+         EXPECT(Z85_encode_with_padding(bin.data(), &txt[0], bin.size()) == txt.size());
+         EXPECT(txt == z85::encode_with_padding_parallel(bin, 1, 1));
+      });
+   },
+
+   "Test alphabet tables of z85.c and z85_tables.hpp agree", []
+   {
+      const char* base85 = z85::detail::tables<>::base85;
+      const unsigned char* base256 = z85::detail::tables<>::base256;
+
+      EXPECT(strlen(base85) == 85u);
+
+      // every symbol of the alphabet round trips through all the tables
+      for_each_backend([=]
+      {
+         for (int digit = 0; digit < 85; ++digit)
+         {
+            const char frame[4] = { 0, 0, 0, (char)digit };
+            char txt[5];
+            Z85_encode_unsafe(frame, frame + 4, txt);
+            EXPECT(txt[4] == base85[digit]);
+
+            char out[4];
+            Z85_decode_unsafe(txt, txt + 5, out);
+            EXPECT(memcmp(out, frame, 4) == 0);
+            EXPECT(base256[((unsigned char)base85[digit] - 32) & 127] == digit);
+         }
+      });
+
+      // ASCII symbols out of the alphabet decode as zeros
+      for (int symbol = 0; symbol < 128; ++symbol)
+      {
+         if (!memchr(base85, symbol, 85))
+         {
+            EXPECT(base256[(symbol - 32) & 127] == 0);
+#if __cplusplus >= 201402L
+            EXPECT(z85::ct::detail::digit((char)symbol) == -1);
+#endif
+         }
+      }
+   },
+
+   "Test constexpr kernels", []
+   {
+#if __cplusplus >= 201402L
+      struct encoded
+      {
+         char text[11];
+
+         constexpr encoded() : text()
+         {
+            const unsigned char bin[] = { 0x86, 0x4F, 0xD2, 0x6F, 0xB5, 0x59, 0xF7, 0x5B };
+            z85::ct::encode_unsafe(bin, bin + 8, text);
+         }
+      };
+
+      constexpr encoded hello;
+      static_assert(hello.text[0] == 'H' && hello.text[9] == 'd', "compile time encoding");
+      EXPECT(string(hello.text) == "HelloWorld");
+
+      for_random_data(4, [](const string& bin)
+      {
+         if (bin.size() > 1000) return;
+
+         string txt(bin.size() / 4 * 5, '\0');
+         z85::ct::encode_unsafe(bin.data(), bin.data() + bin.size(), &txt[0]);
+         EXPECT(txt == z85::encode(bin));
+
+         string out(bin.size(), '\0');
+         EXPECT(z85::ct::decode_checked(txt.data(), txt.data() + txt.size(), &out[0]) == txt.data() + txt.size());
+         EXPECT(out == bin);
+      });
+
+      const char bad[] = "Hello World";
+      char out[8] = {};
+      EXPECT(z85::ct::decode_checked(bad, bad + 10, out) == bad + 5);
+      // the largest frame and the first overflowing one
+      const char max[] = "%nSc0%nSc1";
+      EXPECT(z85::ct::decode_checked(max, max + 5, out) == max + 5);
+      EXPECT(z85::ct::decode_checked(max, max + 10, out) == max + 5);
+#endif
+
+#if defined (Z85_TEST_CXX17)
+      for_random_data(4, [](const string& bin)
+      {
+         if (bin.size() > 1000) return;
+
+         const string txt = cxx17_encode(bin);
+         EXPECT(txt == z85::encode(bin));
+
+         string out;
+         EXPECT(cxx17_decode_checked(txt, out) == txt.size());
+         EXPECT(out == bin);
+      });
+
+      string decoded;
+      EXPECT(cxx17_decode_checked("Hello World", decoded) == 5u);
+#endif
+
+#if defined (__cpp_consteval)
+      constexpr auto key = z85::ct::decode_literal("rq:rM>}U?@Lns47E1%kR.o@n%FcmmsL/@{H8]yf7");
+      static_assert(key.size() == 32, "CURVE key is 32 bytes");
+      EXPECT(string((const char*)key.data(), key.size()) ==
+             z85::decode(string("rq:rM>}U?@Lns47E1%kR.o@n%FcmmsL/@{H8]yf7")));
+#endif
+
+#if defined (__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+      using namespace z85::literals;
+      constexpr auto hello2 = "HelloWorld"_z85;
+      static_assert(hello2.size() == 8 && hello2[0] == std::byte{0x86} && hello2[7] == std::byte{0x5B},
+                    "compile time decoding");
+      EXPECT(string((const char*)hello2.data(), hello2.size()) == "\x86\x4F\xD2\x6F\xB5\x59\xF7\x5B");
+#endif
+   },
+
+   "Test line wrapping", []
+   {
+      for_each_backend([]
+      {
+         for_random_data(4, [](const string& bin)
+         {
+            if (bin.size() % 12)
+            {
+               return;
+            }
+
+            const string txt = z85::encode(bin);
+            const size_t lineLength = 1 + rand() % 100;
+            string wrapped(Z85_encode_wrapped_bound(bin.size(), lineLength), '\0');
+            EXPECT(Z85_encode_wrapped(bin.data(), &wrapped[0], bin.size(), lineLength) == wrapped.size());
+
+            // lines are full except the last one
+            string unwrapped;
+            for (size_t i = 0; i < wrapped.size(); i += lineLength + 1)
+            {
+               EXPECT((i + lineLength >= wrapped.size() || wrapped[i + lineLength] == '\n'));
+               unwrapped += wrapped.substr(i, lineLength);
+            }
+            EXPECT(unwrapped == txt);
+
+            // CR/LF and other whitespace anywhere
+            string noisy;
+            for (char ch : wrapped)
+            {
+               noisy += ch == '\n' ? string("\r\n") : string(1, ch);
+               if (rand() % 50 == 0)
+               {
+                  noisy += " \t\v\f"[rand() % 4];
+               }
+            }
+
+            string out(bin.size(), '\0');
+            size_t errorPos = 0;
+            EXPECT(Z85_decode_skipping_whitespace(noisy.data(), &out[0], noisy.size(), &errorPos) == bin.size());
+            EXPECT(errorPos == Z85_NPOS);
+            EXPECT(out == bin);
+
+            // padded format
+            const string padded = z85::encode_with_padding(bin.substr(0, bin.size() - 1));
+            string paddedWrapped(Z85_encode_with_padding_wrapped_bound(bin.size() - 1, lineLength), '\0');
+            EXPECT(Z85_encode_with_padding_wrapped(bin.data(), &paddedWrapped[0], bin.size() - 1, lineLength) ==
+                   paddedWrapped.size());
+            paddedWrapped.erase(remove(paddedWrapped.begin(), paddedWrapped.end(), '\n'), paddedWrapped.end());
+            EXPECT(paddedWrapped == padded);
+
+            const string paddedNoisy = "\r\n" + padded.substr(0, 1) + "\n" + padded.substr(1, padded.size() / 2) +
+                                       "\r\n" + padded.substr(1 + padded.size() / 2) + " \n";
+            EXPECT(Z85_decode_with_padding_skipping_whitespace(paddedNoisy.data(), &out[0], paddedNoisy.size(),
+                                                               &errorPos) == bin.size() - 1);
+            EXPECT(errorPos == Z85_NPOS);
+            EXPECT(out.substr(0, bin.size() - 1) == bin.substr(0, bin.size() - 1));
+         });
+      });
+
+      char buf[16];
+      size_t errorPos = 0;
+      EXPECT(Z85_encode_wrapped("\x86\x4F\xD2\x6F\xB5\x59\xF7\x5B", buf, 8, 4) == 12);
+      EXPECT(string(buf, 12) == "Hell\noWor\nld");
+      EXPECT(Z85_encode_wrapped("\x86\x4F\xD2\x6F\xB5\x59\xF7\x5B", buf, 8, 0) == 10);
+      EXPECT(Z85_encode_wrapped_bound(8, 5) == 11);
+      EXPECT(Z85_encode_with_padding_wrapped("\x86\x4F\xD2\x6F\xB5", buf, 5, 5) == 13);
+      EXPECT(string(buf, 13) == "1Hell\noWeZg\nb");
+
+      EXPECT(Z85_decode_skipping_whitespace("", buf, 0, &errorPos) == 0);
+      EXPECT(errorPos == Z85_NPOS);
+      EXPECT(Z85_decode_skipping_whitespace(" \r\n", buf, 3, &errorPos) == 0);
+      EXPECT(errorPos == Z85_NPOS);
+      EXPECT(Z85_decode_skipping_whitespace("Hello\r\nWor~d", buf, 13, &errorPos) == 0);
+      EXPECT(errorPos == 10u);
+      EXPECT(Z85_decode_skipping_whitespace("Hello Wor", buf, 9, &errorPos) == 0);
+      EXPECT(errorPos == 9u);
+      EXPECT(Z85_decode_with_padding_skipping_whitespace("4Hello\nWor~d", buf, 12, &errorPos) == 0);
+      EXPECT(errorPos == 10u);
+      EXPECT(Z85_decode_with_padding_skipping_whitespace("4He~lo\nWorld", buf, 12, &errorPos) == 0);
+      EXPECT(errorPos == 3u);
+      EXPECT(Z85_decode_with_padding_skipping_whitespace(" 5Hello\nWorld", buf, 13, &errorPos) == 0);
+      EXPECT(errorPos == 1u);
+      EXPECT(Z85_decode_with_padding_skipping_whitespace("4Hel l", buf, 6, &errorPos) == 0);
+      EXPECT(errorPos == 6u);
+      EXPECT(Z85_decode_with_padding_skipping_whitespace("4Hel lo", buf, 7, &errorPos) == 4);
+      EXPECT(Z85_decode_with_padding_skipping_whitespace(" 4 Hello\tWorld\n", buf, 15, &errorPos) == 8);
+      EXPECT(errorPos == Z85_NPOS);
+      EXPECT(string(buf, 8) == "\x86\x4F\xD2\x6F\xB5\x59\xF7\x5B");
+   },
+
+   "Test batch encoding", []
+   {
+      // messages of every length up to several bulk iterations, so frames of different
+      // messages share the SIMD lanes, plus empty messages in between
+      srand(0);
+      vector<string> messages;
+      for (size_t i = 0; i < 300; ++i)
+      {
+         string message(i % 7 == 0 ? 0 : rand() % 100, '\0');
+         for (char& ch : message)
+         {
+            ch = rand() % 256;
+         }
+         messages.push_back(message);
+      }
+
+      string columnar;
+      vector<size_t> inputOffsets(1, 0);
+      vector<Z85_buffer_t> inputs;
+      for (const string& message : messages)
+      {
+         columnar += message;
+         inputOffsets.push_back(columnar.size());
+         inputs.push_back(Z85_buffer_t{ message.data(), message.size() });
+      }
+
+      for_each_backend([&]
+      {
+         const size_t bound = Z85_encode_with_padding_batch_bound(inputs.data(), inputs.size());
+         EXPECT(Z85_encode_with_padding_columnar_bound(inputOffsets.data(), messages.size()) == bound);
+
+         with_strict_buf(bound, [&](strict_buf& txt_buf)
+         {
+            vector<size_t> offsets(messages.size() + 1);
+            EXPECT(Z85_encode_with_padding_batch(inputs.data(), inputs.size(), txt_buf.p(), offsets.data()) == bound);
+            EXPECT(offsets.front() == 0u);
+            EXPECT(offsets.back() == bound);
+
+            for (size_t i = 0; i < messages.size(); ++i)
+            {
+               EXPECT(txt_buf.data().substr(offsets[i], offsets[i + 1] - offsets[i]) == z85::encode_with_padding(messages[i]));
+            }
+
+            const string batch = txt_buf.data();
+            vector<size_t> offsets2(messages.size() + 1);
+            EXPECT(Z85_encode_with_padding_columnar(columnar.data(), inputOffsets.data(), messages.size(),
+                                                   txt_buf.p(), offsets2.data()) == bound);
+            EXPECT(offsets2 == offsets);
+            EXPECT(txt_buf.data() == batch);
+         });
+      });
+
+      // C++ wrapper appends
+      string txt("prefix:");
+      vector<size_t> offsets;
+      vector<string> pair = { "\x86\x4F\xD2\x6F\xB5\x59\xF7\x5B", "\x86\x4F\xD2\x6F\xB5" };
+      EXPECT(z85::encode_with_padding_batch(pair, txt, offsets) == 22);
+      EXPECT(txt == "prefix:4HelloWorld1HelloWeZgb");
+      EXPECT((offsets == vector<size_t>{ 7, 18, 29 }));
+
+      char buf[1];
+      size_t offset = 1;
+      EXPECT(Z85_encode_with_padding_batch(NULL, 0, buf, &offset) == 0);
+      EXPECT(offset == 0u);
+   },
+
+   "Test in-place functions", []
+   {
+      srand(0);
+
+      string data;
+      for (size_t i = 0; i < 10003; ++i)
+      {
+         data += (char)(rand() % 256);
+      }
+
+      for_each_backend([&]
+      {
+         // sizes around several internal chunks
+         for (size_t size = 0; size <= data.size(); size += size < 16 ? 1 : 997)
+         {
+            const string bin = data.substr(0, size);
+
+            string buf(bin);
+            EXPECT(z85::encode_with_padding_inplace(buf) == (size ? Z85_encode_with_padding_bound(size) : 0));
+            EXPECT(buf == z85::encode_with_padding(bin));
+            EXPECT(z85::decode_with_padding_inplace(buf) == size);
+            EXPECT(buf == bin);
+
+            buf.assign(bin);
+            EXPECT(z85::encode_with_trailing_padding_inplace(buf) == (size ? Z85_encode_with_trailing_padding_bound(size) : 0));
+            EXPECT(buf == z85::encode_with_trailing_padding(bin));
+            EXPECT(z85::decode_with_trailing_padding_inplace(buf) == size);
+            EXPECT(buf == bin);
+
+            const string frames = bin.substr(0, size / 4 * 4);
+            buf.assign(frames);
+            EXPECT(z85::encode_inplace(buf) == (frames.empty() ? 0 : Z85_encode_bound(frames.size())));
+            EXPECT(buf == z85::encode(frames));
+            EXPECT(z85::decode_inplace(buf) == frames.size());
+            EXPECT(buf == frames);
+         }
+      });
+
+      // errors leave data unchanged
+      string txt("HelloWorld!");
+      EXPECT(z85::decode_inplace(txt) == 0);
+      EXPECT(z85::encode_inplace(txt) == 0);
+      EXPECT(txt == "HelloWorld!");
+      txt = "5HelloWorld";
+      EXPECT(z85::decode_with_padding_inplace(txt) == 0);
+      EXPECT(txt == "5HelloWorld");
+      txt = "HelloWorld5";
+      EXPECT(z85::decode_with_trailing_padding_inplace(txt) == 0);
+      EXPECT(txt == "HelloWorld5");
+      txt = "HelloWorld";
+      EXPECT(z85::decode_with_trailing_padding_inplace(txt) == 0);
+      EXPECT(txt == "HelloWorld");
+   },
+
+   "Test large buffer mode", []
+   {
+      srand(0);
+
+      const size_t size = 3 * 3840 + 44; // several blocks and a partial one
+      char* const  bin  = (char*)Z85_large_buffer_alloc(size + 1);
+      EXPECT(bin != NULL);
+      for (size_t i = 0; i < size + 1; ++i)
+      {
+         bin[i] = (char)(rand() % 256);
+      }
+
+      for_each_backend([&]
+      {
+         // unaligned output too
+         for (size_t offset = 0; offset < 2; ++offset)
+         {
+            const string src(bin + offset, size);
+            const string txt = z85::encode(src);
+            const string pad = z85::encode_with_padding(src.substr(1));
+            string       buf(Z85_encode_with_padding_bound(size) + 1, 0);
+
+            EXPECT(Z85_set_large_buffer_threshold(0) == Z85_LARGE_BUFFER_OFF);
+
+            EXPECT(Z85_encode(src.c_str(), &buf[offset], size) == txt.size());
+            EXPECT(buf.substr(offset, txt.size()) == txt);
+            EXPECT(Z85_decode(txt.c_str(), &buf[offset], txt.size()) == size);
+            EXPECT(buf.substr(offset, size) == src);
+            EXPECT(z85::encode_with_padding(src.substr(1)) == pad);
+            EXPECT(z85::decode_with_padding(pad) == src.substr(1));
+            EXPECT(z85::encode_parallel(src, 3, 4000) == txt);
+            EXPECT(z85::decode_parallel(txt, 3, 5000) == src);
+
+            EXPECT(Z85_set_large_buffer_threshold(Z85_LARGE_BUFFER_OFF) == 0);
+         }
+      });
+
+      Z85_large_buffer_free(bin, size + 1);
+      Z85_large_buffer_free(NULL, 0);
+   },
+
+   "Test custom alphabets", []
+   {
+      // Python's base64.b85encode() uses RFC 1924 alphabet
+      const Z85_alphabet_t* rfc1924 = Z85_alphabet_rfc1924();
+      EXPECT(z85::encode(rfc1924, string("\x86\x4F\xD2\x6F\xB5\x59\xF7\x5B", 8)) == "hELLOwORLD");
+      EXPECT(z85::decode(rfc1924, "hELLOwORLD") == string("\x86\x4F\xD2\x6F\xB5\x59\xF7\x5B", 8));
+      EXPECT(z85::encode_with_padding(rfc1924, "Hello, World") == "4NM&qnZ!92JZ*pv8");
+      EXPECT(z85::decode_with_padding(rfc1924, "4NM&qnZ!92JZ*pv8") == "Hello, World");
+      EXPECT(z85::encode_with_padding(Z85_alphabet_z85(), "Hello, World") == z85::encode_with_padding(string("Hello, World")));
+
+      // reversed Z85 alphabet
+      const string symbols(c_alphabet, 85);
+      const string reversed(symbols.rbegin(), symbols.rend());
+      z85::alphabet custom(reversed.c_str());
+      EXPECT(custom.valid());
+      EXPECT(Z85_alphabet_symbols(custom) == reversed);
+      EXPECT(Z85_alphabet_symbols(rfc1924) == string("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz!#$%&()*+-;<=>?@^_`{|}~"));
+
+      EXPECT(!z85::alphabet(NULL).valid());
+      EXPECT(!z85::alphabet("0123").valid());
+      EXPECT(!z85::alphabet((reversed.substr(1) + reversed[1]).c_str()).valid()); // duplicate
+      EXPECT(!z85::alphabet((reversed.substr(1) + ' ').c_str()).valid());         // space
+
+      srand(0);
+
+      string data;
+      for (size_t i = 0; i < 1003; ++i)
+      {
+         data += (char)(rand() % 256);
+      }
+
+      // the same digits as Z85, other symbols
+      for_each_backend([&]
+      {
+         const Z85_alphabet_t* alphabets[] = { rfc1924, custom };
+         for (const Z85_alphabet_t* alphabet : alphabets)
+         {
+            for (size_t size = 1; size <= data.size(); size += size < 100 ? 1 : 97)
+            {
+               const string bin = data.substr(0, size);
+               string expected = z85::encode_with_padding(bin);
+               for (size_t i = 1; i < expected.size(); ++i)
+               {
+                  expected[i] = Z85_alphabet_symbols(alphabet)[symbols.find(expected[i])];
+               }
+
+               const string txt = z85::encode_with_padding(alphabet, bin);
+               EXPECT(txt == expected);
+               EXPECT(z85::decode_with_padding(alphabet, txt) == bin);
+
+               string buf(size, 0);
+               size_t errorPos = 0;
+               EXPECT(Z85_alphabet_decode_with_padding_checked(alphabet, txt.c_str(), &buf[0], txt.size(), &errorPos) == size);
+               EXPECT(errorPos == Z85_NPOS);
+               EXPECT(buf == bin);
+            }
+
+            const string bin = data.substr(0, 1000);
+            const string txt = z85::encode(alphabet, bin);
+            string buf(bin.size(), 0);
+            EXPECT(z85::decode(alphabet, txt) == bin);
+            EXPECT(Z85_alphabet_decode_unsafe(alphabet, txt.c_str(), txt.c_str() + txt.size(), &buf[0]) == &buf[0] + buf.size());
+            EXPECT(buf == bin);
+
+            // symbols of other alphabets are rejected at any position, including SIMD blocks
+            for (size_t pos : { size_t(0), size_t(17), size_t(640), txt.size() - 1 })
+            {
+               for (char symbol : { ' ', '"', '\'', ',', '.', '/', '[', ']', '\\', '\x80' })
+               {
+                  if (strchr(Z85_alphabet_symbols(alphabet), symbol))
+                  {
+                     continue;
+                  }
+
+                  string bad(txt);
+                  bad[pos] = symbol;
+
+                  size_t errorPos = 0;
+                  EXPECT(Z85_alphabet_decode_checked(alphabet, bad.c_str(), &buf[0], bad.size(), &errorPos) == 0);
+                  EXPECT(errorPos == pos);
+               }
+            }
+
+            // zero digit isn't an error
+            const string zeros(40, Z85_alphabet_symbols(alphabet)[0]);
+            size_t errorPos = 0;
+            EXPECT(Z85_alphabet_decode_checked(alphabet, zeros.c_str(), &buf[0], zeros.size(), &errorPos) == 32);
+            EXPECT(errorPos == Z85_NPOS);
+            EXPECT(buf.substr(0, 32) == string(32, 0));
+         }
+      });
+   },
+
+   "Test Ascii85", []
+   {
+      // vectors from Python's base64.a85encode()
+      const string sparse = string(8, 0) + "abcd" + string(8, ' ') + "xyz";
+      EXPECT(z85::ascii85_encode("Man is distinguished", Z85_ASCII85_FRAMED) == "<~9jqo^BlbD-BleB1DJ+*+F(f,q~>");
+      EXPECT(z85::ascii85_encode(sparse) == "zz@:E_W+<VdL+<VdLG^4T");
+      EXPECT(z85::ascii85_encode(sparse, Z85_ASCII85_SPACES) == "zz@:E_WyyG^4T");
+      EXPECT(z85::ascii85_encode(string(), Z85_ASCII85_FRAMED) == "<~~>");
+
+      EXPECT(z85::ascii85_decode("<~9jqo^BlbD-BleB1DJ+*+F(f,q~>") == "Man is distinguished");
+      EXPECT(z85::ascii85_decode("9jqo^BlbD-BleB1DJ+*+F(f,q") == "Man is distinguished");
+      EXPECT(z85::ascii85_decode("zz@:E_W+<VdL+<VdLG^4T") == sparse);
+      EXPECT(z85::ascii85_decode("zz@:E_WyyG^4T", Z85_ASCII85_SPACES) == sparse);
+
+      const char* errors[][2] =
+      {
+         { "zz@:E_WyyG^4T",  "7"  }, // 'y' without the flag
+         { "@:z_W",          "2"  }, // 'z' inside a group
+         { "s8W-\"",         "0"  }, // overflow
+         { "s8W-!s",         "6"  }, // single symbol group
+         { "<~9jqo^",        "7"  }, // no "~>" with Z85_ASCII85_FRAMED
+         { "9jqo^ BlbD-",    "5"  }  // whitespace
+      };
+
+      for (size_t i = 0; i < sizeof(errors) / sizeof(errors[0]); ++i)
+      {
+         const string txt(errors[i][0]);
+         string       buf(Z85_ascii85_decode_bound(txt.size()), 0);
+         size_t       errorPos = 0;
+         EXPECT(Z85_ascii85_decode(txt.c_str(), &buf[0], txt.size(), Z85_ASCII85_FRAMED * (i == 4), &errorPos) == 0);
+         EXPECT(errorPos == (size_t)atoi(errors[i][1]));
+      }
+
+      // runs of every length next to dense frames, on every backend
+      srand(0);
+      for_each_backend([]
+      {
+         for (size_t size = 0; size < 300; ++size)
+         {
+            string bin;
+            for (size_t i = 0; i < size; ++i)
+            {
+               const int run = (int)(i / 4 * 7 % 23);
+               bin += run < 8 ? '\0' : run < 12 ? ' ' : (char)(rand() % 256);
+            }
+
+            for (int flags = 0; flags < 4; ++flags)
+            {
+               const string txt = z85::ascii85_encode(bin, flags);
+               EXPECT(txt.size() <= Z85_ascii85_encode_bound(size));
+               EXPECT(z85::ascii85_decode(txt, flags) == bin);
+            }
+         }
+      });
+   },
+
+   "Test checksums", []
+   {
+      // bit by bit CRC32C
+      const auto reference = [](const string& data)
+      {
+         unsigned int crc = 0xFFFFFFFFU;
+         for (char ch : data)
+         {
+            crc ^= (unsigned char)ch;
+            for (int k = 0; k < 8; ++k)
+            {
+               crc = (crc >> 1) ^ (0x82F63B78U & (0U - (crc & 1)));
+            }
+         }
+         return ~crc;
+      };
+
+      for_each_backend([&]
+      {
+         EXPECT(Z85_crc32c(0, "123456789", 9) == 0xE3069283U);
+         EXPECT(Z85_crc32c(Z85_crc32c(0, "1234", 4), "56789", 5) == 0xE3069283U);
+         EXPECT(Z85_crc32c(0, NULL, 0) == 0u);
+
+         srand(0);
+         string data;
+         for (size_t size = 0; size < 2000; size += 1 + size / 16)
+         {
+            while (data.size() < size)
+            {
+               data += (char)(rand() % 256);
+            }
+            EXPECT(Z85_crc32c(0, data.data(), size) == reference(data));
+         }
+      });
+
+      const string hello("\x86\x4F\xD2\x6F\xB5\x59\xF7\x5B", 8);
+      EXPECT(z85::encode_with_checksum(hello) == "4HelloWorldD%InE");
+      EXPECT(z85::decode_with_checksum("4HelloWorldD%InE") == hello);
+      EXPECT(z85::decode_with_checksum("4HelloWorldD%InF").empty());
+      EXPECT(z85::encode_with_checksum("").empty());
+
+      size_t errorPos = 0;
+      char out[16];
+      EXPECT(Z85_decode_with_checksum("5HelloWorldD%InE", out, 16, &errorPos) == 0u);
+      EXPECT(errorPos == 0u);
+      EXPECT(Z85_decode_with_checksum("4HelloWorldD%InE", out, 15, &errorPos) == 0u);
+      EXPECT(errorPos == 15u);
+      EXPECT(Z85_decode_with_checksum("4Hello", out, 6, &errorPos) == 0u);
+      EXPECT(errorPos == 6u);
+
+      for_each_backend([]
+      {
+         srand(0);
+
+         // sizes around the block size of the fused loops
+         const size_t sizes[] = { 1, 7, 8, 3839, 3840, 3844, 4800, 12345 };
+         for (size_t size : sizes)
+         {
+            string bin;
+            for (size_t i = 0; i < size; ++i)
+            {
+               bin += (char)(rand() % 256);
+            }
+            const unsigned int crc = Z85_crc32c(0, bin.data(), size);
+
+            // fused functions compute the same checksum as a separate pass, the rest is chained
+            const size_t frames = size / 4 * 4;
+            string txt(Z85_encode_bound(frames), '\0');
+            string dec(size + 4, '\0');
+            unsigned int encodeCrc = 0;
+            unsigned int decodeCrc = 0;
+            EXPECT(Z85_encode_crc32c(bin.data(), &txt[0], frames, &encodeCrc) == txt.size());
+            EXPECT(txt == z85::encode(bin.data(), frames));
+            EXPECT(Z85_crc32c(encodeCrc, bin.data() + frames, size - frames) == crc);
+            EXPECT(Z85_decode_crc32c(txt.data(), &dec[0], txt.size(), &decodeCrc) == frames);
+            EXPECT(decodeCrc == encodeCrc);
+            EXPECT(dec.substr(0, frames) == bin.substr(0, frames));
+
+            const string checked = z85::encode_with_checksum(bin);
+            EXPECT(checked.size() == Z85_encode_with_checksum_bound(size));
+            EXPECT(checked.substr(0, checked.size() - 5) == z85::encode_with_padding(bin));
+            EXPECT(Z85_decode_with_checksum_bound(checked.data(), checked.size()) == size);
+            EXPECT(z85::decode_with_checksum(checked) == bin);
+
+            // corrupted data fails the checksum (or overflows the frame), invalid symbols are reported
+            size_t errorPos = 0;
+            string bad = checked;
+            bad[1] = bad[1] == '0' ? '1' : '0';
+            EXPECT(Z85_decode_with_checksum(bad.data(), &dec[0], bad.size(), &errorPos) == 0u);
+            EXPECT((errorPos == bad.size() - 5 || errorPos == 1u));
+
+            bad = checked;
+            bad[bad.size() - 7] = '~';
+            EXPECT(Z85_decode_with_checksum(bad.data(), &dec[0], bad.size(), &errorPos) == 0u);
+            EXPECT(errorPos == bad.size() - 7);
+         }
+      });
+
+      unsigned int crc = 0;
+      EXPECT(Z85_encode_crc32c("abc", out, 3, &crc) == 0u);
+      EXPECT(Z85_decode_crc32c("abc", out, 3, &crc) == 0u);
+      EXPECT(Z85_encode_crc32c("abcd", out, 4, NULL) == 0u);
+   },
+
+   "Test single-include header", []
+   {
+      for_random_data(32, [](const string& data)
+      {
+         const string key = data.substr(data.size() - 32);
+         char txt[40];
+         char bin[32];
+         EXPECT(single_encode_key(key.data(), txt) == 40u);
+         EXPECT(string(txt, 40) == z85::encode(key));
+         EXPECT(single_decode_key(txt, bin) == 32u);
+         EXPECT(string(bin, 32) == key);
+
+         const string head = data.substr(0, data.size() / 32 * 7);
+         const string text = single_encode_with_padding(head);
+         EXPECT(text == z85::encode_with_padding(head));
+         EXPECT(single_decode_with_padding(text) == head);
+      });
+
+      EXPECT(single_decode_with_padding("5HelloWorld").empty());
+   },
+
+   "Test instrumentation", []
+   {
+      EXPECT(string(Z85_entry_point_name(Z85_ENTRY_ENCODE)) == "Z85_encode");
+      EXPECT(string(Z85_entry_point_name(Z85_ENTRY_DECODE_INPLACE)) == "Z85_decode_inplace");
+      EXPECT(Z85_entry_point_name(Z85_ENTRY_COUNT) == NULL);
+
+      Z85_stats_t stats;
+      if (!Z85_get_stats(&stats))
+      {
+         // compiled out
+         EXPECT(stats.entries[Z85_ENTRY_ENCODE].calls == 0u);
+         return;
+      }
+
+      Z85_reset_stats();
+
+      char txt[16];
+      char bin[16];
+      EXPECT(Z85_encode_with_padding("Hello", txt, 5) == 11u);
+      EXPECT(Z85_decode_with_padding(txt, bin, 11) == 5u);
+      EXPECT(Z85_decode("Hello", bin, 4) == 0u);
+      std::thread([&] { Z85_encode("\x86\x4F\xD2\x6F", txt, 4); }).join();
+
+      EXPECT(Z85_get_stats(&stats) == 1);
+
+      const Z85_entry_stats_t& encode = stats.entries[Z85_ENTRY_ENCODE_WITH_PADDING];
+      EXPECT(encode.calls == 1u);
+      EXPECT(encode.errors == 0u);
+      EXPECT(encode.padded == 1u);
+      EXPECT(encode.inputBytes == 5u);
+      EXPECT(encode.outputBytes == 11u);
+      EXPECT(encode.sizes[3] == 1u);
+
+      // nested calls are counted once
+      EXPECT(stats.entries[Z85_ENTRY_ENCODE_WITH_PADDING_PARALLEL].calls == 0u);
+      EXPECT(stats.entries[Z85_ENTRY_ENCODE_UNSAFE].calls == 0u);
+
+      EXPECT(stats.entries[Z85_ENTRY_DECODE_WITH_PADDING].calls == 1u);
+      EXPECT(stats.entries[Z85_ENTRY_DECODE_WITH_PADDING].padded == 1u);
+      EXPECT(stats.entries[Z85_ENTRY_DECODE].errors == 1u);
+      EXPECT(stats.entries[Z85_ENTRY_ENCODE].calls == 1u);
+      EXPECT(stats.entries[Z85_ENTRY_ENCODE].outputBytes == 5u);
+      EXPECT(stats.backends[Z85_get_backend()] == 4u);
+
+      Z85_reset_stats();
+      EXPECT(Z85_get_stats(&stats) == 1);
+      EXPECT(stats.entries[Z85_ENTRY_ENCODE].calls == 0u);
+   },
+
+   "Test stream buffers", []
+   {
+      srand(0);
+
+      string data;
+      for (size_t i = 0; i < 10003; ++i)
+      {
+         data += (char)(rand() % 256);
+      }
+
+      for (size_t blockSize = 0; blockSize <= 4096; blockSize += 1021)
+      {
+         for (size_t size = 0; size <= data.size(); size += size < 16 ? 1 : 1999)
+         {
+            const string bin = data.substr(0, size);
+
+            // mix of single characters, short and long writes
+            std::ostringstream sink;
+            {
+               z85::encoding_streambuf buf(sink.rdbuf(), true, blockSize);
+               std::ostream out(&buf);
+               for (size_t pos = 0, chunk = 1; pos < size; pos += chunk, chunk = chunk * 3 % 7919)
+               {
+                  chunk = std::min(chunk, size - pos);
+                  if (chunk == 1)
+                  {
+                     out.put(bin[pos]);
+                  }
+                  else
+                  {
+                     out.write(&bin[pos], chunk);
+                  }
+
+                  if (pos % 5 == 0)
+                  {
+                     out.flush();
+                  }
+               }
+
+               EXPECT(buf.finish());
+               EXPECT(!out.write("x", 1)); // the stream is finished
+            }
+            EXPECT(sink.str() == z85::encode_with_trailing_padding(bin));
+
+            std::istringstream source(sink.str());
+            z85::decoding_streambuf buf(source.rdbuf(), true, blockSize);
+            std::istream in(&buf);
+            EXPECT(string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()) == bin);
+            EXPECT(!buf.failed());
+         }
+      }
+
+      // specification compliant streams, destructor finishes the stream
+      std::ostringstream sink;
+      {
+         z85::encoding_streambuf buf(sink.rdbuf(), false);
+         std::ostream out(&buf);
+         out << "\x86\x4F\xD2\x6F\xB5\x59\xF7\x5B";
+      }
+      EXPECT(sink.str() == "HelloWorld");
+
+      std::istringstream source("HelloWorld");
+      z85::decoding_streambuf buf(source.rdbuf(), false);
+      std::istream in(&buf);
+      EXPECT(string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()) ==
+             "\x86\x4F\xD2\x6F\xB5\x59\xF7\x5B");
+      EXPECT(!buf.failed());
+
+      std::ostringstream unaligned;
+      z85::encoding_streambuf unalignedBuf(unaligned.rdbuf(), false);
+      EXPECT(unalignedBuf.sputn("Hello", 5) == 5);
+      EXPECT(!unalignedBuf.finish());
+      EXPECT(unalignedBuf.failed());
+      EXPECT(unaligned.str() == "nm=QN");
+
+      // flushing a finished stream doesn't reopen it for writing
+      std::ostringstream finished;
+      {
+         z85::encoding_streambuf finishedBuf(finished.rdbuf(), false);
+         std::ostream finishedOut(&finishedBuf);
+         finishedOut.write("\x86\x4F\xD2\x6F", 4);
+         EXPECT(finishedBuf.finish());
+         EXPECT(finishedOut.flush());
+         EXPECT(!finishedOut.write("efgh", 4));
+         EXPECT(finishedBuf.pubsync() == 0);
+      }
+      EXPECT(finished.str() == "Hello");
+
+      // truncated and malformed streams
+      for (const char* txt : { "HelloWorl", "HelloWorld5", "HelloWor" })
+      {
+         std::istringstream wrong(txt);
+         z85::decoding_streambuf wrongBuf(wrong.rdbuf());
+         std::istream wrongIn(&wrongBuf);
+         string decoded(std::istreambuf_iterator<char>(wrongIn), (std::istreambuf_iterator<char>()));
+         EXPECT(wrongBuf.failed());
+      }
+   },
+
+   "Test parallel functions", []
+   {
+      srand(0);
+
+      string data;
+      for (size_t i = 0; i < 100003; ++i)
+      {
+         data += (char)(rand() % 256);
+      }
+
+      for (size_t threads = 1; threads <= 7; threads += 3)
+      {
+         for (size_t size = 0; size <= data.size(); size += 25001)
+         {
+            const string bin = data.substr(0, size);
+            const string aligned = data.substr(0, size / 20 * 20);
+
+            const string txt = z85::encode_with_padding(bin);
+            EXPECT(z85::encode_with_padding_parallel(bin, threads, 1000) == txt);
+            EXPECT(z85::decode_with_padding_parallel(txt, threads, 1000) == bin);
+
+            const string aligned_txt = z85::encode(aligned);
+            EXPECT(z85::encode_parallel(aligned, threads, 1000) == aligned_txt);
+            EXPECT(z85::decode_parallel(aligned_txt, threads, 1000) == aligned);
+         }
+      }
+
+      // default thread count and chunk size
+      EXPECT(z85::encode_parallel(data.substr(0, 100000)) == z85::encode(data.substr(0, 100000)));
+
+      char buf[100];
+      EXPECT(Z85_encode_parallel("some binary data", buf, 5, 4, 1) == 0);
+      EXPECT(Z85_decode_parallel("some text.", buf, 4, 4, 1) == 0);
+      EXPECT(Z85_encode_with_padding_parallel("some binary data", buf, 0, 4, 1) == 0);
+      EXPECT(Z85_decode_with_padding_parallel("0HelloWorld", buf, 11, 4, 1) == 0);
+   },
+
+   "Test streaming encoder/decoder", []
+   {
+      srand(0);
+
+      string bin;
+      for (size_t i = 0; i < 4000; ++i)
+      {
+         bin += (char)(rand() % 256);
+      }
+      const string txt = z85::encode(bin);
+
+      for (size_t maxChunk = 1; maxChunk < 1000; maxChunk = maxChunk * 3 + 1)
+      {
+         Z85_encoder_t encoder;
+         Z85_encoder_init(&encoder);
+
+         string encoded;
+         for (size_t pos = 0; pos < bin.size();)
+         {
+            const size_t chunk = std::min(bin.size() - pos, (size_t)rand() % maxChunk + 1);
+
+            string buf(Z85_encoder_update_bound(chunk), '\0');
+            const size_t written = Z85_encoder_update(&encoder, &bin[pos], &buf[0], chunk);
+            EXPECT(written <= buf.size());
+            encoded += buf.substr(0, written);
+            pos += chunk;
+         }
+
+         size_t written = 1;
+         EXPECT(Z85_encoder_finish(&encoder, NULL, &written) == 1);
+         EXPECT(written == 0);
+         EXPECT(encoded == txt);
+
+         Z85_decoder_t decoder;
+         Z85_decoder_init(&decoder);
+
+         string decoded;
+         for (size_t pos = 0; pos < txt.size();)
+         {
+            const size_t chunk = std::min(txt.size() - pos, (size_t)rand() % maxChunk + 1);
+
+            string buf(Z85_decoder_update_bound(chunk), '\0');
+            const size_t written = Z85_decoder_update(&decoder, &txt[pos], &buf[0], chunk);
+            EXPECT(written <= buf.size());
+            decoded += buf.substr(0, written);
+            pos += chunk;
+         }
+
+         EXPECT(Z85_decoder_finish(&decoder, NULL, &written) == 1);
+         EXPECT(decoded == bin);
+      }
+
+      // incomplete frames
+      char buf[10];
+      Z85_encoder_t encoder;
+      Z85_encoder_init(&encoder);
+      EXPECT(Z85_encoder_update(&encoder, "\x86\x4F\xD2", buf, 3) == 0);
+      EXPECT(Z85_encoder_finish(&encoder, buf, NULL) == 0);
+      EXPECT(Z85_encoder_update(&encoder, "\x6F", buf, 1) == 5);
+      EXPECT(string(buf, 5) == "Hello");
+      EXPECT(Z85_encoder_finish(&encoder, buf, NULL) == 1);
+
+      Z85_decoder_t decoder;
+      Z85_decoder_init(&decoder);
+      EXPECT(Z85_decoder_update(&decoder, "Hell", buf, 4) == 0);
+      EXPECT(Z85_decoder_finish(&decoder, buf, NULL) == 0);
+      EXPECT(Z85_decoder_update(&decoder, "oWor", buf, 4) == 4);
+      EXPECT(string(buf, 4) == "\x86\x4F\xD2\x6F");
+      EXPECT(Z85_decoder_finish(&decoder, buf, NULL) == 0);
+      EXPECT(Z85_decoder_update(&decoder, "", buf, 0) == 0);
+      EXPECT(Z85_decoder_update(&decoder, "ld", buf, 2) == 4);
+      EXPECT(string(buf, 4) == "\xB5\x59\xF7\x5B");
+      EXPECT(Z85_decoder_finish(&decoder, buf, NULL) == 1);
+   },
+
    "Test Z85_encode_bound()", []
    {
       char buf[1300];
@@ -0,0 +1,113 @@
+# Round trips of the z85 command line tool in all formats through files (mapped input) and pipes
+# (the reader -> transcoder -> writer pipeline), errors of truncated input.
+#
+#    cmake -DZ85=path/to/z85 -DWORK_DIR=scratch/dir -P test_cli.cmake
+
+file (MAKE_DIRECTORY "${WORK_DIR}")
+
+# deterministic binary data of 255 * 4096 bytes, the pattern is shifted against frames of 4 and 5
+set (data "")
+foreach (code RANGE 1 255)
+  string (ASCII ${code} byte)
+  string (APPEND data "${byte}")
+endforeach ()
+foreach (i RANGE 11)
+  string (APPEND data "${data}")
+endforeach ()
+string (LENGTH "${data}" dataSize)
+
+# runs a pipeline of COMMANDs, fails the test unless it succeeds (or fails, if EXPECT_ERROR
+# is given and its stderr matches it)
+function (z85_run description)
+  cmake_parse_arguments (ARG "" "EXPECT_ERROR;INPUT_FILE;OUTPUT_FILE" "" ${ARGN})
+
+  set (files "")
+  if (ARG_INPUT_FILE)
+    list (APPEND files INPUT_FILE "${ARG_INPUT_FILE}")
+  endif ()
+  if (ARG_OUTPUT_FILE)
+    list (APPEND files OUTPUT_FILE "${ARG_OUTPUT_FILE}")
+  endif ()
+
+  execute_process (${ARG_UNPARSED_ARGUMENTS} ${files} RESULTS_VARIABLE results ERROR_VARIABLE error)
+
+  set (failed FALSE)
+  foreach (result ${results})
+    if (NOT result EQUAL 0)
+      set (failed TRUE)
+    endif ()
+  endforeach ()
+
+  if (ARG_EXPECT_ERROR AND NOT (failed AND error MATCHES "${ARG_EXPECT_ERROR}"))
+    message (SEND_ERROR "${description}: expected error \"${ARG_EXPECT_ERROR}\", got \"${error}\"")
+  elseif (NOT ARG_EXPECT_ERROR AND failed)
+    message (SEND_ERROR "${description}: ${results} ${error}")
+  endif ()
+endfunction ()
+
+function (z85_compare description expected actual)
+  execute_process (COMMAND ${CMAKE_COMMAND} -E compare_files "${expected}" "${actual}" RESULT_VARIABLE result)
+  if (NOT result EQUAL 0)
+    message (SEND_ERROR "${description}: ${actual} differs from ${expected}")
+  endif ()
+endfunction ()
+
+set (bin "${WORK_DIR}/input.bin")
+set (fileTxt "${WORK_DIR}/file.txt")
+set (fileBin "${WORK_DIR}/file.bin")
+set (pipeTxt "${WORK_DIR}/pipe.txt")
+set (pipeBin "${WORK_DIR}/pipe.bin")
+set (truncated "${WORK_DIR}/truncated.txt")
+
+foreach (fmt spec padding trailing-padding)
+  if (fmt STREQUAL "spec")
+    set (flags "")
+    set (sizes 0 4 20 1000 ${dataSize})
+  else ()
+    set (flags "--${fmt}")
+    set (sizes 0 1 2 3 4 5 21 1001 ${dataSize})
+  endif ()
+
+  foreach (size ${sizes})
+    # small chunks split the data many times, large inputs are split between threads of the pool
+    foreach (chunkSize 60 8M)
+      set (opts ${flags} -j 3 --chunk-size ${chunkSize})
+      set (case "${fmt} ${size} bytes by ${chunkSize}")
+
+      string (SUBSTRING "${data}" 0 ${size} input)
+      file (WRITE "${bin}" "${input}")
+
+      z85_run ("encode file ${case}" COMMAND "${Z85}" ${opts} "${bin}" "${fileTxt}")
+      z85_run ("decode file ${case}" COMMAND "${Z85}" -d ${opts} "${fileTxt}" "${fileBin}")
+      z85_compare ("file ${case}" "${bin}" "${fileBin}")
+
+      z85_run ("encode pipe ${case}" COMMAND cat "${bin}" COMMAND "${Z85}" ${opts} OUTPUT_FILE "${pipeTxt}")
+      z85_compare ("encode pipe ${case}" "${fileTxt}" "${pipeTxt}")
+      z85_run ("decode pipe ${case}" COMMAND cat "${pipeTxt}" COMMAND "${Z85}" -d ${opts} OUTPUT_FILE "${pipeBin}")
+      z85_compare ("decode pipe ${case}" "${bin}" "${pipeBin}")
+
+      if (size GREATER 0)
+        file (READ "${fileTxt}" text)
+        string (LENGTH "${text}" length)
+        math (EXPR length "${length} - 1")
+        string (SUBSTRING "${text}" 0 ${length} text)
+        file (WRITE "${truncated}" "${text}")
+
+        z85_run ("decode truncated file ${case}" COMMAND "${Z85}" -d ${opts} "${truncated}" "${fileBin}"
+                 EXPECT_ERROR "truncated input|isn't divisible by 5")
+        z85_run ("decode truncated pipe ${case}" COMMAND cat "${truncated}" COMMAND "${Z85}" -d ${opts}
+                 OUTPUT_FILE "${pipeBin}" EXPECT_ERROR "truncated input|isn't divisible by 5")
+      endif ()
+    endforeach ()
+  endforeach ()
+endforeach ()
+
+# options out of range are rejected
+foreach (option "--chunk-size;-40" "--chunk-size;18014398509481985K" "--chunk-size;2G" "--chunk-size;10"
+                "-j;0" "-j;257" "-j;1G" "-j;-1" "--threads;99999999999999999999")
+  z85_run ("option ${option}" COMMAND "${Z85}" ${option} "${bin}" "${fileTxt}" EXPECT_ERROR "Invalid option")
+endforeach ()
+
+# the spec format needs whole frames
+file (WRITE "${bin}" "12345")
+z85_run ("encode 5 bytes" COMMAND "${Z85}" "${bin}" "${fileTxt}" EXPECT_ERROR "isn't divisible by 4")
@@ -0,0 +1,56 @@
+// z85_constexpr.hpp compiled as C++17, i.e. without consteval (test.cpp is C++20),
+// "Test constexpr kernels" compares these kernels with the libraries
+
+#include <string>
+
+#include "z85_constexpr.hpp"
+
+#if defined (__cpp_consteval)
+   #error "test_constexpr.cpp must be compiled as C++17"
+#endif
+
+namespace
+{
+
+struct encoded
+{
+   char text[11];
+
+   constexpr encoded() : text()
+   {
+      const unsigned char bin[] = { 0x86, 0x4F, 0xD2, 0x6F, 0xB5, 0x59, 0xF7, 0x5B };
+      z85::ct::encode_unsafe(bin, bin + 8, text);
+   }
+};
+
+constexpr encoded hello;
+static_assert(hello.text[0] == 'H' && hello.text[9] == 'd', "compile time encoding");
+
+struct decoded
+{
+   unsigned char bin[8];
+   const char* end;
+
+   constexpr decoded(const char* text) : bin(), end(z85::ct::decode_checked(text, text + 10, bin)) {}
+};
+
+constexpr const char helloText[] = "HelloWorld";
+constexpr decoded helloBin(helloText);
+static_assert(helloBin.end == helloText + 10 && helloBin.bin[0] == 0x86 && helloBin.bin[7] == 0x5B,
+              "compile time decoding");
+
+} // namespace
+
+std::string cxx17_encode(const std::string& bin)
+{
+   std::string txt(bin.size() / 4 * 5, '\0');
+   z85::ct::encode_unsafe(bin.data(), bin.data() + bin.size(), &txt[0]);
+   return txt;
+}
+
+// returns the offset of the first invalid symbol or frame, 'txt' size if everything is decoded
+size_t cxx17_decode_checked(const std::string& txt, std::string& bin)
+{
+   bin.assign(txt.size() / 5 * 4, '\0');
+   return z85::ct::decode_checked(txt.data(), txt.data() + txt.size(), &bin[0]) - txt.data();
+}
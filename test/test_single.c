@@ -0,0 +1,15 @@
+// z85_single.h compiled as C in Z85_STATIC mode, "Test single-include header" compares it with the library
+
+#undef Z85_STATS // counters live in the libraries only
+#define Z85_STATIC
+#include "z85_single.h"
+
+size_t single_encode_key(const char* key, char* dest)
+{
+   return Z85_encode(key, dest, 32);
+}
+
+size_t single_decode_key(const char* text, char* dest)
+{
+   return Z85_decode(text, dest, 40);
+}
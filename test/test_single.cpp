@@ -0,0 +1,15 @@
+// z85_single.h compiled as C++ in Z85_STATIC mode, "Test single-include header" compares it with the libraries
+
+#undef Z85_STATS // counters live in the libraries only
+#define Z85_STATIC
+#include "z85_single.h"
+
+std::string single_encode_with_padding(const std::string& source)
+{
+   return z85::encode_with_padding(source);
+}
+
+std::string single_decode_with_padding(const std::string& source)
+{
+   return z85::decode_with_padding(source);
+}